@@ -70,7 +70,8 @@ struct channel
     struct lock lock;           /* Must acquire to access the controller. */
     bool expecting_interrupt;   /* True if an interrupt is expected, false if
                                    any interrupt would be spurious. */
-    struct semaphore completion_wait;   /* Up'd by interrupt handler. */
+    bool completed;             /* Interrupt taken, waiter not woken yet. */
+    struct semaphore completion_wait;   /* Up'd by ide_softirq(). */
 
     struct ata_disk devices[2];     /* The devices on this channel. */
   };
@@ -96,6 +97,7 @@ static void select_device (const struct ata_disk *);
 static void select_device_wait (const struct ata_disk *);
 
 static void interrupt_handler (struct intr_frame *);
+static softirq_func ide_softirq;
 
 /* Initialize the disk subsystem and detect disks. */
 void
@@ -103,6 +105,7 @@ ide_init (void)
 {
   size_t chan_no;
 
+  softirq_register (SOFTIRQ_BLOCK, ide_softirq);
   for (chan_no = 0; chan_no < CHANNEL_CNT; chan_no++)
     {
       struct channel *c = &channels[chan_no];
@@ -125,6 +128,7 @@ ide_init (void)
         }
       lock_init (&c->lock);
       c->expecting_interrupt = false;
+      c->completed = false;
       sema_init (&c->completion_wait, 0);
  
       /* Initialize devices. */
@@ -502,7 +506,8 @@ select_device_wait (const struct ata_disk *d)
   wait_until_idle (d);
 }
 
-/* ATA interrupt handler. */
+/* ATA interrupt handler.  Acknowledges the interrupt and leaves
+   waking the waiter to ide_softirq(). */
 static void
 interrupt_handler (struct intr_frame *f) 
 {
@@ -514,7 +519,8 @@ interrupt_handler (struct intr_frame *f)
         if (c->expecting_interrupt) 
           {
             inb (reg_status (c));               /* Acknowledge interrupt. */
-            sema_up (&c->completion_wait);      /* Wake up waiter. */
+            c->completed = true;
+            softirq_raise (SOFTIRQ_BLOCK);
           }
         else
           printf ("%s: unexpected interrupt\n", c->name);
@@ -524,4 +530,23 @@ interrupt_handler (struct intr_frame *f)
   NOT_REACHED ();
 }
 
+/* ATA softirq handler.  Wakes up the waiters of the channels
+   whose interrupts have come in. */
+static void
+ide_softirq (void)
+{
+  struct channel *c;
+
+  for (c = channels; c < channels + CHANNEL_CNT; c++)
+    {
+      enum intr_level old_level = intr_disable ();
+      bool completed = c->completed;
+      c->completed = false;
+      intr_set_level (old_level);
+
+      if (completed)
+        sema_up (&c->completion_wait);          /* Wake up waiter. */
+    }
+}
+
 
@@ -1,8 +1,12 @@
 #ifndef RTC_H
 #define RTC_H
 
+#include <stdbool.h>
+#include "threads/interrupt.h"
+
 typedef unsigned long time_t;
 
 time_t rtc_get_time (void);
+bool rtc_periodic_start (int hz, intr_handler_func *);
 
 #endif
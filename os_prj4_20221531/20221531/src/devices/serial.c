@@ -1,7 +1,7 @@
 #include "devices/serial.h"
 #include <debug.h>
+#include <string.h>
 #include "devices/input.h"
-#include "devices/intq.h"
 #include "devices/timer.h"
 #include "threads/io.h"
 #include "threads/interrupt.h"
@@ -37,6 +37,11 @@
 #define IER_RECV 0x01           /* Interrupt when data received. */
 #define IER_XMIT 0x02           /* Interrupt when transmit finishes. */
 
+/* FIFO Control Register bits. */
+#define FCR_ENABLE 0x01         /* Enable the FIFOs. */
+#define FCR_CLEAR 0x06          /* Clear both FIFOs. */
+#define FIFO_SIZE 16            /* Bytes in the transmit FIFO. */
+
 /* Line Control Register bits. */
 #define LCR_N81 0x03            /* No parity, 8 data bits, 1 stop bit. */
 #define LCR_DLAB 0x80           /* Divisor Latch Access Bit (DLAB). */
@@ -51,9 +56,24 @@
 /* Transmission mode. */
 static enum { UNINIT, POLL, QUEUE } mode;
 
-/* Data to be transmitted. */
-static struct intq txq;
-
+/* Data to be transmitted, in a ring buffer.  Writers append
+   whole buffers at a time with interrupts off; the transmit
+   interrupt drains it a FIFO load at a time.  It is much larger
+   than an intq so that a burst of console output usually fits
+   without the writer having to wait for the UART. */
+#define TXQ_SIZE 8192           /* Must be a power of 2. */
+static uint8_t txq[TXQ_SIZE];
+static unsigned txq_head;       /* Next byte to transmit. */
+static unsigned txq_tail;       /* Next free slot. */
+
+/* Threads waiting for room in txq, and the semaphore they wait
+   on.  The transmit interrupt wakes them. */
+static struct semaphore txq_room;
+static int txq_waiters;
+
+static bool txq_empty (void);
+static bool txq_full (void);
+static uint8_t txq_getc (void);
 static void set_serial (int bps);
 static void putc_poll (uint8_t);
 static void write_ier (void);
@@ -71,7 +91,7 @@ init_poll (void)
   outb (FCR_REG, 0);                    /* Disable FIFO. */
   set_serial (9600);                    /* 9.6 kbps, N-8-1. */
   outb (MCR_REG, MCR_OUT2);             /* Required to enable interrupts. */
-  intq_init (&txq);
+  sema_init (&txq_room, 0);
   mode = POLL;
 } 
 
@@ -87,6 +107,10 @@ serial_init_queue (void)
     init_poll ();
   ASSERT (mode == POLL);
 
+  /* Let the transmit interrupt hand the UART FIFO_SIZE bytes at
+     a time.  The receive trigger level stays at 1 byte. */
+  outb (FCR_REG, FCR_ENABLE | FCR_CLEAR);
+
   intr_register_ext (0x20 + 4, serial_interrupt, "serial");
   mode = QUEUE;
   old_level = intr_disable ();
@@ -98,31 +122,62 @@ serial_init_queue (void)
 void
 serial_putc (uint8_t byte) 
 {
+  serial_write (&byte, 1);
+}
+
+/* Sends the SIZE bytes in BUFFER to the serial port.
+
+   Once the port is set up for interrupt-driven I/O, this only
+   copies BUFFER into the transmit queue, so it returns without
+   waiting for the UART unless the queue fills up.  Then, if
+   interrupts were on, it sleeps until the transmit interrupt
+   makes room; otherwise, waiting would mean reenabling
+   interrupts, which is impolite, so it sends bytes by polling
+   instead. */
+void
+serial_write (const void *buffer, size_t size) 
+{
+  const uint8_t *p = buffer;
   enum intr_level old_level = intr_disable ();
 
   if (mode != QUEUE)
     {
       /* If we're not set up for interrupt-driven I/O yet,
-         use dumb polling to transmit a byte. */
+         use dumb polling to transmit. */
       if (mode == UNINIT)
         init_poll ();
-      putc_poll (byte); 
+      while (size-- > 0)
+        putc_poll (*p++);
     }
   else 
     {
-      /* Otherwise, queue a byte and update the interrupt enable
-         register. */
-      if (old_level == INTR_OFF && intq_full (&txq)) 
+      while (size > 0)
         {
-          /* Interrupts are off and the transmit queue is full.
-             If we wanted to wait for the queue to empty,
-             we'd have to reenable interrupts.
-             That's impolite, so we'll send a character via
-             polling instead. */
-          putc_poll (intq_getc (&txq)); 
+          size_t room, chunk, ofs;
+
+          while (txq_full ())
+            {
+              if (old_level == INTR_OFF || intr_context ())
+                putc_poll (txq_getc ());
+              else
+                {
+                  write_ier ();
+                  txq_waiters++;
+                  sema_down (&txq_room);
+                }
+            }
+
+          /* Copy as much as fits before the end of the ring. */
+          room = TXQ_SIZE - (txq_tail - txq_head);
+          ofs = txq_tail % TXQ_SIZE;
+          chunk = size < room ? size : room;
+          if (chunk > TXQ_SIZE - ofs)
+            chunk = TXQ_SIZE - ofs;
+          memcpy (txq + ofs, p, chunk);
+          txq_tail += chunk;
+          p += chunk;
+          size -= chunk;
         }
-
-      intq_putc (&txq, byte); 
       write_ier ();
     }
   
@@ -135,8 +190,8 @@ void
 serial_flush (void) 
 {
   enum intr_level old_level = intr_disable ();
-  while (!intq_empty (&txq))
-    putc_poll (intq_getc (&txq));
+  while (!txq_empty ())
+    putc_poll (txq_getc ());
   intr_set_level (old_level);
 }
 
@@ -182,7 +237,7 @@ write_ier (void)
 
   /* Enable transmit interrupt if we have any characters to
      transmit. */
-  if (!intq_empty (&txq))
+  if (!txq_empty ())
     ier |= IER_XMIT;
 
   /* Enable receive interrupt if we have room to store any
@@ -218,11 +273,45 @@ serial_interrupt (struct intr_frame *f UNUSED)
   while (!input_full () && (inb (LSR_REG) & LSR_DR) != 0)
     input_putc (inb (RBR_REG));
 
-  /* As long as we have a byte to transmit, and the hardware is
-     ready to accept a byte for transmission, transmit a byte. */
-  while (!intq_empty (&txq) && (inb (LSR_REG) & LSR_THRE) != 0) 
-    outb (THR_REG, intq_getc (&txq));
+  /* If we have bytes to transmit and the transmit FIFO is empty,
+     refill it. */
+  if (!txq_empty () && (inb (LSR_REG) & LSR_THRE) != 0) 
+    {
+      int i;
+
+      for (i = 0; i < FIFO_SIZE && !txq_empty (); i++)
+        outb (THR_REG, txq_getc ());
+    }
+
+  /* Wake up everyone waiting for room. */
+  if (!txq_full ())
+    for (; txq_waiters > 0; txq_waiters--)
+      sema_up (&txq_room);
 
   /* Update interrupt enable register based on queue status. */
   write_ier ();
 }
+
+/* Returns true if txq has no bytes to transmit. */
+static bool
+txq_empty (void) 
+{
+  return txq_head == txq_tail;
+}
+
+/* Returns true if txq has no room for another byte. */
+static bool
+txq_full (void) 
+{
+  return txq_tail - txq_head == TXQ_SIZE;
+}
+
+/* Removes and returns the next byte to transmit from txq, which
+   must not be empty. */
+static uint8_t
+txq_getc (void) 
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+  ASSERT (!txq_empty ());
+  return txq[txq_head++ % TXQ_SIZE];
+}
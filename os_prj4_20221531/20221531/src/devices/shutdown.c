@@ -4,8 +4,11 @@
 #include "devices/kbd.h"
 #include "devices/serial.h"
 #include "devices/timer.h"
+#include "threads/interrupt.h"
 #include "threads/io.h"
 #include "threads/thread.h"
+#include "threads/profile.h"
+#include "threads/workqueue.h"
 #ifdef USERPROG
 #include "userprog/exception.h"
 #endif
@@ -96,6 +99,7 @@ shutdown_power_off (void)
 
   print_stats ();
 
+  profile_dump ();
   printf ("Powering off...\n");
   serial_flush ();
 
@@ -130,6 +134,13 @@ print_stats (void)
 {
   timer_print_stats ();
   thread_print_stats ();
+#ifdef LOCKSTAT
+  lockstat_print (false);
+#endif
+#ifdef INTRTRACE
+  intr_trace_print ();
+#endif
+  workqueue_print_stats ();
 #ifdef FILESYS
   block_print_stats ();
 #endif
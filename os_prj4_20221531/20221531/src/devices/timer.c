@@ -7,6 +7,8 @@
 #include "threads/interrupt.h"
 #include "threads/synch.h"
 #include "threads/thread.h"
+#include "threads/profile.h"
+#include "threads/workqueue.h"
 
 #define FRACTION (1 << 14)
 
@@ -26,13 +28,33 @@ static int64_t ticks;
    Initialized by timer_calibrate(). */
 static unsigned loops_per_tick;
 
+/* Number of timer ticks to count time-stamp counter cycles
+   across in timer_calibrate(). */
+#define TSC_CALIBRATE_TICKS 10
+
+/* Nanoseconds per timer tick. */
+#define NS_PER_TICK (1000 * 1000 * 1000 / TIMER_FREQ)
+
+/* Time-stamp counter cycles per second, or 0 until
+   timer_calibrate() has measured it.  TSC_BASE was read when
+   timer_now_ns() returned NS_BASE. */
+static uint64_t tsc_hz;
+static uint64_t tsc_base;
+static int64_t ns_base;
+
+/* Sleeping threads, soonest wakeup_tick first. */
 struct list sleep_list;
 
+/* Last tick handled by timer_softirq(). */
+static int64_t softirq_ticks;
+
 static intr_handler_func timer_interrupt;
+static softirq_func timer_softirq;
 static bool too_many_loops (unsigned loops);
 static void busy_wait (int64_t loops);
 static void real_time_sleep (int64_t num, int32_t denom);
 static void real_time_delay (int64_t num, int32_t denom);
+static void tsc_calibrate (void);
 
 /* Sets up the timer to interrupt TIMER_FREQ times per second,
    and registers the corresponding interrupt. */
@@ -41,6 +63,7 @@ timer_init (void)
 {
   pit_configure_channel (0, 2, TIMER_FREQ);
   intr_register_ext (0x20, timer_interrupt, "8254 Timer");
+  softirq_register (SOFTIRQ_TIMER, timer_softirq);
 
   //sleep_list 초기화
   list_init(&sleep_list);
@@ -71,6 +94,8 @@ timer_calibrate (void)
       loops_per_tick |= test_bit;
 
   printf ("%'"PRIu64" loops/s.\n", (uint64_t) loops_per_tick * TIMER_FREQ);
+
+  tsc_calibrate ();
 }
 
 /* Returns the number of timer ticks since the OS booted. */
@@ -91,6 +116,52 @@ timer_elapsed (int64_t then)
   return timer_ticks () - then;
 }
 
+/* Returns the number of nanoseconds since the OS booted.  Once
+   timer_calibrate() has run, this has the resolution of the
+   CPU's time-stamp counter; before that, of a timer tick. */
+int64_t
+timer_now_ns (void)
+{
+  if (tsc_hz == 0)
+    return timer_ticks () * NS_PER_TICK;
+  return ns_base + timer_cycles_to_ns (timer_cycles () - tsc_base);
+}
+
+/* Returns the CPU's time-stamp counter, which counts processor
+   cycles.  Subtract two readings and pass the difference to
+   timer_cycles_to_ns() to time a short interval cheaply. */
+uint64_t
+timer_cycles (void)
+{
+  uint64_t tsc;
+  asm volatile ("rdtsc" : "=A" (tsc));
+  return tsc;
+}
+
+/* Converts CYCLES time-stamp counter cycles to nanoseconds.
+   Returns 0 if timer_calibrate() has not run yet. */
+uint64_t
+timer_cycles_to_ns (uint64_t cycles)
+{
+  const uint64_t ns_per_s = 1000 * 1000 * 1000;
+
+  if (tsc_hz == 0)
+    return 0;
+
+  /* Split CYCLES into whole seconds and a remainder so that the
+     multiplication cannot overflow. */
+  return cycles / tsc_hz * ns_per_s + cycles % tsc_hz * ns_per_s / tsc_hz;
+}
+
+/* Returns true if sleeping thread A wakes up before B. */
+static bool
+wakes_earlier (const struct list_elem *a, const struct list_elem *b,
+               void *aux UNUSED)
+{
+  return (list_entry (a, struct thread, elem)->wakeup_tick
+          < list_entry (b, struct thread, elem)->wakeup_tick);
+}
+
 /* Sleeps for approximately TICKS timer ticks.  Interrupts must
    be turned on. */
 void
@@ -103,7 +174,8 @@ timer_sleep (int64_t ticks)
   
   enum intr_level old_level = intr_disable();
   thread_current()->wakeup_tick = target_tick;
-  list_push_back(&sleep_list, &thread_current()->elem);
+  list_insert_ordered(&sleep_list, &thread_current()->elem,
+                      wakes_earlier, NULL);
   thread_block();
   intr_set_level(old_level);
 }
@@ -177,44 +249,114 @@ timer_print_stats (void)
 {
   printf ("Timer: %"PRId64" ticks\n", timer_ticks ());
 }
+
+/* Measures tsc_hz by counting time-stamp counter cycles across
+   TSC_CALIBRATE_TICKS ticks of the PIT. */
+static void
+tsc_calibrate (void)
+{
+  uint64_t start_tsc, end_tsc;
+  int64_t start;
+
+  ASSERT (intr_get_level () == INTR_ON);
+
+  /* Start on a tick boundary. */
+  start = ticks;
+  while (ticks == start)
+    barrier ();
+  start_tsc = timer_cycles ();
+
+  start = ticks;
+  while (ticks - start < TSC_CALIBRATE_TICKS)
+    barrier ();
+  end_tsc = timer_cycles ();
+
+  /* Continue timer_now_ns() from where ticks left it. */
+  ns_base = timer_ticks () * NS_PER_TICK;
+  tsc_base = end_tsc;
+  tsc_hz = (end_tsc - start_tsc) * TIMER_FREQ / TSC_CALIBRATE_TICKS;
+  printf ("Time-stamp counter runs at %'"PRIu64" kHz.\n", tsc_hz / 1000);
+}
 
-/* Timer interrupt handler. */
+/* Timer interrupt handler.  Does only what has to be done on
+   every tick and leaves the rest to timer_softirq(). */
 static void
-timer_interrupt (struct intr_frame *args UNUSED)
+timer_interrupt (struct intr_frame *args)
 {
   ticks++;
   thread_tick ();
-  struct list_elem *next;
-  struct list_elem *e;
-
-  for (e = list_begin(&sleep_list); e != list_end(&sleep_list); e = next) {
-      struct thread *t = list_entry(e, struct thread, elem);
-      next = list_next(e); // 삭제하기 전에 'next'를 미리 가져옴
-
-      if (t->wakeup_tick <= ticks) {
-          list_remove(&t->elem); // 또는 list_remove(e)
-          thread_unblock(t);
-      }
-  }
-
-  if (thread_mlfqs) {
-  // 매 틱마다 현재 스레드의 recent_cpu 1 증가
-      
+  profile_tick (args);
+
+  if (thread_mlfqs)
+    {
+      // 매 틱마다 현재 스레드의 recent_cpu 1 증가
       thread_current()->recent_cpu = thread_current()->recent_cpu + FRACTION;
-      
-
-      // 매 4틱마다 모든 스레드의 우선순위 재계산
-      if (timer_ticks() % 4 == 0) {
-          update_all_priority();
-      }
-
-      // 매 1초(TIMER_FREQ 틱)마다 load_avg와 recent_cpu 재계산
-      if (timer_ticks() % TIMER_FREQ == 0) {
-          update_load_avg();
-          update_recent_cpu();
-          // (update_all_priority()는 이미 4틱마다 호출되므로 100틱째에도 호출됨)
-      }
-  }
+    }
+
+  softirq_raise (SOFTIRQ_TIMER);
+}
+
+/* Wakes the sleepers due by tick TICK.  Each is taken off the
+   list in its own short critical section. */
+static void
+wake_sleepers (int64_t tick)
+{
+  for (;;)
+    {
+      struct thread *t = NULL;
+      enum intr_level old_level = intr_disable ();
+
+      if (!list_empty (&sleep_list))
+        {
+          t = list_entry (list_front (&sleep_list), struct thread, elem);
+          if (t->wakeup_tick <= tick)
+            {
+              list_remove (&t->elem);
+              thread_unblock (t);
+            }
+          else
+            t = NULL;
+        }
+      intr_set_level (old_level);
+      if (t == NULL)
+        break;
+    }
+}
+
+/* Timer bottom half.  Catches up with every tick since it last
+   ran, which is usually just one.  For each tick it first wakes
+   the sleepers due then, so that they count as ready, and then
+   does the MLFQS bookkeeping for that tick, as the timer
+   interrupt itself used to.  Runs with interrupts on. */
+static void
+timer_softirq (void)
+{
+  int64_t now = timer_ticks ();
+  enum intr_level old_level;
+
+  for (; softirq_ticks < now; softirq_ticks++)
+    {
+      int64_t tick = softirq_ticks + 1;
+
+      wake_sleepers (tick);
+      if (thread_mlfqs)
+        {
+          // 매 4틱마다 모든 스레드의 우선순위 재계산
+          if (tick % 4 == 0)
+            update_all_priority();
+
+          // 매 1초(TIMER_FREQ 틱)마다 load_avg와 recent_cpu 재계산
+          if (tick % TIMER_FREQ == 0)
+            {
+              update_load_avg();
+              update_recent_cpu();
+            }
+        }
+    }
+
+  old_level = intr_disable ();
+  workqueue_tick (now);
+  intr_set_level (old_level);
 }
 
 /* Returns true if LOOPS iterations waits for more than one timer
@@ -282,6 +424,20 @@ real_time_sleep (int64_t num, int32_t denom)
 static void
 real_time_delay (int64_t num, int32_t denom)
 {
+  if (num <= 0)
+    return;
+  if (tsc_hz != 0)
+    {
+      /* Spin on the time-stamp counter, which is accurate to
+         the cycle no matter how the loop below would have been
+         compiled or interrupted. */
+      uint64_t cycles = num / denom * tsc_hz + num % denom * tsc_hz / denom;
+      uint64_t start = timer_cycles ();
+      while (timer_cycles () - start < cycles)
+        barrier ();
+      return;
+    }
+
   /* Scale the numerator and denominator down by 1000 to avoid
      the possibility of overflow. */
   ASSERT (denom % 1000 == 0);
@@ -1,4 +1,5 @@
 #include "devices/vga.h"
+#include <debug.h>
 #include <round.h>
 #include <stdint.h>
 #include <stddef.h>
@@ -26,6 +27,28 @@ static size_t cx, cy;
    The attribute at (x,y) is fb[y][x][1]. */
 static uint8_t (*fb)[COL_CNT][2];
 
+/* Output waiting to be drawn by the VGA softirq, in a ring
+   buffer.  Drawing a character is cheap, but scrolling and
+   updating the hardware cursor are not, so printf-heavy code
+   runs faster if it only appends here and a softirq draws a
+   whole batch at once, moving the cursor just once at the end. */
+#define PENDING_SIZE 4096       /* Must be a power of 2. */
+static char pending[PENDING_SIZE];
+static unsigned pending_head;   /* Next character to draw. */
+static unsigned pending_tail;   /* Next free slot. */
+
+/* Most queued characters the softirq draws with interrupts off.
+   It raises itself again for the rest, so that a full queue,
+   with its scrolling, does not hold off interrupts for long and
+   a backlog is handed to ksoftirqd like any other. */
+#define SOFTIRQ_BATCH 256
+
+/* True once output may be deferred to the softirq. */
+static bool deferred;
+
+static void draw (int c, enum intr_level);
+static void draw_pending (void);
+static void vga_softirq (void);
 static void clear_row (size_t y);
 static void cls (void);
 static void newline (void);
@@ -46,6 +69,15 @@ init (void)
     }
 }
 
+/* Starts deferring output written with vga_write() to a
+   softirq.  Must be called after softirq_init(). */
+void
+vga_init_deferred (void) 
+{
+  softirq_register (SOFTIRQ_VGA, vga_softirq);
+  deferred = true;
+}
+
 /* Writes C to the VGA text display, interpreting control
    characters in the conventional ways.  */
 void
@@ -56,7 +88,82 @@ vga_putc (int c)
   enum intr_level old_level = intr_disable ();
 
   init ();
-  
+  draw_pending ();
+  draw (c, old_level);
+
+  /* Update cursor position. */
+  move_cursor ();
+
+  intr_set_level (old_level);
+}
+
+/* Writes the N characters in BUFFER to the VGA text display.
+   Once vga_init_deferred() has been called, this normally just
+   queues them for the VGA softirq to draw.  It draws them
+   immediately, after anything already queued, if there is no
+   room to queue them or if they include a bell, which has to
+   beep in the writer's context. */
+void
+vga_write (const char *buffer, size_t n) 
+{
+  enum intr_level old_level = intr_disable ();
+
+  if (deferred && n <= PENDING_SIZE && memchr (buffer, '\a', n) == NULL)
+    {
+      size_t ofs, chunk;
+
+      if (n > PENDING_SIZE - (pending_tail - pending_head))
+        {
+          init ();
+          draw_pending ();
+        }
+
+      ofs = pending_tail % PENDING_SIZE;
+      chunk = n < PENDING_SIZE - ofs ? n : PENDING_SIZE - ofs;
+      memcpy (pending + ofs, buffer, chunk);
+      memcpy (pending, buffer + chunk, n - chunk);
+      pending_tail += n;
+      softirq_raise (SOFTIRQ_VGA);
+    }
+  else 
+    {
+      init ();
+      draw_pending ();
+      while (n-- > 0)
+        draw (*buffer++, old_level);
+      move_cursor ();
+    }
+
+  intr_set_level (old_level);
+}
+
+/* Draws any queued output now and stops deferring output.
+   Called when the kernel panics, because the softirq might never
+   get a chance to run. */
+void
+vga_flush (void) 
+{
+  enum intr_level old_level = intr_disable ();
+
+  deferred = false;
+  if (pending_head != pending_tail)
+    {
+      init ();
+      draw_pending ();
+      move_cursor ();
+    }
+
+  intr_set_level (old_level);
+}
+
+/* Draws C at the cursor, without updating the hardware cursor.
+   Interrupts must be off.  OLD_LEVEL is the interrupt level to
+   restore while beeping for a bell. */
+static void
+draw (int c, enum intr_level old_level)
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+
   switch (c) 
     {
     case '\n':
@@ -95,13 +202,40 @@ vga_putc (int c)
         newline ();
       break;
     }
+}
 
-  /* Update cursor position. */
-  move_cursor ();
+/* Draws the output queued by vga_write(), without updating the
+   hardware cursor.  The queue never holds a bell. */
+static void
+draw_pending (void) 
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  while (pending_head != pending_tail)
+    draw (pending[pending_head++ % PENDING_SIZE], INTR_OFF);
+}
+
+/* VGA softirq: draws up to SOFTIRQ_BATCH queued characters.
+   Moves the cursor once the queue is empty, or else raises
+   itself again to draw the rest with interrupts enabled in
+   between. */
+static void
+vga_softirq (void) 
+{
+  enum intr_level old_level = intr_disable ();
+  unsigned n;
+
+  init ();
+  for (n = 0; n < SOFTIRQ_BATCH && pending_head != pending_tail; n++)
+    draw (pending[pending_head++ % PENDING_SIZE], INTR_OFF);
+  if (pending_head == pending_tail)
+    move_cursor ();
+  else
+    softirq_raise (SOFTIRQ_VGA);
 
   intr_set_level (old_level);
 }
-
+
 /* Clears the screen and moves the cursor to the upper left. */
 static void
 cls (void)
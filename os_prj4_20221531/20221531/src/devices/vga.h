@@ -1,6 +1,11 @@
 #ifndef DEVICES_VGA_H
 #define DEVICES_VGA_H
 
+#include <stddef.h>
+
+void vga_init_deferred (void);
 void vga_putc (int);
+void vga_write (const char *, size_t);
+void vga_flush (void);
 
 #endif /* devices/vga.h */
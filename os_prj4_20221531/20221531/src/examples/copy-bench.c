@@ -0,0 +1,87 @@
+/* copy-bench.c
+
+   Compares copying a file through a user buffer, with read()
+   and write(), against copying it in the kernel with
+   copy_file_range().
+
+   Usage: copy-bench [KB] */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <syscall.h>
+
+static char buffer[1024];
+
+/* Creates file NAME, SIZE bytes long, and returns it open. */
+static int
+make_file (const char *name, int size)
+{
+  int fd;
+
+  remove (name);
+  if (!create (name, size) || (fd = open (name)) < 0)
+    {
+      printf ("copy-bench: %s: create failed\n", name);
+      exit (EXIT_FAILURE);
+    }
+  return fd;
+}
+
+/* Prints the throughput of copying BYTES in the time since
+   START. */
+static void
+report (const char *what, int bytes, int64_t start)
+{
+  int64_t ns = clock_ns () - start;
+
+  if (ns <= 0)
+    ns = 1;
+  printf ("%-17s %7lld us, %6lld kB/s\n", what, ns / 1000,
+          (int64_t) bytes * 1000000 / ns);
+}
+
+int
+main (int argc, char *argv[])
+{
+  int kb = argc > 1 ? atoi (argv[1]) : 64;
+  int size = kb * 1024;
+  int in_fd, out_fd, left, n;
+  int64_t start;
+
+  if (kb <= 0)
+    {
+      printf ("usage: copy-bench [KB]\n");
+      return EXIT_FAILURE;
+    }
+
+  in_fd = make_file ("copy-bench.in", size);
+  for (n = 0; n < (int) sizeof buffer; n++)
+    buffer[n] = 'a' + n % 26;
+  for (left = size; left > 0; left -= n)
+    n = write (in_fd, buffer, left < (int) sizeof buffer
+                              ? left : (int) sizeof buffer);
+
+  /* Through a user buffer, as cp used to. */
+  out_fd = make_file ("copy-bench.out", size);
+  seek (in_fd, 0);
+  start = clock_ns ();
+  while ((n = read (in_fd, buffer, sizeof buffer)) > 0)
+    write (out_fd, buffer, n);
+  report ("read + write:", size, start);
+  close (out_fd);
+
+  /* In the kernel. */
+  out_fd = make_file ("copy-bench.out", size);
+  seek (in_fd, 0);
+  start = clock_ns ();
+  n = copy_file_range (in_fd, out_fd, size);
+  report ("copy_file_range:", size, start);
+  if (n != size)
+    printf ("copy-bench: copied only %d of %d bytes\n", n, size);
+  close (out_fd);
+
+  close (in_fd);
+  remove ("copy-bench.in");
+  remove ("copy-bench.out");
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,101 @@
+/* io-bench.c
+
+   Compares ways of doing the same file I/O with fewer system
+   calls:
+
+     - reading scattered records with seek() and read() versus
+       pread(), and
+
+     - writing a file assembled from small pieces with one
+       write() per piece versus one writev() per group of
+       pieces.
+
+   Usage: io-bench [KB] */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <syscall.h>
+
+/* Size of a record or piece, in bytes. */
+#define RECORD 64
+
+/* Number of pieces gathered by each writev(). */
+#define GATHER 16
+
+static char pieces[GATHER][RECORD];
+
+/* Prints the throughput of moving BYTES in the time since START. */
+static void
+report (const char *what, int bytes, int64_t start)
+{
+  int64_t ns = clock_ns () - start;
+
+  if (ns <= 0)
+    ns = 1;
+  printf ("%-22s %6lld us, %6lld kB/s\n", what, ns / 1000,
+          (int64_t) bytes * 1000000 / ns);
+}
+
+int
+main (int argc, char *argv[])
+{
+  int kb = argc > 1 ? atoi (argv[1]) : 32;
+  int size = kb * 1024;
+  int records = size / RECORD;
+  struct iovec iov[GATHER];
+  char record[RECORD];
+  int64_t start;
+  int fd, i;
+
+  if (kb <= 0)
+    {
+      printf ("usage: io-bench [KB]\n");
+      return EXIT_FAILURE;
+    }
+
+  for (i = 0; i < GATHER; i++)
+    {
+      int j;
+      for (j = 0; j < RECORD; j++)
+        pieces[i][j] = 'a' + (i + j) % 26;
+      iov[i].iov_base = pieces[i];
+      iov[i].iov_len = RECORD;
+    }
+
+  remove ("io-bench.dat");
+  if (!create ("io-bench.dat", size) || (fd = open ("io-bench.dat")) < 0)
+    {
+      printf ("io-bench: create failed\n");
+      return EXIT_FAILURE;
+    }
+
+  /* Gathered writes. */
+  start = clock_ns ();
+  for (i = 0; i < records; i++)
+    write (fd, pieces[i % GATHER], RECORD);
+  report ("write per piece:", size, start);
+
+  seek (fd, 0);
+  start = clock_ns ();
+  for (i = 0; i < records; i += GATHER)
+    writev (fd, iov, records - i < GATHER ? records - i : GATHER);
+  report ("writev per 16 pieces:", size, start);
+
+  /* Scattered reads, visiting records in a fixed stride. */
+  start = clock_ns ();
+  for (i = 0; i < records; i++)
+    {
+      seek (fd, (i * 7 % records) * RECORD);
+      read (fd, record, RECORD);
+    }
+  report ("seek + read:", size, start);
+
+  start = clock_ns ();
+  for (i = 0; i < records; i++)
+    pread (fd, record, RECORD, (i * 7 % records) * RECORD);
+  report ("pread:", size, start);
+
+  close (fd);
+  remove ("io-bench.dat");
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,133 @@
+/* par-read.c
+
+   Benchmark for concurrent file reads.  Creates PROCS files of
+   KB kilobytes each, then times child processes reading them
+   three ways: one child at a time, all at once on their own
+   files, and all at once on the same file.  With a file system
+   that serializes every operation, the concurrent runs take as
+   long as the sequential one.
+
+   Usage: par-read [PROCS] [KB] */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syscall.h>
+
+#define MAX_PROCS 8
+
+/* Number of times each child reads its file. */
+#define ROUNDS 4
+
+static char buf[4096];
+
+/* Child: reads FILE from start to end ROUNDS times. */
+static int
+read_file (const char *file)
+{
+  int fd = open (file);
+  int round;
+
+  if (fd < 0)
+    {
+      printf ("par-read: %s: open failed\n", file);
+      return EXIT_FAILURE;
+    }
+  for (round = 0; round < ROUNDS; round++)
+    {
+      seek (fd, 0);
+      while (read (fd, buf, sizeof buf) > 0)
+        continue;
+    }
+  close (fd);
+  return EXIT_SUCCESS;
+}
+
+/* Returns the name of the file for child I in NAME. */
+static void
+file_name (char name[20], int i)
+{
+  snprintf (name, 20, "par-read.%d", i);
+}
+
+/* Starts PROCS children, each reading the file for child I, or
+   all reading the file for child 0 if SHARED, and waits for
+   them, CONCURRENT at once or one at a time.  Returns the
+   elapsed time in milliseconds. */
+static int64_t
+run (int procs, bool concurrent, bool shared)
+{
+  pid_t pids[MAX_PROCS];
+  int64_t start = clock_ns ();
+  int i;
+
+  for (i = 0; i < procs; i++)
+    {
+      char cmd[40], name[20];
+
+      file_name (name, shared ? 0 : i);
+      snprintf (cmd, sizeof cmd, "par-read -r %s", name);
+      pids[i] = exec (cmd);
+      if (pids[i] == PID_ERROR)
+        {
+          printf ("par-read: exec failed\n");
+          exit (EXIT_FAILURE);
+        }
+      if (!concurrent)
+        wait (pids[i]);
+    }
+  if (concurrent)
+    for (i = 0; i < procs; i++)
+      wait (pids[i]);
+  return (clock_ns () - start) / 1000000;
+}
+
+int
+main (int argc, char *argv[])
+{
+  int procs, kb, i;
+
+  if (argc == 3 && !strcmp (argv[1], "-r"))
+    return read_file (argv[2]);
+
+  procs = argc > 1 ? atoi (argv[1]) : 4;
+  kb = argc > 2 ? atoi (argv[2]) : 64;
+  if (procs < 1 || procs > MAX_PROCS || kb < 1)
+    {
+      printf ("usage: par-read [PROCS] [KB], with 1 <= PROCS <= %d\n",
+              MAX_PROCS);
+      return EXIT_FAILURE;
+    }
+
+  memset (buf, 'x', sizeof buf);
+  for (i = 0; i < procs; i++)
+    {
+      char name[20];
+      int fd, left;
+
+      file_name (name, i);
+      remove (name);
+      if (!create (name, kb * 1024) || (fd = open (name)) < 0)
+        {
+          printf ("par-read: %s: create failed\n", name);
+          return EXIT_FAILURE;
+        }
+      for (left = kb * 1024; left > 0; left -= sizeof buf)
+        write (fd, buf, left < (int) sizeof buf ? left : (int) sizeof buf);
+      close (fd);
+    }
+
+  printf ("par-read: %d processes, %d kB each, %d passes\n",
+          procs, kb, ROUNDS);
+  printf ("one at a time:        %lld ms\n", run (procs, false, false));
+  printf ("concurrent, own file: %lld ms\n", run (procs, true, false));
+  printf ("concurrent, shared:   %lld ms\n", run (procs, true, true));
+
+  for (i = 0; i < procs; i++)
+    {
+      char name[20];
+      file_name (name, i);
+      remove (name);
+    }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,137 @@
+/* pipe-bench.c
+
+   Compares passing data from a producer process to a consumer
+   process through a pipe against the workaround of writing it
+   to a temporary file that the consumer then reads.  Both
+   transfer whole pages from page-aligned buffers, so the pipe
+   can hand pages to the consumer by remapping them.
+
+   Usage: pipe-bench [KB]
+
+   The program runs itself as the consumer, as
+   "pipe-bench -p RFD WFD KB" or "pipe-bench -f KB".  With -p it
+   first closes WFD, the write end it inherited, so that it sees
+   end of file once the producer closes its own. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syscall.h>
+
+#define PAGE_SIZE 4096
+
+static char buffer[PAGE_SIZE] __attribute__ ((aligned (PAGE_SIZE)));
+
+/* Consumer: reads FD to end of file and returns success if it
+   got exactly SIZE bytes. */
+static int
+consume (int fd, int size)
+{
+  int total = 0;
+  int n;
+
+  while ((n = read (fd, buffer, sizeof buffer)) > 0)
+    total += n;
+  if (total != size)
+    {
+      printf ("pipe-bench: consumed %d of %d bytes\n", total, size);
+      return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
+
+/* Writes SIZE bytes to FD a page at a time. */
+static void
+produce (int fd, int size)
+{
+  int left, n;
+
+  for (left = size; left > 0; left -= n)
+    n = write (fd, buffer, left < PAGE_SIZE ? left : PAGE_SIZE);
+}
+
+/* Waits for consumer PID, started with command line CMD. */
+static void
+wait_consumer (pid_t pid, const char *cmd)
+{
+  if (pid < 0 || wait (pid) != EXIT_SUCCESS)
+    printf ("pipe-bench: \"%s\" failed\n", cmd);
+}
+
+/* Prints the throughput of passing BYTES in the time since
+   START. */
+static void
+report (const char *what, int bytes, int64_t start)
+{
+  int64_t ns = clock_ns () - start;
+
+  if (ns <= 0)
+    ns = 1;
+  printf ("%-12s %7lld us, %6lld kB/s\n", what, ns / 1000,
+          (int64_t) bytes * 1000000 / ns);
+}
+
+int
+main (int argc, char *argv[])
+{
+  char cmd[64];
+  int kb, size, fd, fds[2];
+  pid_t pid;
+  int64_t start;
+
+  if (argc == 5 && !strcmp (argv[1], "-p"))
+    {
+      close (atoi (argv[3]));
+      return consume (atoi (argv[2]), atoi (argv[4]) * 1024);
+    }
+  if (argc == 3 && !strcmp (argv[1], "-f"))
+    {
+      int result;
+
+      fd = open ("pipe-bench.tmp");
+      result = consume (fd, atoi (argv[2]) * 1024);
+      close (fd);
+      return result;
+    }
+
+  kb = argc > 1 ? atoi (argv[1]) : 256;
+  size = kb * 1024;
+  if (kb <= 0)
+    {
+      printf ("usage: pipe-bench [KB]\n");
+      return EXIT_FAILURE;
+    }
+  memset (buffer, 'p', sizeof buffer);
+
+  /* Through a pipe, with the consumer running alongside. */
+  start = clock_ns ();
+  if (pipe (fds) < 0)
+    {
+      printf ("pipe-bench: pipe failed\n");
+      return EXIT_FAILURE;
+    }
+  snprintf (cmd, sizeof cmd, "pipe-bench -p %d %d %d", fds[0], fds[1], kb);
+  pid = exec (cmd);
+  close (fds[0]);
+  produce (fds[1], size);
+  close (fds[1]);
+  wait_consumer (pid, cmd);
+  report ("pipe:", size, start);
+
+  /* Through a temporary file, consumed after it is complete. */
+  start = clock_ns ();
+  remove ("pipe-bench.tmp");
+  if (!create ("pipe-bench.tmp", 0) || (fd = open ("pipe-bench.tmp")) < 0)
+    {
+      printf ("pipe-bench: pipe-bench.tmp: create failed\n");
+      return EXIT_FAILURE;
+    }
+  produce (fd, size);
+  close (fd);
+  snprintf (cmd, sizeof cmd, "pipe-bench -f %d", kb);
+  wait_consumer (exec (cmd), cmd);
+  report ("temp file:", size, start);
+  remove ("pipe-bench.tmp");
+
+  return EXIT_SUCCESS;
+}
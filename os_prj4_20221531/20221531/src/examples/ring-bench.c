@@ -0,0 +1,121 @@
+/* ring-bench.c
+
+   Compares system calls made one at a time with the same calls
+   queued on a submission ring and carried out in batches of
+   RING_ENTRIES by ring_enter(), first for calls that do
+   nothing and then for small reads from a file.
+
+   Usage: ring-bench [ITERATIONS] */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <syscall.h>
+
+/* Size of each read. */
+#define READ_SIZE 16
+
+static struct ring ring;
+static char buf[READ_SIZE];
+
+/* Returns how many operations per second ITERATIONS of them
+   taking NS nanoseconds amounts to. */
+static int64_t
+per_second (int iterations, int64_t ns)
+{
+  return ns > 0 ? iterations * 1000000000LL / ns : 0;
+}
+
+/* Carries out ITERATIONS operations OP on FD through the ring,
+   RING_ENTRIES at a time, and returns how long it took in
+   nanoseconds. */
+static int64_t
+time_ring (int op, int fd, int iterations)
+{
+  int64_t start = clock_ns ();
+  int done = 0;
+
+  while (done < iterations)
+    {
+      int batch = iterations - done < RING_ENTRIES
+                  ? iterations - done : RING_ENTRIES;
+      int i;
+
+      for (i = 0; i < batch; i++)
+        {
+          struct ring_sqe *sqe = &ring.sq[ring.sq_tail++ % RING_ENTRIES];
+          sqe->op = op;
+          sqe->fd = fd;
+          sqe->buf = buf;
+          sqe->len = sizeof buf;
+          sqe->user_data = done + i;
+        }
+      if (ring_enter (batch) != batch)
+        {
+          printf ("ring-bench: ring_enter failed\n");
+          exit (EXIT_FAILURE);
+        }
+      ring.cq_head = ring.cq_tail;
+      done += batch;
+    }
+  return clock_ns () - start;
+}
+
+int
+main (int argc, char *argv[])
+{
+  int iterations = argc > 1 ? atoi (argv[1]) : 10000;
+  int64_t start, one_ns, ring_ns;
+  int fd, i;
+
+  if (iterations <= 0)
+    {
+      printf ("usage: ring-bench [ITERATIONS]\n");
+      return EXIT_FAILURE;
+    }
+  if (ring_setup (&ring) != 0)
+    {
+      printf ("ring-bench: ring_setup failed\n");
+      return EXIT_FAILURE;
+    }
+
+  start = clock_ns ();
+  for (i = 0; i < iterations; i++)
+    null_syscall ();
+  one_ns = clock_ns () - start;
+  ring_ns = time_ring (RING_NOP, 0, iterations);
+  printf ("null: %lld calls/s one at a time, %lld calls/s batched\n",
+          per_second (iterations, one_ns), per_second (iterations, ring_ns));
+
+  remove ("ring-bench.tmp");
+  if (!create ("ring-bench.tmp", READ_SIZE * RING_ENTRIES)
+      || (fd = open ("ring-bench.tmp")) < 0)
+    {
+      printf ("ring-bench: could not create ring-bench.tmp\n");
+      return EXIT_FAILURE;
+    }
+
+  /* Reads wrap around to the start of the file every
+     RING_ENTRIES calls. */
+  start = clock_ns ();
+  for (i = 0; i < iterations; i++)
+    {
+      if (i % RING_ENTRIES == 0)
+        seek (fd, 0);
+      read (fd, buf, sizeof buf);
+    }
+  one_ns = clock_ns () - start;
+
+  ring_ns = 0;
+  for (i = 0; i < iterations; i += RING_ENTRIES)
+    {
+      int batch = iterations - i < RING_ENTRIES ? iterations - i : RING_ENTRIES;
+      seek (fd, 0);
+      ring_ns += time_ring (RING_READ, fd, batch);
+    }
+  printf ("read: %lld calls/s one at a time, %lld calls/s batched\n",
+          per_second (iterations, one_ns), per_second (iterations, ring_ns));
+
+  close (fd);
+  remove ("ring-bench.tmp");
+  return EXIT_SUCCESS;
+}
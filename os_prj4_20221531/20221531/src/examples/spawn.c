@@ -0,0 +1,35 @@
+/* spawn.c
+
+   Starts a trivial child process COUNT times, waiting for each
+   one to exit, as a benchmark for process creation.  Compare
+   the timer ticks and the "Thread pages" line that the kernel
+   prints at shutdown across kernel versions. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syscall.h>
+
+int
+main (int argc, char *argv[])
+{
+  int count, i;
+
+  /* The child does nothing. */
+  if (argc == 2 && !strcmp (argv[1], "-"))
+    return EXIT_SUCCESS;
+
+  count = argc > 1 ? atoi (argv[1]) : 100;
+  for (i = 0; i < count; i++)
+    {
+      pid_t pid = exec ("spawn -");
+      if (pid == PID_ERROR)
+        {
+          printf ("spawn: exec failed after %d children\n", i);
+          return EXIT_FAILURE;
+        }
+      wait (pid);
+    }
+  printf ("spawn: started %d children\n", count);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,50 @@
+/* syscall-bench.c
+
+   Measures the round-trip cost of a system call that does
+   nothing, entering the kernel first through `int $0x30' and
+   then through SYSENTER.
+
+   Usage: syscall-bench [ITERATIONS] */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <syscall.h>
+
+/* Returns the average cost of ITERATIONS null system calls, in
+   nanoseconds. */
+static int64_t
+time_null_syscalls (int iterations)
+{
+  int64_t start = clock_ns ();
+  int i;
+
+  for (i = 0; i < iterations; i++)
+    null_syscall ();
+  return (clock_ns () - start) / iterations;
+}
+
+int
+main (int argc, char *argv[])
+{
+  int iterations = argc > 1 ? atoi (argv[1]) : 100000;
+  int64_t slow_ns, fast_ns;
+
+  if (iterations <= 0)
+    {
+      printf ("usage: syscall-bench [ITERATIONS]\n");
+      return EXIT_FAILURE;
+    }
+
+  sysenter_enable (false);
+  slow_ns = time_null_syscalls (iterations);
+  printf ("int $0x30: %lld ns per null system call\n", slow_ns);
+
+  if (!sysenter_enable (true))
+    {
+      printf ("sysenter: not supported by this CPU\n");
+      return EXIT_SUCCESS;
+    }
+  fast_ns = time_null_syscalls (iterations);
+  printf ("sysenter:  %lld ns per null system call\n", fast_ns);
+  return EXIT_SUCCESS;
+}
@@ -2,12 +2,16 @@
 #include <debug.h>
 #include "filesys/inode.h"
 #include "threads/malloc.h"
+#include "threads/synch.h"
 
-/* An open file. */
+/* An open file.  Threads of a process share their open files,
+   so file_read() and file_write() hold `pos_lock' to keep two of
+   them from using the same position. */
 struct file 
   {
     struct inode *inode;        /* File's inode. */
     off_t pos;                  /* Current position. */
+    struct lock pos_lock;       /* Serializes reads and writes at pos. */
     bool deny_write;            /* Has file_deny_write() been called? */
   };
 
@@ -22,6 +26,7 @@ file_open (struct inode *inode)
     {
       file->inode = inode;
       file->pos = 0;
+      lock_init (&file->pos_lock);
       file->deny_write = false;
       return file;
     }
@@ -68,8 +73,12 @@ file_get_inode (struct file *file)
 off_t
 file_read (struct file *file, void *buffer, off_t size) 
 {
-  off_t bytes_read = inode_read_at (file->inode, buffer, size, file->pos);
+  off_t bytes_read;
+
+  lock_acquire (&file->pos_lock);
+  bytes_read = inode_read_at (file->inode, buffer, size, file->pos);
   file->pos += bytes_read;
+  lock_release (&file->pos_lock);
   return bytes_read;
 }
 
@@ -94,8 +103,12 @@ file_read_at (struct file *file, void *buffer, off_t size, off_t file_ofs)
 off_t
 file_write (struct file *file, const void *buffer, off_t size) 
 {
-  off_t bytes_written = inode_write_at (file->inode, buffer, size, file->pos);
+  off_t bytes_written;
+
+  lock_acquire (&file->pos_lock);
+  bytes_written = inode_write_at (file->inode, buffer, size, file->pos);
   file->pos += bytes_written;
+  lock_release (&file->pos_lock);
   return bytes_written;
 }
 
@@ -113,6 +126,62 @@ file_write_at (struct file *file, const void *buffer, off_t size,
   return inode_write_at (file->inode, buffer, size, file_ofs);
 }
 
+/* Reads from FILE into the CNT buffers in IOV in turn, starting
+   at the file's current position.  Returns the number of bytes
+   actually read, which may be less than the buffers' total size
+   if end of file is reached.  Advances FILE's position by the
+   number of bytes read. */
+off_t
+file_readv (struct file *file, const struct iovec *iov, int cnt) 
+{
+  off_t bytes_read;
+
+  lock_acquire (&file->pos_lock);
+  bytes_read = inode_readv_at (file->inode, iov, cnt, file->pos);
+  file->pos += bytes_read;
+  lock_release (&file->pos_lock);
+  return bytes_read;
+}
+
+/* Writes the CNT buffers in IOV into FILE in turn, starting at
+   the file's current position.  Returns the number of bytes
+   actually written, which may be less than the buffers' total
+   size if end of file is reached.  Advances FILE's position by
+   the number of bytes written. */
+off_t
+file_writev (struct file *file, const struct iovec *iov, int cnt) 
+{
+  off_t bytes_written;
+
+  lock_acquire (&file->pos_lock);
+  bytes_written = inode_writev_at (file->inode, iov, cnt, file->pos);
+  file->pos += bytes_written;
+  lock_release (&file->pos_lock);
+  return bytes_written;
+}
+
+/* Reads SIZE bytes from FILE into BUFFER, starting at offset
+   FILE_OFS, to bring in a page on a page fault.  Unlike
+   file_read_at(), does not wait for writers, since the faulting
+   thread may itself be in the middle of a write.
+   Returns the number of bytes actually read. */
+off_t
+file_page_read (struct file *file, void *buffer, off_t size, off_t file_ofs) 
+{
+  return inode_page_read (file->inode, buffer, size, file_ofs);
+}
+
+/* Writes SIZE bytes from BUFFER into FILE, starting at offset
+   FILE_OFS, to write back a page that is being evicted or
+   unmapped.  See file_page_read().
+   Returns the number of bytes actually written. */
+off_t
+file_page_write (struct file *file, const void *buffer, off_t size,
+                 off_t file_ofs) 
+{
+  return inode_page_write (file->inode, buffer, size, file_ofs);
+}
+
 /* Prevents write operations on FILE's underlying inode
    until file_allow_write() is called or FILE is closed. */
 void
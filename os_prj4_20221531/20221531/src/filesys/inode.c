@@ -3,9 +3,15 @@
 #include <debug.h>
 #include <round.h>
 #include <string.h>
+#include <uio.h>
 #include "filesys/filesys.h"
 #include "filesys/free-map.h"
+#include "threads/interrupt.h"
 #include "threads/malloc.h"
+#include "threads/synch.h"
+#ifdef USERPROG
+#include "userprog/exec-cache.h"
+#endif
 
 /* Identifies an inode. */
 #define INODE_MAGIC 0x494e4f44
@@ -28,7 +34,15 @@ bytes_to_sectors (off_t size)
   return DIV_ROUND_UP (size, BLOCK_SECTOR_SIZE);
 }
 
-/* In-memory inode. */
+/* In-memory inode.
+
+   `rw' is held for reading by inode_read_at() and for writing by
+   inode_write_at(), so reads of an inode proceed in parallel but
+   never see a write half done.  It also protects
+   `deny_write_cnt'.  `data' never changes once the inode is open,
+   because files do not grow, so its length and sectors can be
+   read without a lock.  `lock' is for callers that need several
+   reads and writes to happen as a unit; see inode_lock(). */
 struct inode 
   {
     struct list_elem elem;              /* Element in inode list. */
@@ -36,6 +50,9 @@ struct inode
     int open_cnt;                       /* Number of openers. */
     bool removed;                       /* True if deleted, false otherwise. */
     int deny_write_cnt;                 /* 0: writes ok, >0: deny writes. */
+    unsigned write_cnt;                 /* Number of writes, for caches. */
+    struct rwlock rw;                   /* Orders reads and writes. */
+    struct lock lock;                   /* See inode_lock(). */
     struct inode_disk data;             /* Inode content. */
   };
 
@@ -54,14 +71,35 @@ byte_to_sector (const struct inode *inode, off_t pos)
 }
 
 /* List of open inodes, so that opening a single inode twice
-   returns the same `struct inode'. */
+   returns the same `struct inode'.  Lookups far outnumber opens
+   of new inodes and last closes, so the list is protected by a
+   readers-writer lock. */
 static struct list open_inodes;
+static struct rwlock open_inodes_lock;
 
 /* Initializes the inode module. */
 void
 inode_init (void) 
 {
   list_init (&open_inodes);
+  rwlock_init (&open_inodes_lock);
+}
+
+/* Returns the open inode for SECTOR, reopened, or a null pointer
+   if there is none.  The caller must hold open_inodes_lock. */
+static struct inode *
+lookup_open_inode (block_sector_t sector)
+{
+  struct list_elem *e;
+
+  for (e = list_begin (&open_inodes); e != list_end (&open_inodes);
+       e = list_next (e)) 
+    {
+      struct inode *inode = list_entry (e, struct inode, elem);
+      if (inode->sector == sector) 
+        return inode_reopen (inode);
+    }
+  return NULL;
 }
 
 /* Initializes an inode with LENGTH bytes of data and
@@ -111,33 +149,40 @@ inode_create (block_sector_t sector, off_t length)
 struct inode *
 inode_open (block_sector_t sector)
 {
-  struct list_elem *e;
   struct inode *inode;
 
   /* Check whether this inode is already open. */
-  for (e = list_begin (&open_inodes); e != list_end (&open_inodes);
-       e = list_next (e)) 
-    {
-      inode = list_entry (e, struct inode, elem);
-      if (inode->sector == sector) 
-        {
-          inode_reopen (inode);
-          return inode; 
-        }
-    }
+  rwlock_acquire_read (&open_inodes_lock);
+  inode = lookup_open_inode (sector);
+  rwlock_release_read (&open_inodes_lock);
+  if (inode != NULL)
+    return inode;
+
+  /* Check again, in case someone opened it while the lock was
+     free, and add it if not. */
+  rwlock_acquire_write (&open_inodes_lock);
+  inode = lookup_open_inode (sector);
+  if (inode != NULL)
+    goto done;
 
   /* Allocate memory. */
   inode = malloc (sizeof *inode);
   if (inode == NULL)
-    return NULL;
+    goto done;
 
   /* Initialize. */
   list_push_front (&open_inodes, &inode->elem);
   inode->sector = sector;
   inode->open_cnt = 1;
   inode->deny_write_cnt = 0;
+  inode->write_cnt = 0;
   inode->removed = false;
+  rwlock_init (&inode->rw);
+  lock_init (&inode->lock);
   block_read (fs_device, inode->sector, &inode->data);
+
+ done:
+  rwlock_release_write (&open_inodes_lock);
   return inode;
 }
 
@@ -146,7 +191,12 @@ struct inode *
 inode_reopen (struct inode *inode)
 {
   if (inode != NULL)
-    inode->open_cnt++;
+    {
+      /* Readers of open_inodes_lock may reopen concurrently. */
+      enum intr_level old_level = intr_disable ();
+      inode->open_cnt++;
+      intr_set_level (old_level);
+    }
   return inode;
 }
 
@@ -167,11 +217,15 @@ inode_close (struct inode *inode)
   if (inode == NULL)
     return;
 
-  /* Release resources if this was the last opener. */
+  /* Release resources if this was the last opener.  Holding
+     open_inodes_lock for writing keeps inode_open() from finding
+     INODE while it is being torn down. */
+  rwlock_acquire_write (&open_inodes_lock);
   if (--inode->open_cnt == 0)
     {
       /* Remove from inode list and release lock. */
       list_remove (&inode->elem);
+      rwlock_release_write (&open_inodes_lock);
  
       /* Deallocate blocks if removed. */
       if (inode->removed) 
@@ -183,6 +237,8 @@ inode_close (struct inode *inode)
 
       free (inode); 
     }
+  else
+    rwlock_release_write (&open_inodes_lock);
 }
 
 /* Marks INODE to be deleted when it is closed by the last caller who
@@ -192,13 +248,82 @@ inode_remove (struct inode *inode)
 {
   ASSERT (inode != NULL);
   inode->removed = true;
+#ifdef USERPROG
+  /* The exec cache holds INODE open; let it go so that its blocks
+     are freed once the other openers close it. */
+  exec_cache_remove (inode);
+#endif
+}
+
+/* Returns true if INODE has been removed. */
+bool
+inode_is_removed (const struct inode *inode)
+{
+  return inode->removed;
+}
+
+/* Acquires INODE's lock, which its users may hold to make a
+   sequence of reads and writes atomic, such as looking up a
+   directory entry and then changing it.  The lock is not held
+   by the inode functions themselves. */
+void
+inode_lock (struct inode *inode)
+{
+  lock_acquire (&inode->lock);
+}
+
+/* Releases INODE's lock. */
+void
+inode_unlock (struct inode *inode)
+{
+  lock_release (&inode->lock);
 }
 
 /* Reads SIZE bytes from INODE into BUFFER, starting at position OFFSET.
    Returns the number of bytes actually read, which may be less
    than SIZE if an error occurs or end of file is reached. */
 off_t
-inode_read_at (struct inode *inode, void *buffer_, off_t size, off_t offset) 
+inode_read_at (struct inode *inode, void *buffer, off_t size, off_t offset) 
+{
+  off_t bytes_read;
+
+  rwlock_acquire_read (&inode->rw);
+  bytes_read = inode_page_read (inode, buffer, size, offset);
+  rwlock_release_read (&inode->rw);
+  return bytes_read;
+}
+
+/* Reads from INODE into the CNT buffers in IOV in turn, starting
+   at position OFFSET, as a single read.  Returns the number of
+   bytes actually read, which may be less than the buffers' total
+   size if an error occurs or end of file is reached. */
+off_t
+inode_readv_at (struct inode *inode, const struct iovec *iov, int cnt,
+                off_t offset)
+{
+  off_t bytes_read = 0;
+  int i;
+
+  rwlock_acquire_read (&inode->rw);
+  for (i = 0; i < cnt; i++)
+    {
+      off_t chunk = inode_page_read (inode, iov[i].iov_base,
+                                     iov[i].iov_len, offset + bytes_read);
+      bytes_read += chunk;
+      if (chunk < (off_t) iov[i].iov_len)
+        break;
+    }
+  rwlock_release_read (&inode->rw);
+  return bytes_read;
+}
+
+/* Like inode_read_at(), but without acquiring INODE's rwlock,
+   for reading pages in on a page fault.  The fault may have come
+   from a thread that holds the rwlock while copying to or from
+   user memory, so waiting for it here could deadlock. */
+off_t
+inode_page_read (struct inode *inode, void *buffer_, off_t size,
+                 off_t offset) 
 {
   uint8_t *buffer = buffer_;
   off_t bytes_read = 0;
@@ -255,8 +380,48 @@ inode_read_at (struct inode *inode, void *buffer_, off_t size, off_t offset)
    (Normally a write at end of file would extend the inode, but
    growth is not yet implemented.) */
 off_t
-inode_write_at (struct inode *inode, const void *buffer_, off_t size,
+inode_write_at (struct inode *inode, const void *buffer, off_t size,
                 off_t offset) 
+{
+  off_t bytes_written;
+
+  rwlock_acquire_write (&inode->rw);
+  bytes_written = inode_page_write (inode, buffer, size, offset);
+  rwlock_release_write (&inode->rw);
+  return bytes_written;
+}
+
+/* Writes the CNT buffers in IOV into INODE in turn, starting at
+   OFFSET, as a single write.  Returns the number of bytes
+   actually written, which may be less than the buffers' total
+   size if end of file is reached or an error occurs. */
+off_t
+inode_writev_at (struct inode *inode, const struct iovec *iov, int cnt,
+                 off_t offset)
+{
+  off_t bytes_written = 0;
+  int i;
+
+  rwlock_acquire_write (&inode->rw);
+  for (i = 0; i < cnt; i++)
+    {
+      off_t chunk = inode_page_write (inode, iov[i].iov_base,
+                                      iov[i].iov_len,
+                                      offset + bytes_written);
+      bytes_written += chunk;
+      if (chunk < (off_t) iov[i].iov_len)
+        break;
+    }
+  rwlock_release_write (&inode->rw);
+  return bytes_written;
+}
+
+/* Like inode_write_at(), but without acquiring INODE's rwlock,
+   for writing back pages being evicted or unmapped.  See
+   inode_page_read(). */
+off_t
+inode_page_write (struct inode *inode, const void *buffer_, off_t size,
+                  off_t offset) 
 {
   const uint8_t *buffer = buffer_;
   off_t bytes_written = 0;
@@ -264,6 +429,7 @@ inode_write_at (struct inode *inode, const void *buffer_, off_t size,
 
   if (inode->deny_write_cnt)
     return 0;
+  inode->write_cnt++;
 
   while (size > 0) 
     {
@@ -317,13 +483,16 @@ inode_write_at (struct inode *inode, const void *buffer_, off_t size,
   return bytes_written;
 }
 
-/* Disables writes to INODE.
+/* Disables writes to INODE, waiting for any write in progress
+   to finish.
    May be called at most once per inode opener. */
 void
 inode_deny_write (struct inode *inode) 
 {
+  rwlock_acquire_write (&inode->rw);
   inode->deny_write_cnt++;
   ASSERT (inode->deny_write_cnt <= inode->open_cnt);
+  rwlock_release_write (&inode->rw);
 }
 
 /* Re-enables writes to INODE.
@@ -332,9 +501,20 @@ inode_deny_write (struct inode *inode)
 void
 inode_allow_write (struct inode *inode) 
 {
+  rwlock_acquire_write (&inode->rw);
   ASSERT (inode->deny_write_cnt > 0);
   ASSERT (inode->deny_write_cnt <= inode->open_cnt);
   inode->deny_write_cnt--;
+  rwlock_release_write (&inode->rw);
+}
+
+/* Returns the number of writes made to INODE since it was
+   opened.  Something derived from INODE's data is still valid if
+   this has not changed since it was derived. */
+unsigned
+inode_write_cnt (const struct inode *inode)
+{
+  return inode->write_cnt;
 }
 
 /* Returns the length, in bytes, of INODE's data. */
@@ -6,6 +6,7 @@
 #include "devices/block.h"
 
 struct bitmap;
+struct iovec;
 
 void inode_init (void);
 bool inode_create (block_sector_t, off_t);
@@ -14,10 +15,21 @@ struct inode *inode_reopen (struct inode *);
 block_sector_t inode_get_inumber (const struct inode *);
 void inode_close (struct inode *);
 void inode_remove (struct inode *);
+bool inode_is_removed (const struct inode *);
+void inode_lock (struct inode *);
+void inode_unlock (struct inode *);
 off_t inode_read_at (struct inode *, void *, off_t size, off_t offset);
 off_t inode_write_at (struct inode *, const void *, off_t size, off_t offset);
+off_t inode_readv_at (struct inode *, const struct iovec *, int cnt,
+                      off_t offset);
+off_t inode_writev_at (struct inode *, const struct iovec *, int cnt,
+                       off_t offset);
+off_t inode_page_read (struct inode *, void *, off_t size, off_t offset);
+off_t inode_page_write (struct inode *, const void *, off_t size,
+                        off_t offset);
 void inode_deny_write (struct inode *);
 void inode_allow_write (struct inode *);
+unsigned inode_write_cnt (const struct inode *);
 off_t inode_length (const struct inode *);
 
 #endif /* filesys/inode.h */
@@ -1,6 +1,7 @@
 #include <console.h>
 #include <stdarg.h>
 #include <stdio.h>
+#include <string.h>
 #include "devices/serial.h"
 #include "devices/vga.h"
 #include "threads/init.h"
@@ -8,7 +9,7 @@
 #include "threads/synch.h"
 
 static void vprintf_helper (char, void *);
-static void putchar_have_lock (uint8_t c);
+static void putbuf_have_lock (const char *, size_t);
 
 /* The console lock.
    Both the vga and serial layers do their own locking, so it's
@@ -74,6 +75,7 @@ void
 console_panic (void) 
 {
   use_console_lock = false;
+  vga_flush ();
 }
 
 /* Prints console statistics. */
@@ -119,19 +121,31 @@ console_locked_by_current_thread (void)
           || lock_held_by_current_thread (&console_lock));
 }
 
+/* vprintf() collects output in one of these so that it can
+   write it to the console a chunk at a time. */
+struct vprintf_aux
+  {
+    int char_cnt;               /* Characters output so far. */
+    size_t len;                 /* Characters in BUF. */
+    char buf[64];               /* Output not yet written. */
+  };
+
 /* The standard vprintf() function,
    which is like printf() but uses a va_list.
    Writes its output to both vga display and serial port. */
 int
 vprintf (const char *format, va_list args) 
 {
-  int char_cnt = 0;
+  struct vprintf_aux aux;
 
+  aux.char_cnt = 0;
+  aux.len = 0;
   acquire_console ();
-  __vprintf (format, args, vprintf_helper, &char_cnt);
+  __vprintf (format, args, vprintf_helper, &aux);
+  putbuf_have_lock (aux.buf, aux.len);
   release_console ();
 
-  return char_cnt;
+  return aux.char_cnt;
 }
 
 /* Writes string S to the console, followed by a new-line
@@ -140,9 +154,8 @@ int
 puts (const char *s) 
 {
   acquire_console ();
-  while (*s != '\0')
-    putchar_have_lock (*s++);
-  putchar_have_lock ('\n');
+  putbuf_have_lock (s, strlen (s));
+  putbuf_have_lock ("\n", 1);
   release_console ();
 
   return 0;
@@ -153,8 +166,7 @@ void
 putbuf (const char *buffer, size_t n) 
 {
   acquire_console ();
-  while (n-- > 0)
-    putchar_have_lock (*buffer++);
+  putbuf_have_lock (buffer, n);
   release_console ();
 }
 
@@ -162,30 +174,39 @@ putbuf (const char *buffer, size_t n)
 int
 putchar (int c) 
 {
+  char ch = c;
+
   acquire_console ();
-  putchar_have_lock (c);
+  putbuf_have_lock (&ch, 1);
   release_console ();
   
   return c;
 }
-
+
 /* Helper function for vprintf(). */
 static void
-vprintf_helper (char c, void *char_cnt_) 
+vprintf_helper (char c, void *aux_) 
 {
-  int *char_cnt = char_cnt_;
-  (*char_cnt)++;
-  putchar_have_lock (c);
+  struct vprintf_aux *aux = aux_;
+
+  aux->char_cnt++;
+  aux->buf[aux->len++] = c;
+  if (aux->len >= sizeof aux->buf)
+    {
+      putbuf_have_lock (aux->buf, aux->len);
+      aux->len = 0;
+    }
 }
 
-/* Writes C to the vga display and serial port.
-   The caller has already acquired the console lock if
+/* Writes the N characters in BUFFER to the vga display and
+   serial port.  Neither waits for the hardware unless its queue
+   is full.  The caller has already acquired the console lock if
    appropriate. */
 static void
-putchar_have_lock (uint8_t c) 
+putbuf_have_lock (const char *buffer, size_t n) 
 {
   ASSERT (console_locked_by_current_thread ());
-  write_cnt++;
-  serial_putc (c);
-  vga_putc (c);
+  write_cnt += n;
+  serial_write (buffer, n);
+  vga_write (buffer, n);
 }
@@ -0,0 +1,40 @@
+#include "histogram.h"
+#include <stdio.h>
+#include "../debug.h"
+
+/* Returns the bucket of a histogram of BUCKET_CNT buckets that
+   counts a latency of NS nanoseconds. */
+int
+histogram_bucket (uint64_t ns, int bucket_cnt)
+{
+  uint64_t limit = 1000;
+  int bucket = 0;
+
+  ASSERT (bucket_cnt > 0);
+
+  while (bucket < bucket_cnt - 1 && ns >= limit)
+    {
+      bucket++;
+      limit *= 2;
+    }
+  return bucket;
+}
+
+/* Prints the nonempty buckets of the BUCKET_CNT-bucket histogram
+   COUNTS, one per line, labeled with their ranges in us. */
+void
+histogram_print (const unsigned long long counts[], int bucket_cnt)
+{
+  int i;
+
+  for (i = 0; i < bucket_cnt; i++)
+    if (counts[i] != 0)
+      {
+        if (i == 0)
+          printf ("  %8s %7s us: %llu\n", "", "< 1", counts[i]);
+        else if (i == bucket_cnt - 1)
+          printf ("  %8s %7d us: %llu\n", ">=", 1 << (i - 1), counts[i]);
+        else
+          printf ("  %8d-%7d us: %llu\n", 1 << (i - 1), 1 << i, counts[i]);
+      }
+}
@@ -0,0 +1,18 @@
+#ifndef __LIB_KERNEL_HISTOGRAM_H
+#define __LIB_KERNEL_HISTOGRAM_H
+
+/* Latency histograms.
+
+   A histogram of BUCKET_CNT buckets counts values under 1 us in
+   bucket 0, those from 2**(I-1) up to 2**I us in bucket I, for
+   0 < I < BUCKET_CNT - 1, and everything longer in the last
+   bucket.  This is the layout of the histograms in
+   lib/schedstat.h and lib/trace.h, and of the interrupts-off
+   tracer's. */
+
+#include <stdint.h>
+
+int histogram_bucket (uint64_t ns, int bucket_cnt);
+void histogram_print (const unsigned long long counts[], int bucket_cnt);
+
+#endif /* lib/kernel/histogram.h */
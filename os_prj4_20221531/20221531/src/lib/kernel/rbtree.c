@@ -0,0 +1,340 @@
+#include "rbtree.h"
+#include "../debug.h"
+
+/* The algorithms are those of [CLRS] chapter 13, adapted to use
+   null pointers instead of a sentinel leaf.  A null child is
+   black. */
+
+static bool
+is_red (const struct rb_elem *e)
+{
+  return e != NULL && e->red;
+}
+
+/* Initializes TREE as an empty tree ordered by LESS given
+   auxiliary data AUX. */
+void
+rb_init (struct rb_tree *tree, rb_less_func *less, void *aux)
+{
+  ASSERT (tree != NULL);
+  ASSERT (less != NULL);
+
+  tree->root = tree->first = NULL;
+  tree->elem_cnt = 0;
+  tree->less = less;
+  tree->aux = aux;
+}
+
+/* Makes NEW take OLD's place as a child of OLD's parent, or as
+   TREE's root.  Does not update NEW's parent pointer. */
+static void
+replace_child (struct rb_tree *tree, struct rb_elem *old,
+               struct rb_elem *new)
+{
+  struct rb_elem *parent = old->parent;
+
+  if (parent == NULL)
+    tree->root = new;
+  else if (parent->left == old)
+    parent->left = new;
+  else
+    parent->right = new;
+}
+
+/* Rotates the subtree rooted at X to the left. */
+static void
+rotate_left (struct rb_tree *tree, struct rb_elem *x)
+{
+  struct rb_elem *y = x->right;
+
+  x->right = y->left;
+  if (y->left != NULL)
+    y->left->parent = x;
+  replace_child (tree, x, y);
+  y->parent = x->parent;
+  y->left = x;
+  x->parent = y;
+}
+
+/* Rotates the subtree rooted at X to the right. */
+static void
+rotate_right (struct rb_tree *tree, struct rb_elem *x)
+{
+  struct rb_elem *y = x->left;
+
+  x->left = y->right;
+  if (y->right != NULL)
+    y->right->parent = x;
+  replace_child (tree, x, y);
+  y->parent = x->parent;
+  y->right = x;
+  x->parent = y;
+}
+
+/* Restores the red-black properties after red element E has
+   been linked into TREE. */
+static void
+insert_fixup (struct rb_tree *tree, struct rb_elem *e)
+{
+  struct rb_elem *parent;
+
+  while (is_red (parent = e->parent))
+    {
+      struct rb_elem *grandparent = parent->parent;
+
+      if (parent == grandparent->left)
+        {
+          struct rb_elem *uncle = grandparent->right;
+          if (is_red (uncle))
+            {
+              parent->red = uncle->red = false;
+              grandparent->red = true;
+              e = grandparent;
+              continue;
+            }
+          if (e == parent->right)
+            {
+              e = parent;
+              rotate_left (tree, e);
+              parent = e->parent;
+            }
+          parent->red = false;
+          grandparent->red = true;
+          rotate_right (tree, grandparent);
+        }
+      else
+        {
+          struct rb_elem *uncle = grandparent->left;
+          if (is_red (uncle))
+            {
+              parent->red = uncle->red = false;
+              grandparent->red = true;
+              e = grandparent;
+              continue;
+            }
+          if (e == parent->left)
+            {
+              e = parent;
+              rotate_right (tree, e);
+              parent = e->parent;
+            }
+          parent->red = false;
+          grandparent->red = true;
+          rotate_left (tree, grandparent);
+        }
+    }
+  tree->root->red = false;
+}
+
+/* Inserts NEW into TREE.  NEW is placed after any elements that
+   compare equal to it. */
+void
+rb_insert (struct rb_tree *tree, struct rb_elem *new)
+{
+  struct rb_elem **link = &tree->root;
+  struct rb_elem *parent = NULL;
+  bool leftmost = true;
+
+  ASSERT (tree != NULL);
+  ASSERT (new != NULL);
+
+  while (*link != NULL)
+    {
+      parent = *link;
+      if (tree->less (new, parent, tree->aux))
+        link = &parent->left;
+      else
+        {
+          link = &parent->right;
+          leftmost = false;
+        }
+    }
+
+  new->parent = parent;
+  new->left = new->right = NULL;
+  new->red = true;
+  *link = new;
+  if (leftmost)
+    tree->first = new;
+  tree->elem_cnt++;
+
+  insert_fixup (tree, new);
+}
+
+/* Restores the red-black properties after a black element was
+   removed from TREE.  X, which may be null, is the element that
+   took its place and X_PARENT is X's parent. */
+static void
+remove_fixup (struct rb_tree *tree, struct rb_elem *x,
+              struct rb_elem *x_parent)
+{
+  while (x != tree->root && !is_red (x))
+    {
+      if (x == x_parent->left)
+        {
+          struct rb_elem *w = x_parent->right;
+          if (w->red)
+            {
+              w->red = false;
+              x_parent->red = true;
+              rotate_left (tree, x_parent);
+              w = x_parent->right;
+            }
+          if (!is_red (w->left) && !is_red (w->right))
+            {
+              w->red = true;
+              x = x_parent;
+              x_parent = x->parent;
+            }
+          else
+            {
+              if (!is_red (w->right))
+                {
+                  w->left->red = false;
+                  w->red = true;
+                  rotate_right (tree, w);
+                  w = x_parent->right;
+                }
+              w->red = x_parent->red;
+              x_parent->red = false;
+              w->right->red = false;
+              rotate_left (tree, x_parent);
+              x = tree->root;
+            }
+        }
+      else
+        {
+          struct rb_elem *w = x_parent->left;
+          if (w->red)
+            {
+              w->red = false;
+              x_parent->red = true;
+              rotate_right (tree, x_parent);
+              w = x_parent->left;
+            }
+          if (!is_red (w->left) && !is_red (w->right))
+            {
+              w->red = true;
+              x = x_parent;
+              x_parent = x->parent;
+            }
+          else
+            {
+              if (!is_red (w->left))
+                {
+                  w->right->red = false;
+                  w->red = true;
+                  rotate_left (tree, w);
+                  w = x_parent->left;
+                }
+              w->red = x_parent->red;
+              x_parent->red = false;
+              w->left->red = false;
+              rotate_right (tree, x_parent);
+              x = tree->root;
+            }
+        }
+    }
+  if (x != NULL)
+    x->red = false;
+}
+
+/* Removes E, which must be in TREE, from TREE. */
+void
+rb_remove (struct rb_tree *tree, struct rb_elem *e)
+{
+  struct rb_elem *x, *x_parent;
+  bool removed_red;
+
+  ASSERT (tree != NULL);
+  ASSERT (e != NULL);
+  ASSERT (tree->elem_cnt > 0);
+
+  if (tree->first == e)
+    tree->first = rb_next (e);
+
+  removed_red = e->red;
+  if (e->left == NULL || e->right == NULL)
+    {
+      /* E has at most one child, which takes its place. */
+      x = e->left != NULL ? e->left : e->right;
+      x_parent = e->parent;
+      replace_child (tree, e, x);
+      if (x != NULL)
+        x->parent = x_parent;
+    }
+  else
+    {
+      /* E's successor Y, which has no left child, takes its
+         place, and Y's right child takes Y's. */
+      struct rb_elem *y = e->right;
+      while (y->left != NULL)
+        y = y->left;
+      removed_red = y->red;
+      x = y->right;
+      if (y->parent == e)
+        x_parent = y;
+      else
+        {
+          x_parent = y->parent;
+          x_parent->left = x;
+          if (x != NULL)
+            x->parent = x_parent;
+          y->right = e->right;
+          y->right->parent = y;
+        }
+      replace_child (tree, e, y);
+      y->parent = e->parent;
+      y->left = e->left;
+      y->left->parent = y;
+      y->red = e->red;
+    }
+  tree->elem_cnt--;
+
+  if (!removed_red)
+    remove_fixup (tree, x, x_parent);
+}
+
+/* Returns the smallest element in TREE, or a null pointer if
+   TREE is empty. */
+struct rb_elem *
+rb_first (const struct rb_tree *tree)
+{
+  ASSERT (tree != NULL);
+  return tree->first;
+}
+
+/* Returns the element following E in TREE's order, or a null
+   pointer if E is the largest element. */
+struct rb_elem *
+rb_next (const struct rb_elem *e)
+{
+  ASSERT (e != NULL);
+
+  if (e->right != NULL)
+    {
+      e = e->right;
+      while (e->left != NULL)
+        e = e->left;
+      return (struct rb_elem *) e;
+    }
+  while (e->parent != NULL && e == e->parent->right)
+    e = e->parent;
+  return e->parent;
+}
+
+/* Returns the number of elements in TREE. */
+size_t
+rb_size (const struct rb_tree *tree)
+{
+  ASSERT (tree != NULL);
+  return tree->elem_cnt;
+}
+
+/* Returns true if TREE is empty, false otherwise. */
+bool
+rb_empty (const struct rb_tree *tree)
+{
+  ASSERT (tree != NULL);
+  return tree->elem_cnt == 0;
+}
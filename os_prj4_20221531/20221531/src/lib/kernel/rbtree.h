@@ -0,0 +1,71 @@
+#ifndef __LIB_KERNEL_RBTREE_H
+#define __LIB_KERNEL_RBTREE_H
+
+/* Red-black tree.
+
+   A balanced binary search tree that keeps its elements sorted
+   according to a caller-supplied comparison function.
+   Insertion and removal take O(lg n) time; the smallest element
+   is cached, so rb_first() takes O(1) time.  Elements that
+   compare equal are kept in insertion order.
+
+   Like the lists and hash tables in this directory, the tree
+   does not use dynamic allocation.  Each structure that can
+   potentially be in a tree must embed a struct rb_elem member,
+   and rb_entry() converts a struct rb_elem back into the
+   structure that contains it.  Refer to lib/kernel/list.h for a
+   detailed explanation of the technique. */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Tree element. */
+struct rb_elem
+  {
+    struct rb_elem *parent;     /* Parent, or null for the root. */
+    struct rb_elem *left;       /* Left child, or null. */
+    struct rb_elem *right;      /* Right child, or null. */
+    bool red;                   /* Red or black? */
+  };
+
+/* Converts pointer to tree element RB_ELEM into a pointer to
+   the structure that RB_ELEM is embedded inside.  Supply the
+   name of the outer structure STRUCT and the member name MEMBER
+   of the tree element. */
+#define rb_entry(RB_ELEM, STRUCT, MEMBER)           \
+        ((STRUCT *) ((uint8_t *) &(RB_ELEM)->parent \
+                     - offsetof (STRUCT, MEMBER.parent)))
+
+/* Compares the value of two tree elements A and B, given
+   auxiliary data AUX.  Returns true if A is less than B, or
+   false if A is greater than or equal to B. */
+typedef bool rb_less_func (const struct rb_elem *a,
+                           const struct rb_elem *b,
+                           void *aux);
+
+/* Red-black tree. */
+struct rb_tree
+  {
+    struct rb_elem *root;       /* Root, or null if empty. */
+    struct rb_elem *first;      /* Smallest element, or null if empty. */
+    size_t elem_cnt;            /* Number of elements in tree. */
+    rb_less_func *less;         /* Comparison function. */
+    void *aux;                  /* Auxiliary data for `less'. */
+  };
+
+void rb_init (struct rb_tree *, rb_less_func *, void *aux);
+
+/* Insertion and deletion. */
+void rb_insert (struct rb_tree *, struct rb_elem *);
+void rb_remove (struct rb_tree *, struct rb_elem *);
+
+/* Traversal, in ascending order. */
+struct rb_elem *rb_first (const struct rb_tree *);
+struct rb_elem *rb_next (const struct rb_elem *);
+
+/* Information. */
+size_t rb_size (const struct rb_tree *);
+bool rb_empty (const struct rb_tree *);
+
+#endif /* lib/kernel/rbtree.h */
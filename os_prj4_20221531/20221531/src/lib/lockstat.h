@@ -0,0 +1,28 @@
+#ifndef __LIB_LOCKSTAT_H
+#define __LIB_LOCKSTAT_H
+
+#include <stdint.h>
+
+/* Number of waiting call sites remembered per lock class. */
+#define LOCKSTAT_SITES 4
+
+/* Statistics for one class of locks, as returned by the lockstat
+   system call.  Names longer than the fields are truncated. */
+struct lockstat
+  {
+    char name[32];                      /* Expression passed to lock_init(). */
+    char file[32];                      /* Source file of the lock_init(). */
+    uint64_t acquired;                  /* # of acquisitions. */
+    uint64_t contended;                 /* # that had to wait. */
+    int64_t wait_total_ns, wait_max_ns; /* Time spent waiting. */
+    int64_t hold_total_ns, hold_max_ns; /* Time spent holding. */
+    struct
+      {
+        uint32_t pc;                    /* Return address of lock_acquire(). */
+        uint32_t cnt;                   /* # of contended acquisitions. */
+        int64_t wait_ns;                /* Total time waited. */
+      }
+    sites[LOCKSTAT_SITES];              /* Longest waiting call sites. */
+  };
+
+#endif /* lib/lockstat.h */
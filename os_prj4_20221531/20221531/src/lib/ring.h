@@ -0,0 +1,60 @@
+#ifndef __LIB_RING_H
+#define __LIB_RING_H
+
+#include <stdint.h>
+
+/* Submission and completion rings for batched system calls.
+
+   A process registers a `struct ring' in its own memory with
+   ring_setup().  It then queues operations by filling in
+   sq[sq_tail % RING_ENTRIES] and advancing sq_tail, and has the
+   kernel carry out up to a given number of them with one
+   ring_enter() call.  Each operation's result is posted to
+   cq[cq_tail % RING_ENTRIES], which the process consumes by
+   advancing cq_head.
+
+   The indexes only ever increase; they wrap around at 2**32,
+   which is a multiple of RING_ENTRIES. */
+
+/* Number of entries in each ring.  A power of 2. */
+#define RING_ENTRIES 64
+
+/* Operations. */
+enum ring_op
+  {
+    RING_NOP,                   /* Do nothing; result is 0. */
+    RING_READ,                  /* read (fd, buf, len). */
+    RING_WRITE,                 /* write (fd, buf, len). */
+    RING_OPEN,                  /* open (buf). */
+    RING_CLOSE                  /* close (fd); result is 0. */
+  };
+
+/* Submission queue entry. */
+struct ring_sqe
+  {
+    int op;                     /* A RING_* operation. */
+    int fd;                     /* File descriptor. */
+    void *buf;                  /* Buffer, or file name for RING_OPEN. */
+    unsigned len;               /* Buffer size in bytes. */
+    uint32_t user_data;         /* Copied to the completion. */
+  };
+
+/* Completion queue entry. */
+struct ring_cqe
+  {
+    uint32_t user_data;         /* From the submission. */
+    int res;                    /* What the system call returned. */
+  };
+
+/* The rings.  Each index is written only by the side noted. */
+struct ring
+  {
+    uint32_t sq_head;           /* Kernel: next entry to carry out. */
+    uint32_t sq_tail;           /* Process: next entry to fill. */
+    uint32_t cq_head;           /* Process: next entry to consume. */
+    uint32_t cq_tail;           /* Kernel: next entry to post. */
+    struct ring_sqe sq[RING_ENTRIES];
+    struct ring_cqe cq[RING_ENTRIES];
+  };
+
+#endif /* lib/ring.h */
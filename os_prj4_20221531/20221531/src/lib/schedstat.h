@@ -0,0 +1,25 @@
+#ifndef __LIB_SCHEDSTAT_H
+#define __LIB_SCHEDSTAT_H
+
+#include <stdint.h>
+
+/* Number of buckets in a wakeup latency histogram.  Bucket 0
+   counts latencies under 1 us; bucket I, for 0 < I <
+   SCHEDSTAT_BUCKETS - 1, counts those from 2**(I-1) up to 2**I
+   us; the last bucket counts everything longer. */
+#define SCHEDSTAT_BUCKETS 16
+
+/* Scheduler statistics for one thread or the whole system, as
+   returned by the schedstat system call. */
+struct schedstat
+  {
+    int64_t run_ns;                     /* Time spent running. */
+    int64_t wait_ns;                    /* Time ready but not running. */
+    int64_t latency_max_ns;             /* Longest wakeup latency. */
+    unsigned voluntary;                 /* Switches away by blocking. */
+    unsigned involuntary;               /* Switches away while ready. */
+    unsigned wakeups;                   /* Runs after thread_unblock(). */
+    unsigned latency[SCHEDSTAT_BUCKETS]; /* Wakeup-to-run latencies. */
+  };
+
+#endif /* lib/schedstat.h */
@@ -31,7 +31,49 @@ enum
     SYS_MKDIR,                  /* Create a directory. */
     SYS_READDIR,                /* Reads a directory entry. */
     SYS_ISDIR,                  /* Tests if a fd represents a directory. */
-    SYS_INUMBER                 /* Returns the inode number for a fd. */
+    SYS_INUMBER,                /* Returns the inode number for a fd. */
+
+    /* Multithreaded processes. */
+    SYS_THREAD_CREATE,          /* Start another thread in this process. */
+    SYS_THREAD_EXIT,            /* Terminate the calling thread. */
+    SYS_THREAD_JOIN,            /* Wait for a thread to terminate. */
+    SYS_FUTEX_WAIT,             /* Sleep while a word holds a value. */
+    SYS_FUTEX_WAKE,             /* Wake threads sleeping on a word. */
+
+    /* Kernel statistics. */
+    SYS_LOCKSTAT,               /* Get a lock class's statistics. */
+
+    /* Clocks. */
+    SYS_CLOCK_NS,               /* Read the high-resolution clock. */
+
+    /* Scheduling. */
+    SYS_SCHED_DEADLINE,         /* Reserve CPU time as a real-time thread. */
+    SYS_SCHEDSTAT,              /* Get scheduler statistics. */
+
+    /* System call entry. */
+    SYS_NULL,                   /* Do nothing, to time entry and exit. */
+
+    /* Positioned and vectored I/O. */
+    SYS_PREAD,                  /* Read from a file at an offset. */
+    SYS_PWRITE,                 /* Write to a file at an offset. */
+    SYS_READV,                  /* Read from a file into several buffers. */
+    SYS_WRITEV,                 /* Write to a file from several buffers. */
+    SYS_COPY_FILE_RANGE,        /* Copy data between files in the kernel. */
+
+    /* Batched system calls. */
+    SYS_RING_SETUP,             /* Register submission/completion rings. */
+    SYS_RING_ENTER,             /* Carry out queued operations. */
+
+    /* System call tracing. */
+    SYS_TRACE,                  /* Start or stop tracing this process. */
+    SYS_TRACE_READ,             /* Read recorded system calls. */
+    SYS_TRACE_HIST,             /* Get a system call's latency histogram. */
+
+    /* Pipes. */
+    SYS_PIPE,                   /* Create a pipe. */
+
+    /* Shared memory. */
+    SYS_SHM_OPEN                /* Map a named shared memory segment. */
   };
 
 #endif /* lib/syscall-nr.h */
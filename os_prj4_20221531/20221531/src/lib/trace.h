@@ -0,0 +1,44 @@
+#ifndef __LIB_TRACE_H
+#define __LIB_TRACE_H
+
+#include <stdint.h>
+
+/* System call tracing.  A traced process records each system
+   call it makes that returns, and keeps a latency histogram per
+   system call number.  See userprog/trace.c. */
+
+/* Argument words recorded per call. */
+#define TRACE_ARGS 4
+
+/* System call numbers that get a histogram: 0 through
+   TRACE_SYSCALLS - 1. */
+#define TRACE_SYSCALLS 64
+
+/* Number of buckets in a latency histogram.  Bucket 0 counts
+   calls under 1 us; bucket I, for 0 < I < TRACE_BUCKETS - 1,
+   counts those from 2**(I-1) up to 2**I us; the last bucket
+   counts everything longer. */
+#define TRACE_BUCKETS 16
+
+/* One system call, as returned by trace_read(). */
+struct trace_record
+  {
+    int64_t start_ns;                   /* When it began, as clock_ns(). */
+    uint32_t dur_ns;                    /* How long it took. */
+    int32_t tid;                        /* Calling thread. */
+    int32_t nr;                         /* System call number. */
+    int32_t ret;                        /* Return value. */
+    uint32_t args[TRACE_ARGS];          /* First argument words. */
+  };
+
+/* Aggregate statistics for one system call number, as returned
+   by trace_hist(). */
+struct trace_hist
+  {
+    uint32_t cnt;                       /* Calls made. */
+    uint32_t max_ns;                    /* Longest call. */
+    int64_t total_ns;                   /* Time in all calls. */
+    uint32_t latency[TRACE_BUCKETS];    /* Call durations. */
+  };
+
+#endif /* lib/trace.h */
@@ -0,0 +1,16 @@
+#ifndef __LIB_UIO_H
+#define __LIB_UIO_H
+
+#include <stddef.h>
+
+/* Maximum number of buffers in one readv or writev call. */
+#define IOV_MAX 32
+
+/* One buffer of a vectored read or write. */
+struct iovec
+  {
+    void *iov_base;                     /* Start of buffer. */
+    size_t iov_len;                     /* Buffer size in bytes. */
+  };
+
+#endif /* lib/uio.h */
@@ -0,0 +1,75 @@
+#include <mutex.h>
+#include <syscall.h>
+
+/* Mutex states. */
+#define FREE 0                  /* Not held. */
+#define HELD 1                  /* Held, nobody waiting. */
+#define CONTENDED 2             /* Held, maybe somebody waiting. */
+
+/* Atomically stores NEW in *P if it holds OLD.
+   Returns the previous value of *P. */
+static inline int
+cmpxchg (int *p, int old, int new)
+{
+  int prev;
+  asm volatile ("lock cmpxchgl %2, %1"
+                : "=a" (prev), "+m" (*p)
+                : "r" (new), "0" (old)
+                : "memory");
+  return prev;
+}
+
+/* Atomically stores NEW in *P and returns the previous value. */
+static inline int
+xchg (int *p, int new)
+{
+  asm volatile ("xchgl %0, %1"
+                : "+r" (new), "+m" (*p)
+                :
+                : "memory");
+  return new;
+}
+
+/* Initializes MUTEX as free. */
+void
+mutex_init (struct mutex *mutex)
+{
+  mutex->state = FREE;
+}
+
+/* Acquires MUTEX, sleeping in the kernel until it is released
+   if another thread holds it. */
+void
+mutex_lock (struct mutex *mutex)
+{
+  int state = cmpxchg (&mutex->state, FREE, HELD);
+  if (state == FREE)
+    return;
+
+  /* Announce that we are waiting, so that the holder knows to
+     wake somebody, then sleep until we get the mutex. */
+  if (state != CONTENDED)
+    state = xchg (&mutex->state, CONTENDED);
+  while (state != FREE)
+    {
+      futex_wait (&mutex->state, CONTENDED);
+      state = xchg (&mutex->state, CONTENDED);
+    }
+}
+
+/* Tries to acquire MUTEX without sleeping.
+   Returns true if successful. */
+bool
+mutex_trylock (struct mutex *mutex)
+{
+  return cmpxchg (&mutex->state, FREE, HELD) == FREE;
+}
+
+/* Releases MUTEX, which the caller must hold, waking one waiter
+   if there might be any. */
+void
+mutex_unlock (struct mutex *mutex)
+{
+  if (xchg (&mutex->state, FREE) == CONTENDED)
+    futex_wake (&mutex->state, 1);
+}
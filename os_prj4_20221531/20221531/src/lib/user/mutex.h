@@ -0,0 +1,22 @@
+#ifndef __LIB_USER_MUTEX_H
+#define __LIB_USER_MUTEX_H
+
+#include <stdbool.h>
+
+/* A mutex for the threads of one user process.  Locking and
+   unlocking an uncontended mutex is a single atomic instruction;
+   only contended operations enter the kernel, through
+   futex_wait() and futex_wake(). */
+struct mutex
+  {
+    int state;                  /* 0: free, 1: held, 2: held, waiters. */
+  };
+
+#define MUTEX_INITIALIZER { 0 }
+
+void mutex_init (struct mutex *);
+void mutex_lock (struct mutex *);
+bool mutex_trylock (struct mutex *);
+void mutex_unlock (struct mutex *);
+
+#endif /* lib/user/mutex.h */
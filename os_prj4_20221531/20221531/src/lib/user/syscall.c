@@ -1,16 +1,32 @@
 #include <syscall.h>
 #include "../syscall-nr.h"
 
+/* Nonzero if system calls should enter the kernel through
+   SYSENTER instead of `int $0x30'.  Set by sysenter_enable(). */
+static char use_sysenter;
+
+/* Assembly that enters the kernel for a system call whose number
+   and arguments have already been pushed.  SYSENTER saves no
+   return state of its own, so the kernel's SYSEXIT returns to
+   the address in %edx with the stack pointer in %ecx; both
+   registers are clobbered. */
+#define SYSCALL_ENTER                                           \
+        "cmpb $0, %[fast]; je 2f; "                             \
+        "movl %%esp, %%ecx; movl $1f, %%edx; sysenter; "        \
+        "2: int $0x30; 1: "
+
 /* Invokes syscall NUMBER, passing no arguments, and returns the
    return value as an `int'. */
 #define syscall0(NUMBER)                                        \
         ({                                                      \
           int retval;                                           \
           asm volatile                                          \
-            ("pushl %[number]; int $0x30; addl $4, %%esp"       \
+            ("pushl %[number]; " SYSCALL_ENTER                  \
+             "addl $4, %%esp"                                   \
                : "=a" (retval)                                  \
-               : [number] "i" (NUMBER)                          \
-               : "memory");                                     \
+               : [number] "i" (NUMBER),                         \
+                 [fast] "m" (use_sysenter)                      \
+               : "ecx", "edx", "memory");                       \
           retval;                                               \
         })
 
@@ -20,11 +36,13 @@
         ({                                                               \
           int retval;                                                    \
           asm volatile                                                   \
-            ("pushl %[arg0]; pushl %[number]; int $0x30; addl $8, %%esp" \
+            ("pushl %[arg0]; pushl %[number]; " SYSCALL_ENTER            \
+             "addl $8, %%esp"                                            \
                : "=a" (retval)                                           \
                : [number] "i" (NUMBER),                                  \
-                 [arg0] "g" (ARG0)                                       \
-               : "memory");                                              \
+                 [arg0] "g" (ARG0),                                      \
+                 [fast] "m" (use_sysenter)                               \
+               : "ecx", "edx", "memory");                                \
           retval;                                                        \
         })
 
@@ -35,12 +53,14 @@
           int retval;                                           \
           asm volatile                                          \
             ("pushl %[arg1]; pushl %[arg0]; "                   \
-             "pushl %[number]; int $0x30; addl $12, %%esp"      \
+             "pushl %[number]; " SYSCALL_ENTER                  \
+             "addl $12, %%esp"                                  \
                : "=a" (retval)                                  \
                : [number] "i" (NUMBER),                         \
                  [arg0] "r" (ARG0),                             \
-                 [arg1] "r" (ARG1)                              \
-               : "memory");                                     \
+                 [arg1] "r" (ARG1),                             \
+                 [fast] "m" (use_sysenter)                      \
+               : "ecx", "edx", "memory");                       \
           retval;                                               \
         })
 
@@ -51,13 +71,15 @@
           int retval;                                           \
           asm volatile                                          \
             ("pushl %[arg2]; pushl %[arg1]; pushl %[arg0]; "    \
-             "pushl %[number]; int $0x30; addl $16, %%esp"      \
+             "pushl %[number]; " SYSCALL_ENTER                  \
+             "addl $16, %%esp"                                  \
                : "=a" (retval)                                  \
                : [number] "i" (NUMBER),                         \
                  [arg0] "r" (ARG0),                             \
                  [arg1] "r" (ARG1),                             \
-                 [arg2] "r" (ARG2)                              \
-               : "memory");                                     \
+                 [arg2] "r" (ARG2),                             \
+                 [fast] "m" (use_sysenter)                      \
+               : "ecx", "edx", "memory");                       \
           retval;                                               \
         })
 
@@ -66,17 +88,47 @@
           int retval;                                           \
           asm volatile                                          \
             ("pushl %[arg3]; pushl %[arg2]; pushl %[arg1]; pushl %[arg0]; "    \
-             "pushl %[number]; int $0x30; addl $20, %%esp"      \
+             "pushl %[number]; " SYSCALL_ENTER                  \
+             "addl $20, %%esp"                                  \
                : "=a" (retval)                                  \
                : [number] "i" (NUMBER),                         \
                  [arg0] "r" (ARG0),                             \
                  [arg1] "r" (ARG1),                             \
                  [arg2] "r" (ARG2),                             \
-                 [arg3] "r" (ARG3)                              \
-               : "memory");                                     \
+                 [arg3] "r" (ARG3),                             \
+                 [fast] "m" (use_sysenter)                      \
+               : "ecx", "edx", "memory");                       \
           retval;                                               \
         })
 
+/* Returns true if the CPU supports SYSENTER and SYSEXIT.  The
+   kernel makes the same check before setting them up. */
+static bool
+cpu_has_sysenter (void)
+{
+  unsigned eax, ebx, ecx, edx;
+  unsigned family, model, stepping;
+
+  asm ("cpuid" : "=a" (eax), "=b" (ebx), "=c" (ecx), "=d" (edx) : "a" (1));
+  family = (eax >> 8) & 0xf;
+  model = (eax >> 4) & 0xf;
+  stepping = eax & 0xf;
+  if (family == 6 && model < 3 && stepping < 3)
+    return false;
+  return (edx & (1u << 11)) != 0;
+}
+
+/* Selects how system calls enter the kernel: through SYSENTER if
+   ENABLE is true and the CPU has it, otherwise through
+   `int $0x30'.  Returns true if SYSENTER is now in use.  _start()
+   enables it before calling main(). */
+bool
+sysenter_enable (bool enable)
+{
+  use_sysenter = enable && cpu_has_sysenter ();
+  return use_sysenter;
+}
+
 void
 halt (void) 
 {
@@ -199,6 +251,151 @@ inumber (int fd)
   return syscall1 (SYS_INUMBER, fd);
 }
 
+/* Where every thread started by uthread_create() begins: the
+   kernel enters here with FUNC and AUX on the new stack, as if
+   we had been called. */
+static void
+uthread_entry (uthread_func *func, void *aux)
+{
+  func (aux);
+  uthread_exit (0);
+}
+
+int
+uthread_create (uthread_func *func, void *aux)
+{
+  return syscall3 (SYS_THREAD_CREATE, uthread_entry, func, aux);
+}
+
+void
+uthread_exit (int status)
+{
+  syscall1 (SYS_THREAD_EXIT, status);
+  NOT_REACHED ();
+}
+
+int
+uthread_join (int tid)
+{
+  return syscall1 (SYS_THREAD_JOIN, tid);
+}
+
+int
+futex_wait (int *addr, int val)
+{
+  return syscall2 (SYS_FUTEX_WAIT, addr, val);
+}
+
+int
+futex_wake (int *addr, int cnt)
+{
+  return syscall2 (SYS_FUTEX_WAKE, addr, cnt);
+}
+
+bool
+lockstat (int idx, struct lockstat *stats, bool reset)
+{
+  return syscall3 (SYS_LOCKSTAT, idx, stats, (int) reset);
+}
+
+int64_t
+clock_ns (void)
+{
+  int64_t ns;
+  syscall1 (SYS_CLOCK_NS, &ns);
+  return ns;
+}
+
+bool
+sched_deadline (int runtime_ms, int deadline_ms, int period_ms)
+{
+  return syscall3 (SYS_SCHED_DEADLINE, runtime_ms, deadline_ms, period_ms);
+}
+
+bool
+schedstat (int tid, struct schedstat *stats)
+{
+  return syscall2 (SYS_SCHEDSTAT, tid, stats);
+}
+
+void
+null_syscall (void)
+{
+  syscall0 (SYS_NULL);
+}
+
+int
+pread (int fd, void *buffer, unsigned size, unsigned offset)
+{
+  return syscall4 (SYS_PREAD, fd, buffer, size, offset);
+}
+
+int
+pwrite (int fd, const void *buffer, unsigned size, unsigned offset)
+{
+  return syscall4 (SYS_PWRITE, fd, buffer, size, offset);
+}
+
+int
+readv (int fd, const struct iovec *iov, int iovcnt)
+{
+  return syscall3 (SYS_READV, fd, iov, iovcnt);
+}
+
+int
+writev (int fd, const struct iovec *iov, int iovcnt)
+{
+  return syscall3 (SYS_WRITEV, fd, iov, iovcnt);
+}
+
+int
+copy_file_range (int fd_in, int fd_out, unsigned size)
+{
+  return syscall3 (SYS_COPY_FILE_RANGE, fd_in, fd_out, size);
+}
+
+int
+ring_setup (struct ring *r)
+{
+  return syscall1 (SYS_RING_SETUP, r);
+}
+
+int
+ring_enter (unsigned to_submit)
+{
+  return syscall1 (SYS_RING_ENTER, to_submit);
+}
+
+bool
+trace (bool enable)
+{
+  return syscall1 (SYS_TRACE, enable);
+}
+
+int
+trace_read (struct trace_record *records, unsigned cnt)
+{
+  return syscall2 (SYS_TRACE_READ, records, cnt);
+}
+
+bool
+trace_hist (int nr, struct trace_hist *hist)
+{
+  return syscall2 (SYS_TRACE_HIST, nr, hist);
+}
+
+int
+pipe (int fds[2])
+{
+  return syscall1 (SYS_PIPE, fds);
+}
+
+mapid_t
+shm_open (const char *name, unsigned size, void *addr)
+{
+  return syscall3 (SYS_SHM_OPEN, name, size, addr);
+}
+
 int fibonacci(int n) {
   return syscall1(SYS_FIBONACCI, n);
 }
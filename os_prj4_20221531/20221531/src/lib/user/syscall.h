@@ -2,7 +2,13 @@
 #define __LIB_USER_SYSCALL_H
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <debug.h>
+#include <lockstat.h>
+#include <schedstat.h>
+#include <ring.h>
+#include <trace.h>
+#include <uio.h>
 
 /* Process identifier. */
 typedef int pid_t;
@@ -45,4 +51,49 @@ bool readdir (int fd, char name[READDIR_MAX_LEN + 1]);
 bool isdir (int fd);
 int inumber (int fd);
 
+/* Multithreaded processes. */
+typedef void uthread_func (void *aux);
+
+int uthread_create (uthread_func *, void *aux);
+void uthread_exit (int status) NO_RETURN;
+int uthread_join (int tid);
+int futex_wait (int *addr, int val);
+int futex_wake (int *addr, int cnt);
+
+/* Kernel statistics. */
+bool lockstat (int idx, struct lockstat *, bool reset);
+
+/* Clocks. */
+int64_t clock_ns (void);
+
+/* Scheduling. */
+bool sched_deadline (int runtime_ms, int deadline_ms, int period_ms);
+bool schedstat (int tid, struct schedstat *);
+
+/* System call entry. */
+bool sysenter_enable (bool enable);
+void null_syscall (void);
+
+/* Positioned and vectored I/O. */
+int pread (int fd, void *buffer, unsigned length, unsigned offset);
+int pwrite (int fd, const void *buffer, unsigned length, unsigned offset);
+int readv (int fd, const struct iovec *, int iovcnt);
+int writev (int fd, const struct iovec *, int iovcnt);
+int copy_file_range (int fd_in, int fd_out, unsigned length);
+
+/* Batched system calls. */
+int ring_setup (struct ring *);
+int ring_enter (unsigned to_submit);
+
+/* System call tracing. */
+bool trace (bool enable);
+int trace_read (struct trace_record *, unsigned cnt);
+bool trace_hist (int nr, struct trace_hist *);
+
+/* Pipes. */
+int pipe (int fds[2]);
+
+/* Shared memory. */
+mapid_t shm_open (const char *name, unsigned size, void *addr);
+
 #endif /* lib/user/syscall.h */
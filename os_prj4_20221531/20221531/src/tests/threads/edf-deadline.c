@@ -0,0 +1,203 @@
+/* Checks that the real-time (EDF) scheduling class meets the
+   deadlines of periodic threads despite CPU hogs at the highest
+   priority, holds a thread that runs past its budget to that
+   budget, and rejects reservations that would overcommit the
+   CPU.
+
+   Two periodic threads each do about a millisecond of work at
+   the start of every period and check that it is finished by
+   the deadline.  With 3 hogs at PRI_MAX and 4-tick round-robin
+   slices, an ordinary thread can wait 12 ticks or more to run;
+   a real-time thread should run as soon as its period starts.
+   A third real-time thread never stops running; throttling
+   should limit it to about 1 tick in each 10-tick period and
+   leave the rest of the CPU for the hogs. */
+
+#include <stdio.h>
+#include <inttypes.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define HOG_CNT 3
+#define JOB_CNT 20
+
+static void hog_thread (void *);
+static void periodic_thread (void *);
+static void overrun_thread (void *);
+
+/* A real-time thread's reservation and results. */
+struct rt_info
+  {
+    int64_t runtime, deadline, period;  /* Reservation, in ticks. */
+    struct semaphore admitted;          /* Upped once reserved. */
+    struct semaphore finished;          /* Upped when done. */
+    bool ok;                            /* Reservation succeeded? */
+    int misses;                         /* Jobs finished late. */
+    int64_t late;                       /* Worst lateness, in ticks. */
+    int64_t ticks_run;                  /* Distinct ticks seen running. */
+  };
+
+/* Set to true to stop the hogs and the overrunning thread. */
+static volatile bool done;
+
+/* Incremented by the hogs. */
+static volatile unsigned hog_loops;
+
+static void
+start_rt (struct rt_info *info, const char *name, thread_func *func,
+          int64_t runtime, int64_t deadline, int64_t period)
+{
+  info->runtime = runtime;
+  info->deadline = deadline;
+  info->period = period;
+  sema_init (&info->admitted, 0);
+  sema_init (&info->finished, 0);
+  info->ok = false;
+  info->misses = 0;
+  info->late = 0;
+  info->ticks_run = 0;
+  thread_create (name, PRI_DEFAULT, func, info);
+  sema_down (&info->admitted);
+  if (!info->ok)
+    fail ("%s: reservation (%"PRId64", %"PRId64", %"PRId64") refused",
+          name, runtime, deadline, period);
+}
+
+void
+test_edf_deadline (void)
+{
+  struct rt_info a, b, overrun;
+  int64_t start, window;
+  int i;
+
+  ASSERT (!thread_mlfqs);
+
+  /* Invalid reservations. */
+  if (thread_set_deadline (-1, 10, 10)
+      || thread_set_deadline (5, 4, 10)
+      || thread_set_deadline (5, 10, 8)
+      || thread_set_deadline (10, 10, 10))
+    fail ("invalid or excessive reservation accepted");
+
+  done = false;
+  hog_loops = 0;
+  start_rt (&a, "rt a", periodic_thread, 2, 5, 5);
+  start_rt (&b, "rt b", periodic_thread, 3, 10, 10);
+  start_rt (&overrun, "rt overrun", overrun_thread, 1, 10, 10);
+
+  /* 2/5 + 3/10 + 1/10 = 0.8 of the CPU is reserved now. */
+  if (thread_set_deadline (3, 10, 10))
+    fail ("reservation beyond the CPU's capacity accepted");
+  msg ("Admission control rejected invalid and excess reservations.");
+
+  msg ("Running 2 periodic threads and 1 overrunning thread "
+       "against %d CPU hogs...", HOG_CNT);
+  start = timer_ticks ();
+  thread_set_priority (PRI_MAX);
+  for (i = 0; i < HOG_CNT; i++)
+    {
+      char name[16];
+      snprintf (name, sizeof name, "hog %d", i);
+      thread_create (name, PRI_MAX, hog_thread, NULL);
+    }
+  sema_down (&a.finished);
+  sema_down (&b.finished);
+  done = true;
+  sema_down (&overrun.finished);
+  window = timer_elapsed (start);
+  thread_set_priority (PRI_DEFAULT);
+
+  if (a.misses > 0 || b.misses > 0)
+    fail ("%d jobs missed their deadlines, by up to %"PRId64" ticks",
+          a.misses + b.misses, a.late > b.late ? a.late : b.late);
+  msg ("All %d jobs met their deadlines.", 2 * JOB_CNT);
+
+  if (overrun.ticks_run > 2 * (window / overrun.period + 1))
+    fail ("overrunning thread ran in %"PRId64" of %"PRId64" ticks",
+          overrun.ticks_run, window);
+  msg ("Overrunning thread was held to its budget.");
+
+  if (hog_loops == 0)
+    fail ("CPU hogs never ran");
+  msg ("CPU hogs still ran.");
+
+  /* Let the hogs notice DONE and exit. */
+  timer_sleep (TIMER_FREQ / 10);
+}
+
+static void
+hog_thread (void *aux UNUSED)
+{
+  while (!done)
+    hog_loops++;
+}
+
+/* Reserves the CPU as described by INFO_, then runs JOB_CNT jobs,
+   one at the start of each period, checking each against its
+   deadline. */
+static void
+periodic_thread (void *info_)
+{
+  struct rt_info *info = info_;
+  int64_t release;
+  int i;
+
+  info->ok = thread_set_deadline (info->runtime, info->deadline,
+                                  info->period);
+  sema_up (&info->admitted);
+  if (!info->ok)
+    return;
+
+  /* Give the main thread time to start the hogs. */
+  timer_sleep (2);
+  release = timer_ticks ();
+  for (i = 0; i < JOB_CNT; i++)
+    {
+      int64_t now, late;
+
+      release += info->period;
+      now = timer_ticks ();
+      if (release > now)
+        timer_sleep (release - now);
+
+      timer_udelay (1000);
+
+      late = timer_ticks () - (release + info->deadline);
+      if (late > 0)
+        {
+          info->misses++;
+          if (late > info->late)
+            info->late = late;
+        }
+    }
+  sema_up (&info->finished);
+}
+
+/* Reserves the CPU as described by INFO_, then spins until DONE,
+   counting the distinct ticks in which it ran. */
+static void
+overrun_thread (void *info_)
+{
+  struct rt_info *info = info_;
+  int64_t last = -1;
+
+  info->ok = thread_set_deadline (info->runtime, info->deadline,
+                                  info->period);
+  sema_up (&info->admitted);
+  if (!info->ok)
+    return;
+
+  while (!done)
+    {
+      int64_t now = timer_ticks ();
+      if (now != last)
+        {
+          info->ticks_run++;
+          last = now;
+        }
+    }
+  sema_up (&info->finished);
+}
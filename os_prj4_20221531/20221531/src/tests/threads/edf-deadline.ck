@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(edf-deadline) begin
+(edf-deadline) Admission control rejected invalid and excess reservations.
+(edf-deadline) Running 2 periodic threads and 1 overrunning thread against 3 CPU hogs...
+(edf-deadline) All 40 jobs met their deadlines.
+(edf-deadline) Overrunning thread was held to its budget.
+(edf-deadline) CPU hogs still ran.
+(edf-deadline) end
+EOF
+pass;
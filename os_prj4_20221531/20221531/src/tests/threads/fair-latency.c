@@ -0,0 +1,96 @@
+/* Checks that the fair-share scheduler (-fair) runs a thread
+   that wakes up from a short sleep promptly, even while several
+   CPU-bound threads are competing for the CPU.
+
+   A thread repeatedly sleeps for 1 tick and measures how late
+   it got back onto the CPU.  With 4 CPU-bound threads, a
+   round-robin scheduler with 4-tick slices can make it wait up
+   to 16 ticks.  The fair-share scheduler credits sleepers with
+   half a target latency of vruntime and lets them preempt the
+   running thread when they wake, so it should never be more
+   than 1 tick late. */
+
+#include <stdio.h>
+#include <inttypes.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define HOG_CNT 4
+#define WAKEUP_CNT 100
+#define MAX_LATENCY 1
+
+static void hog_thread (void *);
+static void sleeper_thread (void *);
+
+/* Set to true to stop the CPU hogs. */
+static volatile bool done;
+
+struct sleeper_info
+  {
+    struct semaphore finished;  /* Upped when the sleeper is done. */
+    int64_t max_latency;        /* Worst lateness seen, in ticks. */
+  };
+
+void
+test_fair_latency (void)
+{
+  struct sleeper_info info;
+  int i;
+
+  ASSERT (thread_fair);
+
+  done = false;
+  for (i = 0; i < HOG_CNT; i++)
+    {
+      char name[16];
+      snprintf (name, sizeof name, "hog %d", i);
+      thread_create (name, PRI_DEFAULT, hog_thread, NULL);
+    }
+
+  msg ("Measuring %d wakeups against %d CPU hogs...", WAKEUP_CNT, HOG_CNT);
+  sema_init (&info.finished, 0);
+  info.max_latency = 0;
+  thread_create ("sleeper", PRI_DEFAULT, sleeper_thread, &info);
+  sema_down (&info.finished);
+  done = true;
+
+  if (info.max_latency > MAX_LATENCY)
+    fail ("sleeper ran up to %"PRId64" ticks late, expected at most %d",
+          info.max_latency, MAX_LATENCY);
+  msg ("Sleeper was never more than %d tick late.", MAX_LATENCY);
+
+  /* Let the hogs notice DONE and exit. */
+  timer_sleep (TIMER_FREQ / 10);
+}
+
+static void
+hog_thread (void *aux UNUSED)
+{
+  while (!done)
+    continue;
+}
+
+static void
+sleeper_thread (void *info_)
+{
+  struct sleeper_info *info = info_;
+  int i;
+
+  /* Let the hogs build up some vruntime first. */
+  timer_sleep (TIMER_FREQ / 2);
+
+  for (i = 0; i < WAKEUP_CNT; i++)
+    {
+      int64_t start = timer_ticks ();
+      int64_t latency;
+
+      timer_sleep (1);
+      latency = timer_elapsed (start) - 1;
+      if (latency > info->max_latency)
+        info->max_latency = latency;
+    }
+  sema_up (&info->finished);
+}
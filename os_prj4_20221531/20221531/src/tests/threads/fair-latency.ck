@@ -0,0 +1,11 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(fair-latency) begin
+(fair-latency) Measuring 100 wakeups against 4 CPU hogs...
+(fair-latency) Sleeper was never more than 1 tick late.
+(fair-latency) end
+EOF
+pass;
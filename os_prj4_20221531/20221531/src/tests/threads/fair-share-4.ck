@@ -0,0 +1,7 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+use tests::threads::fair;
+
+check_fair_share ([0, 0, 0, 0], 50);
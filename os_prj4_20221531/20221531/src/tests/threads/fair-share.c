@@ -0,0 +1,103 @@
+/* Checks that the fair-share scheduler (-fair) divides the CPU
+   among CPU-bound threads in proportion to their weights.
+
+   The fair-share-4 test runs 4 threads all niced to 0, which
+   should receive 500 ticks each over 20 seconds.
+
+   The fair-nice-3 test runs 3 threads with nice 0, 5 and 10,
+   whose weights are 1024, 335 and 110.  Over 20 seconds they
+   should receive 1,394, 456 and 150 ticks, respectively.
+
+   (The expected values are computed in fair.pm.) */
+
+#include <stdio.h>
+#include <inttypes.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+static void test_fair_share (int thread_cnt, int nice_min, int nice_step);
+
+void
+test_fair_share_4 (void)
+{
+  test_fair_share (4, 0, 0);
+}
+
+void
+test_fair_nice_3 (void)
+{
+  test_fair_share (3, 0, 5);
+}
+
+#define MAX_THREAD_CNT 20
+
+struct thread_info
+  {
+    int64_t start_time;
+    int tick_count;
+    int nice;
+  };
+
+static void load_thread (void *aux);
+
+static void
+test_fair_share (int thread_cnt, int nice_min, int nice_step)
+{
+  struct thread_info info[MAX_THREAD_CNT];
+  int64_t start_time;
+  int nice;
+  int i;
+
+  ASSERT (thread_fair);
+  ASSERT (thread_cnt <= MAX_THREAD_CNT);
+  ASSERT (nice_min + nice_step * (thread_cnt - 1) <= NICE_MAX);
+
+  thread_set_nice (NICE_MIN);
+
+  start_time = timer_ticks ();
+  msg ("Starting %d threads...", thread_cnt);
+  nice = nice_min;
+  for (i = 0; i < thread_cnt; i++)
+    {
+      struct thread_info *ti = &info[i];
+      char name[16];
+
+      ti->start_time = start_time;
+      ti->tick_count = 0;
+      ti->nice = nice;
+
+      snprintf (name, sizeof name, "load %d", i);
+      thread_create (name, PRI_DEFAULT, load_thread, ti);
+
+      nice += nice_step;
+    }
+  msg ("Starting threads took %"PRId64" ticks.", timer_elapsed (start_time));
+
+  msg ("Sleeping 25 seconds to let threads run, please wait...");
+  timer_sleep (25 * TIMER_FREQ);
+
+  for (i = 0; i < thread_cnt; i++)
+    msg ("Thread %d received %d ticks.", i, info[i].tick_count);
+}
+
+static void
+load_thread (void *ti_)
+{
+  struct thread_info *ti = ti_;
+  int64_t sleep_time = 2 * TIMER_FREQ;
+  int64_t spin_time = sleep_time + 20 * TIMER_FREQ;
+  int64_t last_time = 0;
+
+  thread_set_nice (ti->nice);
+  timer_sleep (sleep_time - timer_elapsed (ti->start_time));
+  while (timer_elapsed (ti->start_time) < spin_time)
+    {
+      int64_t cur_time = timer_ticks ();
+      if (cur_time != last_time)
+        ti->tick_count++;
+      last_time = cur_time;
+    }
+}
@@ -0,0 +1,55 @@
+/* Checks the latency histogram helpers, and, in kernels built
+   with -DINTRTRACE, that the interrupts-off tracer records a
+   section of known length.  Its report is printed at shutdown. */
+
+#include <stdio.h>
+#include <histogram.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/interrupt.h"
+#include "devices/timer.h"
+
+/* Length of the interrupts-off section, in ns. */
+#define SECTION_NS (2 * 1000 * 1000)
+
+void
+test_intr_trace (void)
+{
+  static const struct
+    {
+      uint64_t ns;
+      int bucket;
+    }
+  cases[] =
+    {
+      {0, 0}, {999, 0}, {1000, 1}, {1999, 1}, {2000, 2},
+      {1023999, 10}, {1024000, 11}, {UINT64_MAX, 15},
+    };
+  size_t i;
+
+  for (i = 0; i < sizeof cases / sizeof *cases; i++)
+    if (histogram_bucket (cases[i].ns, 16) != cases[i].bucket)
+      fail ("%llu ns went in bucket %d, not %d", cases[i].ns,
+            histogram_bucket (cases[i].ns, 16), cases[i].bucket);
+  msg ("Histogram buckets are powers of 2 microseconds.");
+
+#ifdef INTRTRACE
+  {
+    enum intr_level old_level;
+    uint64_t start;
+
+    old_level = intr_disable ();
+    start = timer_cycles ();
+    while (timer_cycles_to_ns (timer_cycles () - start) < SECTION_NS)
+      continue;
+    intr_set_level (old_level);
+
+    if (intr_trace_max_ns () < SECTION_NS)
+      fail ("longest interrupts-off section was %llu ns, "
+            "expected at least %d", intr_trace_max_ns (), SECTION_NS);
+    msg ("Interrupts-off section was traced.");
+  }
+#else
+  msg ("Interrupts-off tracing is not built in.");
+#endif
+}
@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF', <<'EOF']);
+(intr-trace) begin
+(intr-trace) Histogram buckets are powers of 2 microseconds.
+(intr-trace) Interrupts-off section was traced.
+(intr-trace) end
+EOF
+(intr-trace) begin
+(intr-trace) Histogram buckets are powers of 2 microseconds.
+(intr-trace) Interrupts-off tracing is not built in.
+(intr-trace) end
+EOF
+pass;
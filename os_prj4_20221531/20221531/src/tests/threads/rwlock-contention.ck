@@ -0,0 +1,23 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+our ($test);
+my (@output) = read_text_file ("$test.output");
+common_checks ("run", @output);
+@output = get_core_output ("run", @output);
+
+my (%ticks);
+foreach (@output) {
+    $ticks{$1} = $2 if /^\(rwlock-contention\) (lock|adaptive lock|rwlock): (\d+) ticks\.$/;
+}
+foreach my $kind ('lock', 'adaptive lock', 'rwlock') {
+    fail "Missing time for $kind.\n" if !defined $ticks{$kind};
+}
+
+# Readers should overlap, so the rwlock run should take about
+# HOLD_TICKS while the others take about THREAD_CNT times that.
+fail "rwlock took $ticks{rwlock} ticks, not much less than "
+  . "$ticks{lock} for lock.\n"
+  if $ticks{rwlock} * 2 > $ticks{lock};
+pass;
@@ -0,0 +1,20 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(rwlock-priority) begin
+(rwlock-priority) Main thread holds read lock.
+(rwlock-priority) Writer is waiting.
+(rwlock-priority) Low reader is waiting behind writer.
+(rwlock-priority) high reader acquired read lock.
+(rwlock-priority) high reader done.
+(rwlock-priority) High reader went ahead of writer.
+(rwlock-priority) Main thread released read lock.
+(rwlock-priority) writer acquired write lock.
+(rwlock-priority) writer done.
+(rwlock-priority) low reader acquired read lock.
+(rwlock-priority) low reader done.
+(rwlock-priority) end
+EOF
+pass;
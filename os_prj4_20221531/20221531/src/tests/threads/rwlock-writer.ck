@@ -0,0 +1,17 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(rwlock-writer) begin
+(rwlock-writer) Main thread holds read lock.
+(rwlock-writer) Writer is waiting.
+(rwlock-writer) Reader is waiting behind writer.
+(rwlock-writer) Main thread released read lock.
+(rwlock-writer) writer acquired write lock.
+(rwlock-writer) writer done.
+(rwlock-writer) reader acquired read lock.
+(rwlock-writer) reader done.
+(rwlock-writer) end
+EOF
+pass;
@@ -0,0 +1,161 @@
+/* Tests for readers-writer locks.
+
+   rwlock-writer checks writer preference: once a writer is
+   waiting, a reader of the same priority that arrives later
+   waits behind it.
+
+   rwlock-priority checks that a reader of higher priority than
+   every waiting writer is not held back by them, and that
+   waiters are woken in priority order.
+
+   rwlock-contention is a small benchmark.  Several threads each
+   hold a lock for a while, sleeping as they would for disk I/O,
+   first with a plain lock, then an adaptive lock, then as
+   readers of a readers-writer lock.  The first two serialize
+   the threads; the last should let them overlap. */
+
+#include <stdio.h>
+#include <inttypes.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+static struct rwlock rwlock;
+
+static void
+reader_thread (void *aux UNUSED)
+{
+  rwlock_acquire_read (&rwlock);
+  msg ("%s acquired read lock.", thread_name ());
+  rwlock_release_read (&rwlock);
+  msg ("%s done.", thread_name ());
+}
+
+static void
+writer_thread (void *aux UNUSED)
+{
+  rwlock_acquire_write (&rwlock);
+  msg ("%s acquired write lock.", thread_name ());
+  rwlock_release_write (&rwlock);
+  msg ("%s done.", thread_name ());
+}
+
+void
+test_rwlock_writer (void)
+{
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  rwlock_init (&rwlock);
+  rwlock_acquire_read (&rwlock);
+  msg ("Main thread holds read lock.");
+
+  thread_create ("writer", PRI_DEFAULT + 1, writer_thread, NULL);
+  msg ("Writer is waiting.");
+  thread_create ("reader", PRI_DEFAULT + 1, reader_thread, NULL);
+  msg ("Reader is waiting behind writer.");
+
+  rwlock_release_read (&rwlock);
+  msg ("Main thread released read lock.");
+  thread_set_priority (PRI_MIN);
+}
+
+void
+test_rwlock_priority (void)
+{
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  rwlock_init (&rwlock);
+  rwlock_acquire_read (&rwlock);
+  msg ("Main thread holds read lock.");
+
+  thread_create ("writer", PRI_DEFAULT + 2, writer_thread, NULL);
+  msg ("Writer is waiting.");
+  thread_create ("low reader", PRI_DEFAULT + 1, reader_thread, NULL);
+  msg ("Low reader is waiting behind writer.");
+  thread_create ("high reader", PRI_DEFAULT + 3, reader_thread, NULL);
+  msg ("High reader went ahead of writer.");
+
+  rwlock_release_read (&rwlock);
+  msg ("Main thread released read lock.");
+  thread_set_priority (PRI_MIN);
+}
+
+#define THREAD_CNT 4
+#define HOLD_TICKS 10
+
+/* The kind of lock contended for in one benchmark run. */
+enum bench_kind
+  {
+    BENCH_LOCK,
+    BENCH_ADAPTIVE,
+    BENCH_RWLOCK
+  };
+
+static enum bench_kind bench_kind;
+static struct lock bench_lock;
+static struct adaptive_lock bench_alock;
+static struct semaphore bench_done;
+
+static void
+bench_thread (void *aux UNUSED)
+{
+  switch (bench_kind)
+    {
+    case BENCH_LOCK:
+      lock_acquire (&bench_lock);
+      timer_sleep (HOLD_TICKS);
+      lock_release (&bench_lock);
+      break;
+    case BENCH_ADAPTIVE:
+      adaptive_lock_acquire (&bench_alock);
+      timer_sleep (HOLD_TICKS);
+      adaptive_lock_release (&bench_alock);
+      break;
+    case BENCH_RWLOCK:
+      rwlock_acquire_read (&rwlock);
+      timer_sleep (HOLD_TICKS);
+      rwlock_release_read (&rwlock);
+      break;
+    }
+  sema_up (&bench_done);
+}
+
+/* Runs THREAD_CNT threads contending for a lock of the given
+   KIND and returns the number of ticks until all are done. */
+static int64_t
+bench_run (enum bench_kind kind)
+{
+  int64_t start;
+  int i;
+
+  bench_kind = kind;
+  sema_init (&bench_done, 0);
+  start = timer_ticks ();
+  for (i = 0; i < THREAD_CNT; i++)
+    {
+      char name[16];
+      snprintf (name, sizeof name, "bench %d", i);
+      thread_create (name, PRI_DEFAULT, bench_thread, NULL);
+    }
+  for (i = 0; i < THREAD_CNT; i++)
+    sema_down (&bench_done);
+  return timer_elapsed (start);
+}
+
+void
+test_rwlock_contention (void)
+{
+  lock_init (&bench_lock);
+  adaptive_lock_init (&bench_alock);
+  rwlock_init (&rwlock);
+
+  msg ("%d threads each holding the lock for %d ticks.",
+       THREAD_CNT, HOLD_TICKS);
+  msg ("lock: %"PRId64" ticks.", bench_run (BENCH_LOCK));
+  msg ("adaptive lock: %"PRId64" ticks.", bench_run (BENCH_ADAPTIVE));
+  msg ("rwlock: %"PRId64" ticks.", bench_run (BENCH_RWLOCK));
+}
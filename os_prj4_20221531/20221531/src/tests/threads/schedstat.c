@@ -0,0 +1,106 @@
+/* Checks the scheduler statistics kept for each thread and for
+   the whole system.
+
+   A thread is woken 10 times by sema_up() and 5 times by the
+   timer interrupt.  Each wakeup must be counted, with its
+   latency, in that thread's statistics and the system's, and
+   each time it blocked must count as a voluntary switch. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define SEMA_WAKEUPS 10
+#define TIMER_WAKEUPS 5
+
+struct ping_pong
+  {
+    struct semaphore ping, pong;
+  };
+
+static void sleeper_thread (void *);
+
+static unsigned
+histogram_sum (const struct schedstat *s)
+{
+  unsigned sum = 0;
+  int i;
+
+  for (i = 0; i < SCHEDSTAT_BUCKETS; i++)
+    sum += s->latency[i];
+  return sum;
+}
+
+void
+test_schedstat (void)
+{
+  struct ping_pong pp;
+  struct schedstat before, thread, after;
+  tid_t tid;
+  int i;
+
+  sema_init (&pp.ping, 0);
+  sema_init (&pp.pong, 0);
+  if (!thread_get_schedstat (0, &before))
+    fail ("no system statistics");
+
+  tid = thread_create ("sleeper", PRI_DEFAULT, sleeper_thread, &pp);
+  for (i = 0; i < SEMA_WAKEUPS; i++)
+    {
+      sema_up (&pp.ping);
+      sema_down (&pp.pong);
+    }
+
+  /* The sleeper now waits for one last ping. */
+  if (!thread_get_schedstat (tid, &thread))
+    fail ("no statistics for the sleeper");
+  if (!thread_get_schedstat (0, &after))
+    fail ("no system statistics");
+  sema_up (&pp.ping);
+
+  if (thread.wakeups < SEMA_WAKEUPS + TIMER_WAKEUPS)
+    fail ("sleeper was woken %u times, expected at least %d",
+          thread.wakeups, SEMA_WAKEUPS + TIMER_WAKEUPS);
+  if (thread.voluntary < SEMA_WAKEUPS + TIMER_WAKEUPS)
+    fail ("sleeper blocked %u times, expected at least %d",
+          thread.voluntary, SEMA_WAKEUPS + TIMER_WAKEUPS);
+  if (histogram_sum (&thread) != thread.wakeups)
+    fail ("sleeper's latency histogram holds %u wakeups, not %u",
+          histogram_sum (&thread), thread.wakeups);
+  if (thread.run_ns <= 0)
+    fail ("sleeper never ran");
+  msg ("Sleeper's wakeups and switches were counted.");
+
+  if (after.wakeups - before.wakeups < thread.wakeups)
+    fail ("system counted %u wakeups, fewer than the sleeper's %u",
+          after.wakeups - before.wakeups, thread.wakeups);
+  if (histogram_sum (&after) != after.wakeups)
+    fail ("system latency histogram holds %u wakeups, not %u",
+          histogram_sum (&after), after.wakeups);
+  if (after.latency_max_ns < thread.latency_max_ns)
+    fail ("system's longest latency is less than the sleeper's");
+  msg ("System statistics include the sleeper's.");
+
+  if (thread_get_schedstat (TID_ERROR, &thread))
+    fail ("got statistics for a nonexistent thread");
+  msg ("No statistics for a nonexistent thread.");
+}
+
+static void
+sleeper_thread (void *pp_)
+{
+  struct ping_pong *pp = pp_;
+  int i;
+
+  for (i = 0; i < TIMER_WAKEUPS; i++)
+    timer_sleep (1);
+  for (i = 0; i < SEMA_WAKEUPS; i++)
+    {
+      sema_down (&pp->ping);
+      sema_up (&pp->pong);
+    }
+  sema_down (&pp->ping);
+}
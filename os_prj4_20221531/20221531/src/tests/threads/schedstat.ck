@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(schedstat) begin
+(schedstat) Sleeper's wakeups and switches were counted.
+(schedstat) System statistics include the sleeper's.
+(schedstat) No statistics for a nonexistent thread.
+(schedstat) end
+EOF
+pass;
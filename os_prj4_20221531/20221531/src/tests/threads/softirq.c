@@ -0,0 +1,65 @@
+/* Checks softirq deferral.  A softirq raised from a thread runs
+   on the return path of the next interrupt.  One that keeps
+   raising itself is run there for only a few rounds and then
+   handed to the ksoftirqd thread, which runs it the rest of the
+   times it is raised.  Then checks that timer sleepers, which the
+   timer softirq wakes, still sleep as long as they asked. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/interrupt.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+/* Number of times the test softirq raises itself in all. */
+#define RUN_CNT 16
+
+static int run_cnt;             /* Times the handler has run. */
+static int ksoftirqd_cnt;       /* Times it ran in ksoftirqd. */
+static bool first_in_ksoftirqd; /* Did its first run? */
+static struct semaphore done;   /* Upped after the last run. */
+
+static void
+test_softirq_handler (void)
+{
+  bool in_ksoftirqd = softirq_is_ksoftirqd (thread_current ());
+
+  ASSERT (intr_context ());
+  if (run_cnt == 0)
+    first_in_ksoftirqd = in_ksoftirqd;
+  if (in_ksoftirqd)
+    ksoftirqd_cnt++;
+  if (++run_cnt < RUN_CNT)
+    softirq_raise (SOFTIRQ_TEST);
+  else
+    sema_up (&done);
+}
+
+void
+test_softirq (void)
+{
+  int64_t start;
+
+  sema_init (&done, 0);
+  softirq_register (SOFTIRQ_TEST, test_softirq_handler);
+
+  softirq_raise (SOFTIRQ_TEST);
+  sema_down (&done);
+  if (run_cnt != RUN_CNT)
+    fail ("softirq ran %d times, not %d", run_cnt, RUN_CNT);
+  if (first_in_ksoftirqd)
+    fail ("softirq first ran in ksoftirqd");
+  msg ("Softirq first ran on an interrupt's return path.");
+  if (ksoftirqd_cnt == 0 || ksoftirqd_cnt == RUN_CNT)
+    fail ("ksoftirqd ran the softirq %d of %d times",
+          ksoftirqd_cnt, RUN_CNT);
+  msg ("Softirq that kept raising itself was handed to ksoftirqd.");
+
+  start = timer_ticks ();
+  timer_sleep (10);
+  if (timer_elapsed (start) < 10)
+    fail ("woke up after only %lld ticks", timer_elapsed (start));
+  msg ("Timer sleeper slept long enough.");
+}
@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(softirq) begin
+(softirq) Softirq first ran on an interrupt's return path.
+(softirq) Softirq that kept raising itself was handed to ksoftirqd.
+(softirq) Timer sleeper slept long enough.
+(softirq) end
+EOF
+pass;
@@ -41,6 +41,18 @@ static const struct test tests[] =
     {"mlfqs-nice-2", test_mlfqs_nice_2},
     {"mlfqs-nice-10", test_mlfqs_nice_10},
     {"mlfqs-block", test_mlfqs_block},
+    {"fair-share-4", test_fair_share_4},
+    {"fair-nice-3", test_fair_nice_3},
+    {"fair-latency", test_fair_latency},
+    {"rwlock-writer", test_rwlock_writer},
+    {"rwlock-priority", test_rwlock_priority},
+    {"rwlock-contention", test_rwlock_contention},
+    {"edf-deadline", test_edf_deadline},
+    {"schedstat", test_schedstat},
+    {"workqueue", test_workqueue},
+    {"softirq", test_softirq},
+    {"wait-queue", test_wait_queue},
+    {"intr-trace", test_intr_trace},
   };
 
 static const char *test_name;
@@ -35,6 +35,18 @@ extern test_func test_mlfqs_fair_20;
 extern test_func test_mlfqs_nice_2;
 extern test_func test_mlfqs_nice_10;
 extern test_func test_mlfqs_block;
+extern test_func test_fair_share_4;
+extern test_func test_fair_nice_3;
+extern test_func test_fair_latency;
+extern test_func test_rwlock_writer;
+extern test_func test_rwlock_priority;
+extern test_func test_rwlock_contention;
+extern test_func test_edf_deadline;
+extern test_func test_schedstat;
+extern test_func test_workqueue;
+extern test_func test_softirq;
+extern test_func test_wait_queue;
+extern test_func test_intr_trace;
 
 void msg (const char *, ...);
 void fail (const char *, ...);
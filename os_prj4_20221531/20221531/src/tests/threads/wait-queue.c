@@ -0,0 +1,153 @@
+/* Checks the order in which the priority wait queue wakes
+   threads waiting on a semaphore, a condition variable, and a
+   lock: highest priority first, and first come first served
+   among equal priorities.  Then checks that waiters whose
+   priority changes while they are blocked, as aging and the
+   MLFQS do, are repositioned by wait_queue_reprioritize().
+
+   The main thread runs at PRI_MIN and yields after each wakeup,
+   so each waiter reports in as soon as it is woken. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/interrupt.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+#define WAITER_CNT 6
+
+/* Waiter I runs at priority waiter_pri[I]. */
+static const int waiter_pri[WAITER_CNT] =
+  {
+    PRI_DEFAULT - 3, PRI_DEFAULT - 1, PRI_DEFAULT - 3,
+    PRI_DEFAULT - 2, PRI_DEFAULT - 1, PRI_DEFAULT - 3,
+  };
+
+/* What the waiters wait on. */
+enum wait_kind
+  {
+    WAIT_SEMA,
+    WAIT_COND,
+    WAIT_LOCK
+  };
+
+static const char *kind_names[] = {"sema", "cond", "lock"};
+
+static enum wait_kind kind;
+static struct semaphore sema;
+static struct lock lock;
+static struct condition cond;
+static struct thread *waiters[WAITER_CNT];
+
+static void
+waiter_thread (void *aux)
+{
+  int i = (int) aux;
+
+  waiters[i] = thread_current ();
+  switch (kind)
+    {
+    case WAIT_SEMA:
+      sema_down (&sema);
+      break;
+    case WAIT_COND:
+      lock_acquire (&lock);
+      cond_wait (&cond, &lock);
+      lock_release (&lock);
+      break;
+    case WAIT_LOCK:
+      lock_acquire (&lock);
+      break;
+    }
+  msg ("%s: waiter %d, priority %d, woke up.",
+       kind_names[kind], i, thread_get_priority ());
+  if (kind == WAIT_LOCK)
+    lock_release (&lock);
+}
+
+/* Starts the waiters, one at a time, so that each is blocked
+   before the next one arrives. */
+static void
+start_waiters (enum wait_kind k)
+{
+  int i;
+
+  kind = k;
+  for (i = 0; i < WAITER_CNT; i++)
+    {
+      char name[16];
+      snprintf (name, sizeof name, "waiter %d", i);
+      thread_create (name, waiter_pri[i], waiter_thread, (void *) i);
+      thread_yield ();
+    }
+}
+
+/* Wakes the waiters one at a time.  Each runs and exits before
+   the main thread, at PRI_MIN, gets to run again. */
+static void
+wake_waiters (void)
+{
+  int i;
+
+  if (kind == WAIT_LOCK)
+    {
+      /* Each waiter hands the lock on to the next. */
+      lock_release (&lock);
+      thread_yield ();
+      return;
+    }
+
+  for (i = 0; i < WAITER_CNT; i++)
+    {
+      if (kind == WAIT_SEMA)
+        sema_up (&sema);
+      else
+        {
+          lock_acquire (&lock);
+          cond_signal (&cond, &lock);
+          lock_release (&lock);
+        }
+      thread_yield ();
+    }
+}
+
+/* Sets the priority of waiter I, which must be blocked, to
+   PRIORITY, the way aging and the MLFQS change it. */
+static void
+set_waiter_priority (int i, int priority)
+{
+  enum intr_level old_level = intr_disable ();
+  waiters[i]->priority = priority;
+  wait_queue_reprioritize (waiters[i]);
+  intr_set_level (old_level);
+}
+
+void
+test_wait_queue (void)
+{
+  /* This test relies on strict priority scheduling. */
+  ASSERT (!thread_mlfqs && !thread_fair && !thread_prior_aging);
+
+  sema_init (&sema, 0);
+  lock_init (&lock);
+  cond_init (&cond);
+  thread_set_priority (PRI_MIN);
+
+  start_waiters (WAIT_SEMA);
+  wake_waiters ();
+
+  start_waiters (WAIT_COND);
+  wake_waiters ();
+
+  lock_acquire (&lock);
+  start_waiters (WAIT_LOCK);
+  wake_waiters ();
+
+  /* A condition waiter also waits on its own semaphore, so it
+     sits in two queues at once. */
+  start_waiters (WAIT_COND);
+  set_waiter_priority (5, PRI_DEFAULT);
+  set_waiter_priority (1, PRI_DEFAULT - 4);
+  wake_waiters ();
+}
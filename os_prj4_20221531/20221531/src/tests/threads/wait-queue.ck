@@ -0,0 +1,33 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(wait-queue) begin
+(wait-queue) sema: waiter 1, priority 30, woke up.
+(wait-queue) sema: waiter 4, priority 30, woke up.
+(wait-queue) sema: waiter 3, priority 29, woke up.
+(wait-queue) sema: waiter 0, priority 28, woke up.
+(wait-queue) sema: waiter 2, priority 28, woke up.
+(wait-queue) sema: waiter 5, priority 28, woke up.
+(wait-queue) cond: waiter 1, priority 30, woke up.
+(wait-queue) cond: waiter 4, priority 30, woke up.
+(wait-queue) cond: waiter 3, priority 29, woke up.
+(wait-queue) cond: waiter 0, priority 28, woke up.
+(wait-queue) cond: waiter 2, priority 28, woke up.
+(wait-queue) cond: waiter 5, priority 28, woke up.
+(wait-queue) lock: waiter 1, priority 30, woke up.
+(wait-queue) lock: waiter 4, priority 30, woke up.
+(wait-queue) lock: waiter 3, priority 29, woke up.
+(wait-queue) lock: waiter 0, priority 28, woke up.
+(wait-queue) lock: waiter 2, priority 28, woke up.
+(wait-queue) lock: waiter 5, priority 28, woke up.
+(wait-queue) cond: waiter 5, priority 31, woke up.
+(wait-queue) cond: waiter 4, priority 30, woke up.
+(wait-queue) cond: waiter 3, priority 29, woke up.
+(wait-queue) cond: waiter 0, priority 28, woke up.
+(wait-queue) cond: waiter 2, priority 28, woke up.
+(wait-queue) cond: waiter 1, priority 27, woke up.
+(wait-queue) end
+EOF
+pass;
@@ -0,0 +1,131 @@
+/* Checks workqueues: queued work runs once, queues with higher
+   priority are drained first, delayed work waits for its delay,
+   and cancelled work never runs.
+
+   All the work is queued with interrupts off, so that no worker
+   can start until the main thread blocks waiting for it.  With
+   several workers, items of one queue may start in any order, but
+   a worker that takes a low-priority item drops to that queue's
+   priority and so cannot start it before every high-priority
+   item taken by another worker. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/interrupt.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/workqueue.h"
+#include "devices/timer.h"
+
+#define ITEM_CNT 3              /* Work items per queue. */
+#define DELAY 5                 /* Ticks of delay for delayed work. */
+
+static struct workqueue high_wq, low_wq;
+
+/* Order in which work items started. */
+static int order[ITEM_CNT * 2];
+static int order_cnt;
+
+/* Upped by each work item once it has run. */
+static struct semaphore done;
+
+static int64_t delayed_ran_at;
+static bool cancelled_ran;
+
+/* Records that the work item numbered by its AUX started. */
+static void
+record_work (struct work *w)
+{
+  enum intr_level old_level = intr_disable ();
+  order[order_cnt++] = (int) w->aux;
+  intr_set_level (old_level);
+  sema_up (&done);
+}
+
+static void
+delayed_func (struct work *w UNUSED)
+{
+  delayed_ran_at = timer_ticks ();
+  sema_up (&done);
+}
+
+static void
+cancelled_work (struct work *w UNUSED)
+{
+  cancelled_ran = true;
+}
+
+void
+test_workqueue (void)
+{
+  struct work items[ITEM_CNT * 2];
+  struct work cancelled;
+  struct delayed_work delayed, cancelled_delayed;
+  enum intr_level old_level;
+  int64_t start;
+  int i;
+
+  /* This test relies on workers taking their queue's priority. */
+  ASSERT (!thread_mlfqs && !thread_fair);
+
+  sema_init (&done, 0);
+  workqueue_create (&high_wq, "test-high", PRI_DEFAULT + 10);
+  workqueue_create (&low_wq, "test-low", PRI_DEFAULT - 10);
+
+  /* Items 0 to 2 go on the low queue first, then 3 to 5 on the
+     high queue.  The high queue's must start first. */
+  old_level = intr_disable ();
+  for (i = 0; i < ITEM_CNT * 2; i++)
+    {
+      work_init (&items[i], record_work, (void *) i);
+      if (!queue_work (i < ITEM_CNT ? &low_wq : &high_wq, &items[i]))
+        fail ("could not queue item %d", i);
+    }
+  if (queue_work (&low_wq, &items[0]))
+    fail ("pending work was queued twice");
+  intr_set_level (old_level);
+
+  for (i = 0; i < ITEM_CNT * 2; i++)
+    sema_down (&done);
+  for (i = 0; i < ITEM_CNT * 2; i++)
+    {
+      int j;
+
+      if ((order[i] >= ITEM_CNT) != (i < ITEM_CNT))
+        fail ("item %d started in position %d", order[i], i);
+      for (j = 0; j < i; j++)
+        if (order[j] == order[i])
+          fail ("item %d ran twice", order[i]);
+    }
+  msg ("Work ran once each, high-priority queue first.");
+
+  /* Delayed work. */
+  delayed_work_init (&delayed, delayed_func, NULL);
+  start = timer_ticks ();
+  if (!queue_delayed_work (&high_wq, &delayed, DELAY))
+    fail ("could not queue delayed work");
+  if (queue_delayed_work (&high_wq, &delayed, 0))
+    fail ("waiting delayed work was queued again without delay");
+  sema_down (&done);
+  if (delayed_ran_at - start < DELAY)
+    fail ("delayed work ran after %lld ticks", delayed_ran_at - start);
+  msg ("Delayed work ran after its delay.");
+
+  /* Cancellation, before a worker or the timer gets to it. */
+  work_init (&cancelled, cancelled_work, NULL);
+  delayed_work_init (&cancelled_delayed, cancelled_work, NULL);
+  old_level = intr_disable ();
+  queue_work (&low_wq, &cancelled);
+  if (!cancel_work (&cancelled) || cancel_work (&cancelled))
+    fail ("cancel_work returned the wrong result");
+  intr_set_level (old_level);
+  queue_delayed_work (&low_wq, &cancelled_delayed, DELAY);
+  if (!cancel_delayed_work (&cancelled_delayed)
+      || cancel_delayed_work (&cancelled_delayed))
+    fail ("cancel_delayed_work returned the wrong result");
+  timer_sleep (DELAY * 2);
+  if (cancelled_ran)
+    fail ("cancelled work ran");
+  msg ("Cancelled work did not run.");
+}
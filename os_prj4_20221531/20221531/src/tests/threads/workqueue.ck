@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(workqueue) begin
+(workqueue) Work ran once each, high-priority queue first.
+(workqueue) Delayed work ran after its delay.
+(workqueue) Cancelled work did not run.
+(workqueue) end
+EOF
+pass;
@@ -0,0 +1,7 @@
+/* Exits with code 42.  Run by the exec-cache test. */
+
+int
+main (void)
+{
+  return 42;
+}
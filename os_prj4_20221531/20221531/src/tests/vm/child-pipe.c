@@ -0,0 +1,14 @@
+/* Writes "child" to the pipe write end whose descriptor is given
+   as argv[1], which it inherited from its parent.  Run by the
+   pipe test. */
+
+#include <stdlib.h>
+#include <syscall.h>
+
+int
+main (int argc, char *argv[])
+{
+  if (argc != 2)
+    return 1;
+  return write (atoi (argv[1]), "child", 5) == 5 ? 0 : 1;
+}
@@ -0,0 +1,21 @@
+/* Maps shared memory segment "seg", checks the pattern that the
+   shm test wrote to its first page, and writes "reply" to its
+   second.  Run by the shm test. */
+
+#include <string.h>
+#include <syscall.h>
+
+#define PAGE_SIZE 4096
+
+int
+main (void)
+{
+  char *p = (char *) 0x20000000;
+
+  if (shm_open ("seg", 0, p) == MAP_FAILED)
+    return 1;
+  if (strcmp (p, "pattern"))
+    return 2;
+  strlcpy (p + PAGE_SIZE, "reply", PAGE_SIZE);
+  return 0;
+}
@@ -0,0 +1,41 @@
+/* Reads the high-resolution clock many times, checking that it
+   never runs backward, that it can tell apart instants closer
+   together than a timer tick, and that it keeps up with a
+   busy-wait spanning several ticks. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+/* Nanoseconds in one 100 Hz timer tick. */
+#define TICK_NS 10000000LL
+
+void
+test_main (void)
+{
+  int64_t start, prev, now;
+  int i;
+
+  start = prev = clock_ns ();
+  for (i = 0; i < 100000; i++)
+    {
+      now = clock_ns ();
+      if (now < prev)
+        fail ("clock ran backward from %lld to %lld ns", prev, now);
+      prev = now;
+    }
+  msg ("clock never ran backward");
+
+  /* Wait for the clock to advance and check that it advanced
+     by less than a tick. */
+  prev = clock_ns ();
+  while ((now = clock_ns ()) == prev)
+    continue;
+  if (now - prev >= TICK_NS)
+    fail ("clock advanced by %lld ns, no finer than a tick", now - prev);
+  msg ("clock has sub-tick resolution");
+
+  while (clock_ns () - start < 5 * TICK_NS)
+    continue;
+  msg ("waited 5 ticks");
+}
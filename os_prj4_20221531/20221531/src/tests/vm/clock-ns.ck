@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(clock-ns) begin
+(clock-ns) clock never ran backward
+(clock-ns) clock has sub-tick resolution
+(clock-ns) waited 5 ticks
+(clock-ns) end
+EOF
+pass;
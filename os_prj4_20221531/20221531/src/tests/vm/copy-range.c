@@ -0,0 +1,53 @@
+/* Copies part of a file to another file at an unaligned offset
+   with copy_file_range, checks the data and both positions, and
+   then copies a file to the console. */
+
+#include <stdio.h>
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define SIZE 5000
+#define SKIP 100
+
+static char data[SIZE], copy[SIZE];
+static char line[] = "(copy-range) copied to console\n";
+
+void
+test_main (void)
+{
+  int in_fd, out_fd, fd;
+  size_t i;
+
+  for (i = 0; i < SIZE; i++)
+    data[i] = i * 7 + i / 13;
+
+  CHECK (create ("in", SIZE), "create \"in\"");
+  CHECK (create ("out", SIZE), "create \"out\"");
+  CHECK ((in_fd = open ("in")) > 1, "open \"in\"");
+  CHECK ((out_fd = open ("out")) > 1, "open \"out\"");
+  CHECK (write (in_fd, data, SIZE) == SIZE, "write \"in\"");
+
+  seek (in_fd, SKIP);
+  CHECK (copy_file_range (in_fd, out_fd, SIZE) == SIZE - SKIP,
+         "copy stops at end of \"in\"");
+  if (tell (in_fd) != SIZE || tell (out_fd) != SIZE - SKIP)
+    fail ("positions are %u and %u after copy", tell (in_fd), tell (out_fd));
+
+  seek (out_fd, 0);
+  CHECK (read (out_fd, copy, SIZE - SKIP) == SIZE - SKIP, "read \"out\"");
+  if (memcmp (copy, data + SKIP, SIZE - SKIP))
+    fail ("\"out\" does not match \"in\"");
+
+  CHECK (create ("line", sizeof line - 1), "create \"line\"");
+  CHECK ((fd = open ("line")) > 1, "open \"line\"");
+  write (fd, line, sizeof line - 1);
+  seek (fd, 0);
+  if (copy_file_range (fd, STDOUT_FILENO, 1000) != sizeof line - 1)
+    fail ("copy to console returned wrong count");
+
+  close (fd);
+  close (out_fd);
+  close (in_fd);
+}
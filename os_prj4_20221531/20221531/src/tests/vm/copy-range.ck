@@ -0,0 +1,19 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(copy-range) begin
+(copy-range) create "in"
+(copy-range) create "out"
+(copy-range) open "in"
+(copy-range) open "out"
+(copy-range) write "in"
+(copy-range) copy stops at end of "in"
+(copy-range) read "out"
+(copy-range) create "line"
+(copy-range) open "line"
+(copy-range) copied to console
+(copy-range) end
+EOF
+pass;
@@ -0,0 +1,30 @@
+/* Executes a copy of a program twice, the second time from the
+   exec cache, then overwrites the copy's ELF header and checks
+   that executing it again fails instead of using the stale
+   cached layout. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void)
+{
+  int src, dst, size, i;
+
+  CHECK ((src = open ("child-exit")) > 1, "open \"child-exit\"");
+  size = filesize (src);
+  CHECK (create ("copy", size), "create \"copy\"");
+  CHECK ((dst = open ("copy")) > 1, "open \"copy\"");
+  CHECK (copy_file_range (src, dst, size) == size,
+         "copy \"child-exit\" to \"copy\"");
+  close (src);
+
+  for (i = 0; i < 2; i++)
+    CHECK (wait (exec ("copy")) == 42, "run \"copy\"");
+
+  seek (dst, 0);
+  CHECK (write (dst, "junk", 4) == 4, "overwrite ELF header of \"copy\"");
+  close (dst);
+  CHECK (exec ("copy") == -1, "run overwritten \"copy\"");
+}
@@ -0,0 +1,53 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF', <<'EOF', <<'EOF']);
+(exec-cache) begin
+(exec-cache) open "child-exit"
+(exec-cache) create "copy"
+(exec-cache) open "copy"
+(exec-cache) copy "child-exit" to "copy"
+copy: exit(42)
+(exec-cache) run "copy"
+copy: exit(42)
+(exec-cache) run "copy"
+(exec-cache) overwrite ELF header of "copy"
+load: copy: error loading executable
+(exec-cache) run overwritten "copy"
+(exec-cache) end
+exec-cache: exit(0)
+EOF
+(exec-cache) begin
+(exec-cache) open "child-exit"
+(exec-cache) create "copy"
+(exec-cache) open "copy"
+(exec-cache) copy "child-exit" to "copy"
+copy: exit(42)
+(exec-cache) run "copy"
+copy: exit(42)
+(exec-cache) run "copy"
+(exec-cache) overwrite ELF header of "copy"
+load: copy: error loading executable
+copy: exit(-1)
+(exec-cache) run overwritten "copy"
+(exec-cache) end
+exec-cache: exit(0)
+EOF
+(exec-cache) begin
+(exec-cache) open "child-exit"
+(exec-cache) create "copy"
+(exec-cache) open "copy"
+(exec-cache) copy "child-exit" to "copy"
+copy: exit(42)
+(exec-cache) run "copy"
+copy: exit(42)
+(exec-cache) run "copy"
+(exec-cache) overwrite ELF header of "copy"
+load: copy: error loading executable
+(exec-cache) run overwritten "copy"
+copy: exit(-1)
+(exec-cache) end
+exec-cache: exit(0)
+EOF
+pass;
@@ -0,0 +1,31 @@
+/* A thread other than the main one calls exit() while the main
+   thread spins and another thread sleeps on a futex.  The whole
+   process must exit with the given status. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static int word;
+
+static void
+sleeper (void *aux UNUSED)
+{
+  futex_wait (&word, 0);
+  fail ("futex_wait returned");
+}
+
+static void
+exiter (void *aux UNUSED)
+{
+  exit (57);
+}
+
+void
+test_main (void)
+{
+  uthread_create (sleeper, NULL);
+  uthread_create (exiter, NULL);
+  for (;;)
+    continue;
+}
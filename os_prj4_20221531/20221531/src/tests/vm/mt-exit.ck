@@ -0,0 +1,9 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(mt-exit) begin
+mt-exit: exit(57)
+EOF
+pass;
@@ -0,0 +1,48 @@
+/* Starts several threads in one process, each of which fills
+   its own part of a shared array, and joins them, checking the
+   exit status each returns and the data each wrote. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define THREAD_CNT 4
+#define CHUNK 1024
+
+static int data[THREAD_CNT * CHUNK];
+
+static void
+fill (void *aux)
+{
+  int idx = (int) aux;
+  int i;
+
+  for (i = 0; i < CHUNK; i++)
+    data[idx * CHUNK + i] = idx * CHUNK + i;
+  uthread_exit (idx + 100);
+}
+
+void
+test_main (void)
+{
+  int tids[THREAD_CNT];
+  int i;
+
+  for (i = 0; i < THREAD_CNT; i++)
+    CHECK ((tids[i] = uthread_create (fill, (void *) i)) != -1,
+           "create thread %d", i);
+  for (i = 0; i < THREAD_CNT; i++)
+    {
+      int status = uthread_join (tids[i]);
+      if (status != i + 100)
+        fail ("thread %d exited with %d, expected %d", i, status, i + 100);
+    }
+  msg ("joined %d threads", THREAD_CNT);
+
+  for (i = 0; i < THREAD_CNT * CHUNK; i++)
+    if (data[i] != i)
+      fail ("data[%d] is %d", i, data[i]);
+  msg ("data verified");
+
+  CHECK (uthread_join (tids[0]) == -1, "join thread 0 again");
+}
@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(mt-join) begin
+(mt-join) create thread 0
+(mt-join) create thread 1
+(mt-join) create thread 2
+(mt-join) create thread 3
+(mt-join) joined 4 threads
+(mt-join) data verified
+(mt-join) join thread 0 again
+(mt-join) end
+EOF
+pass;
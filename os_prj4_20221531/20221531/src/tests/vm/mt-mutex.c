@@ -0,0 +1,52 @@
+/* Has several threads of one process increment a shared counter
+   under a futex-based mutex, with enough work inside the
+   critical section that timer preemption makes them contend. */
+
+#include <mutex.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define THREAD_CNT 4
+#define ITERATIONS 2000
+
+static struct mutex mutex = MUTEX_INITIALIZER;
+static volatile int counter;
+
+static void
+increment (void *aux UNUSED)
+{
+  int i;
+
+  for (i = 0; i < ITERATIONS; i++)
+    {
+      int value, j;
+
+      mutex_lock (&mutex);
+      value = counter;
+      for (j = 0; j < 100; j++)
+        asm volatile ("" ::: "memory");
+      counter = value + 1;
+      mutex_unlock (&mutex);
+    }
+}
+
+void
+test_main (void)
+{
+  int tids[THREAD_CNT];
+  int i;
+
+  for (i = 0; i < THREAD_CNT; i++)
+    {
+      tids[i] = uthread_create (increment, NULL);
+      if (tids[i] == -1)
+        fail ("uthread_create failed");
+    }
+  for (i = 0; i < THREAD_CNT; i++)
+    uthread_join (tids[i]);
+
+  if (counter != THREAD_CNT * ITERATIONS)
+    fail ("counter is %d, expected %d", counter, THREAD_CNT * ITERATIONS);
+  msg ("counter is %d", counter);
+}
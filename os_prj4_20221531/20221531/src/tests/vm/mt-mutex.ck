@@ -0,0 +1,10 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(mt-mutex) begin
+(mt-mutex) counter is 8000
+(mt-mutex) end
+EOF
+pass;
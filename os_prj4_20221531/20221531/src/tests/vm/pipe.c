@@ -0,0 +1,47 @@
+/* Passes data through a pipe: a few bytes, two whole pages into
+   a page-aligned buffer, which the kernel may remap instead of
+   copying, and bytes written by a child that inherited the write
+   end.  Then checks end of file and writing with no readers. */
+
+#include <stdio.h>
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+
+static char src[2 * PAGE_SIZE] __attribute__ ((aligned (PAGE_SIZE)));
+static char dst[2 * PAGE_SIZE] __attribute__ ((aligned (PAGE_SIZE)));
+
+void
+test_main (void)
+{
+  char cmd[32], buf[16];
+  int fds[2];
+  size_t i;
+
+  CHECK (pipe (fds) == 0, "pipe");
+  CHECK (write (fds[1], "hello", 5) == 5, "write \"hello\"");
+  CHECK (read (fds[0], buf, sizeof buf) == 5 && !memcmp (buf, "hello", 5),
+         "read \"hello\"");
+
+  for (i = 0; i < sizeof src; i++)
+    src[i] = i % 251;
+  CHECK (write (fds[1], src, sizeof src) == sizeof src, "write two pages");
+  CHECK (read (fds[0], dst, sizeof dst) == sizeof dst, "read two pages");
+  if (memcmp (src, dst, sizeof src))
+    fail ("pages read differ from pages written");
+
+  snprintf (cmd, sizeof cmd, "child-pipe %d", fds[1]);
+  CHECK (wait (exec (cmd)) == 0, "run \"%s\"", cmd);
+  close (fds[1]);
+  CHECK (read (fds[0], buf, sizeof buf) == 5 && !memcmp (buf, "child", 5),
+         "read \"child\"");
+  CHECK (read (fds[0], buf, sizeof buf) == 0, "read end of file");
+  close (fds[0]);
+
+  CHECK (pipe (fds) == 0, "pipe");
+  close (fds[0]);
+  CHECK (write (fds[1], "x", 1) == -1, "write with no readers");
+}
@@ -0,0 +1,21 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(pipe) begin
+(pipe) pipe
+(pipe) write "hello"
+(pipe) read "hello"
+(pipe) write two pages
+(pipe) read two pages
+child-pipe: exit(0)
+(pipe) run "child-pipe 3"
+(pipe) read "child"
+(pipe) read end of file
+(pipe) pipe
+(pipe) write with no readers
+(pipe) end
+pipe: exit(0)
+EOF
+pass;
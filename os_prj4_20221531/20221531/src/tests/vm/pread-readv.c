@@ -0,0 +1,62 @@
+/* Writes a file with pwrite and writev, reads it back with
+   pread and readv, and checks that the positioned calls leave
+   the file position alone while the vectored ones advance it. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static char abcd[] = "abcd", efghij[] = "efghij", klm[] = "klm";
+
+void
+test_main (void)
+{
+  char head[5], mid[7], tail[4], buf[16];
+  struct iovec iov[3];
+  int fd;
+
+  CHECK (create ("data", 16), "create \"data\"");
+  CHECK ((fd = open ("data")) > 1, "open \"data\"");
+
+  /* Gather "abcd" "efghij" "klm" into the start of the file. */
+  iov[0].iov_base = abcd;
+  iov[0].iov_len = 4;
+  iov[1].iov_base = efghij;
+  iov[1].iov_len = 6;
+  iov[2].iov_base = klm;
+  iov[2].iov_len = 3;
+  CHECK (writev (fd, iov, 3) == 13, "writev 13 bytes");
+  if (tell (fd) != 13)
+    fail ("writev left position at %u, not 13", tell (fd));
+
+  /* Overwrite the last three bytes at an offset. */
+  CHECK (pwrite (fd, "NOP", 3, 13) == 3, "pwrite 3 bytes at 13");
+  if (tell (fd) != 13)
+    fail ("pwrite moved position to %u", tell (fd));
+
+  memset (buf, 0, sizeof buf);
+  CHECK (pread (fd, buf, 6, 10) == 6, "pread 6 bytes at 10");
+  if (memcmp (buf, "klmNOP", 6))
+    fail ("pread got \"%.6s\", not \"klmNOP\"", buf);
+  if (tell (fd) != 13)
+    fail ("pread moved position to %u", tell (fd));
+  CHECK (pread (fd, buf, 8, 12) == 4, "pread stops at end of file");
+
+  /* Scatter the whole file back out. */
+  seek (fd, 0);
+  iov[0].iov_base = head;
+  iov[0].iov_len = sizeof head;
+  iov[1].iov_base = mid;
+  iov[1].iov_len = sizeof mid;
+  iov[2].iov_base = tail;
+  iov[2].iov_len = sizeof tail;
+  CHECK (readv (fd, iov, 3) == 16, "readv 16 bytes");
+  if (memcmp (head, "abcde", 5) || memcmp (mid, "fghijkl", 7)
+      || memcmp (tail, "mNOP", 4))
+    fail ("readv scattered the wrong bytes");
+  if (tell (fd) != 16)
+    fail ("readv left position at %u, not 16", tell (fd));
+
+  close (fd);
+}
@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(pread-readv) begin
+(pread-readv) create "data"
+(pread-readv) open "data"
+(pread-readv) writev 13 bytes
+(pread-readv) pwrite 3 bytes at 13
+(pread-readv) pread 6 bytes at 10
+(pread-readv) pread stops at end of file
+(pread-readv) readv 16 bytes
+(pread-readv) end
+EOF
+pass;
@@ -0,0 +1,82 @@
+/* Queues reads, writes, opens and closes on a submission ring
+   and checks their results on the completion ring, including
+   that the kernel stops when the completion ring is full. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static struct ring ring;
+
+static const char sample[] = "abcdefghijklmnopqrstuvwxyz";
+
+/* Queues an operation. */
+static void
+submit (int op, int fd, void *buf, unsigned len, uint32_t user_data)
+{
+  struct ring_sqe *sqe = &ring.sq[ring.sq_tail % RING_ENTRIES];
+
+  sqe->op = op;
+  sqe->fd = fd;
+  sqe->buf = buf;
+  sqe->len = len;
+  sqe->user_data = user_data;
+  ring.sq_tail++;
+}
+
+/* Consumes the next completion, which must be for USER_DATA,
+   and returns its result. */
+static int
+reap (uint32_t user_data)
+{
+  struct ring_cqe *cqe;
+
+  if (ring.cq_head == ring.cq_tail)
+    fail ("no completion for %u", user_data);
+  cqe = &ring.cq[ring.cq_head++ % RING_ENTRIES];
+  if (cqe->user_data != user_data)
+    fail ("completion for %u, expected %u", cqe->user_data, user_data);
+  return cqe->res;
+}
+
+void
+test_main (void)
+{
+  char buf[sizeof sample];
+  int fd, i;
+
+  CHECK (ring_enter (1) == -1, "ring_enter without rings");
+  CHECK (ring_setup (&ring) == 0, "ring_setup");
+  CHECK (create ("data", sizeof sample - 1), "create \"data\"");
+
+  submit (RING_OPEN, 0, "data", 0, 1);
+  CHECK (ring_enter (1) == 1, "submit open");
+  CHECK ((fd = reap (1)) > 1, "open \"data\" through the ring");
+
+  submit (RING_WRITE, fd, (void *) sample, sizeof sample - 1, 2);
+  submit (RING_NOP, 0, NULL, 0, 3);
+  submit (RING_CLOSE, fd, NULL, 0, 4);
+  CHECK (ring_enter (3) == 3, "submit write, nop and close");
+  CHECK (reap (2) == (int) sizeof sample - 1, "write \"data\" through the ring");
+  CHECK (reap (3) == 0, "nop");
+  CHECK (reap (4) == 0, "close");
+
+  CHECK ((fd = open ("data")) > 1, "open \"data\"");
+  memset (buf, 0, sizeof buf);
+  submit (RING_READ, fd, buf, sizeof buf, 5);
+  CHECK (ring_enter (1) == 1, "submit read");
+  CHECK (reap (5) == (int) sizeof sample - 1, "read \"data\" through the ring");
+  if (strcmp (buf, sample))
+    fail ("read \"%s\", expected \"%s\"", buf, sample);
+
+  for (i = 0; i < RING_ENTRIES; i++)
+    submit (RING_NOP, 0, NULL, 0, i);
+  CHECK (ring_enter (RING_ENTRIES) == RING_ENTRIES, "fill completion ring");
+  submit (RING_NOP, 0, NULL, 0, RING_ENTRIES);
+  CHECK (ring_enter (1) == 0, "submit to full completion ring");
+  for (i = 0; i < RING_ENTRIES; i++)
+    reap (i);
+  CHECK (ring_enter (1) == 1, "submit after reaping");
+  reap (RING_ENTRIES);
+}
@@ -0,0 +1,24 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(ring) begin
+(ring) ring_enter without rings
+(ring) ring_setup
+(ring) create "data"
+(ring) submit open
+(ring) open "data" through the ring
+(ring) submit write, nop and close
+(ring) write "data" through the ring
+(ring) nop
+(ring) close
+(ring) open "data"
+(ring) submit read
+(ring) read "data" through the ring
+(ring) fill completion ring
+(ring) submit to full completion ring
+(ring) submit after reaping
+(ring) end
+EOF
+pass;
@@ -0,0 +1,30 @@
+/* Shares a two-page memory segment with a child process, which
+   maps it at a different address, reads what the parent wrote
+   and writes back.  Then checks that the segment is gone once
+   neither process maps it. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+
+void
+test_main (void)
+{
+  char *p = (char *) 0x10000000;
+  mapid_t map;
+
+  CHECK (shm_open ("seg", 0, p) == MAP_FAILED, "open missing segment");
+  CHECK ((map = shm_open ("seg", 2 * PAGE_SIZE, p)) != MAP_FAILED,
+         "create segment");
+  CHECK (shm_open ("seg", 3 * PAGE_SIZE, (char *) 0x30000000) == MAP_FAILED,
+         "open segment with too large a size");
+  strlcpy (p, "pattern", PAGE_SIZE);
+  CHECK (wait (exec ("child-shm")) == 0, "run child-shm");
+  if (strcmp (p + PAGE_SIZE, "reply"))
+    fail ("child wrote \"%s\", expected \"reply\"", p + PAGE_SIZE);
+  munmap (map);
+  CHECK (shm_open ("seg", 0, p) == MAP_FAILED, "open removed segment");
+}
@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(shm) begin
+(shm) open missing segment
+(shm) create segment
+(shm) open segment with too large a size
+child-shm: exit(0)
+(shm) run child-shm
+(shm) open removed segment
+(shm) end
+shm: exit(0)
+EOF
+pass;
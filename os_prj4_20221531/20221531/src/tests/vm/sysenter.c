@@ -0,0 +1,39 @@
+/* Makes the same system calls through `int $0x30' and through
+   SYSENTER, checking that arguments get in, results get out, and
+   the caller's registers and stack survive either way. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static void
+exercise (const char *how)
+{
+  static const char data[] = "sysenter";
+  char buf[sizeof data];
+  int fd, i;
+
+  for (i = 0; i < 1000; i++)
+    null_syscall ();
+  CHECK ((fd = open ("sample.txt")) > 1, "%s: open \"sample.txt\"", how);
+  CHECK (write (fd, data, sizeof data) == sizeof data, "%s: write", how);
+  if (tell (fd) != sizeof data)
+    fail ("%s: tell returned wrong position", how);
+  seek (fd, 0);
+  CHECK (read (fd, buf, sizeof buf) == sizeof buf, "%s: read", how);
+  if (memcmp (buf, data, sizeof data))
+    fail ("%s: read back wrong data", how);
+  close (fd);
+}
+
+void
+test_main (void)
+{
+  CHECK (create ("sample.txt", 0), "create \"sample.txt\"");
+
+  sysenter_enable (false);
+  exercise ("int $0x30");
+  sysenter_enable (true);
+  exercise ("sysenter");
+}
@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(sysenter) begin
+(sysenter) create "sample.txt"
+(sysenter) int $0x30: open "sample.txt"
+(sysenter) int $0x30: write
+(sysenter) int $0x30: read
+(sysenter) sysenter: open "sample.txt"
+(sysenter) sysenter: write
+(sysenter) sysenter: read
+(sysenter) end
+EOF
+pass;
@@ -0,0 +1,49 @@
+/* Traces a few system calls and reads back their records and
+   histogram, then stops tracing so that nothing is dumped at
+   exit. */
+
+#include <syscall.h>
+#include <syscall-nr.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void)
+{
+  struct trace_record r[8];
+  struct trace_hist h;
+  int cnt, i;
+
+  CHECK (trace_read (r, 8) == -1, "trace_read before tracing");
+
+  /* Print nothing while tracing, since printing is a system
+     call too. */
+  if (!trace (true))
+    fail ("trace (true) failed");
+  for (i = 0; i < 3; i++)
+    null_syscall ();
+  wait (-5);
+  cnt = trace_read (r, 8);
+
+  CHECK (cnt == 4, "trace_read returns 4 records");
+  for (i = 0; i < 3; i++)
+    if (r[i].nr != SYS_NULL)
+      fail ("record %d is system call %d, expected %d", i, r[i].nr, SYS_NULL);
+  if (r[3].nr != SYS_WAIT || r[3].ret != -1 || (int) r[3].args[0] != -5)
+    fail ("record 3 is %d(%d) = %d, expected %d(-5) = -1",
+          r[3].nr, (int) r[3].args[0], r[3].ret, SYS_WAIT);
+  for (i = 1; i < 4; i++)
+    if (r[i].start_ns < r[i - 1].start_ns)
+      fail ("records out of order");
+
+  CHECK (trace_read (r, 8) >= 1, "trace_read returns later calls");
+  if (r[0].nr != SYS_TRACE_READ || r[0].ret != 4)
+    fail ("record is %d = %d, expected %d = 4", r[0].nr, r[0].ret,
+          SYS_TRACE_READ);
+
+  CHECK (trace_hist (SYS_NULL, &h), "trace_hist (SYS_NULL)");
+  if (h.cnt != 3)
+    fail ("%u null calls counted, expected 3", h.cnt);
+  CHECK (!trace_hist (-1, &h), "trace_hist (-1) fails");
+  CHECK (trace (false), "trace (false)");
+}
@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(trace) begin
+(trace) trace_read before tracing
+(trace) trace_read returns 4 records
+(trace) trace_read returns later calls
+(trace) trace_hist (SYS_NULL)
+(trace) trace_hist (-1) fails
+(trace) trace (false)
+(trace) end
+EOF
+pass;
@@ -0,0 +1,35 @@
+/* Passes system calls user buffers on pages that are not yet
+   loaded, which the kernel must bring in as it copies, then a
+   buffer that runs from the top of the stack into kernel space.
+   The process must be terminated with -1 exit code. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define SIZE (4 * 4096)
+
+/* Not touched before the kernel copies into it. */
+static char buf[SIZE];
+
+void
+test_main (void)
+{
+  static char data[SIZE];
+  int handle;
+  size_t i;
+
+  for (i = 0; i < SIZE; i++)
+    data[i] = i % 251;
+  CHECK (create ("data", SIZE), "create \"data\"");
+  CHECK ((handle = open ("data")) > 1, "open \"data\"");
+  CHECK (write (handle, data, SIZE) == SIZE, "write \"data\"");
+  seek (handle, 0);
+  CHECK (read (handle, buf, SIZE) == SIZE, "read \"data\"");
+  if (memcmp (buf, data, SIZE))
+    fail ("read wrong data");
+
+  read (handle, (char *) 0xc0000000 - 16, 32);
+  fail ("survived reading data across PHYS_BASE");
+}
@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(uaccess) begin
+(uaccess) create "data"
+(uaccess) open "data"
+(uaccess) write "data"
+(uaccess) read "data"
+uaccess: exit(-1)
+EOF
+pass;
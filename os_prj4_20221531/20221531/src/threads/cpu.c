@@ -0,0 +1,214 @@
+#include "threads/cpu.h"
+#include <debug.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include "threads/loader.h"
+#include "threads/vaddr.h"
+
+/* Per-CPU state, indexed by CPU number.  cpus[0] is the
+   bootstrap processor (BSP), the one that runs main(). */
+struct cpu cpus[CPU_MAX];
+
+/* Number of processors described by the firmware, including the
+   BSP.  At least 1. */
+int cpu_cnt;
+
+/* Physical address of the local APIC registers, as reported by
+   the MP configuration table, or 0 if there is none. */
+static uint32_t lapic_paddr;
+
+/* MP floating pointer structure.  See [MP] 4.1. */
+struct mp_float
+  {
+    char signature[4];              /* "_MP_". */
+    uint32_t config_paddr;          /* Physical address of config table. */
+    uint8_t length;                 /* In 16-byte units, always 1. */
+    uint8_t spec_rev;
+    uint8_t checksum;               /* All bytes must sum to 0. */
+    uint8_t type;                   /* Default configuration type. */
+    uint8_t imcr;
+    uint8_t reserved[3];
+  };
+
+/* MP configuration table header.  See [MP] 4.2. */
+struct mp_config
+  {
+    char signature[4];              /* "PCMP". */
+    uint16_t length;                /* Base table length. */
+    uint8_t version;
+    uint8_t checksum;
+    char oem_id[8];
+    char product_id[12];
+    uint32_t oem_table;
+    uint16_t oem_table_size;
+    uint16_t entry_cnt;             /* Entries following this header. */
+    uint32_t lapic_paddr;           /* Local APIC address. */
+    uint16_t ext_length;
+    uint8_t ext_checksum;
+    uint8_t reserved;
+  };
+
+/* MP configuration table processor entry.  See [MP] 4.3.1. */
+struct mp_proc
+  {
+    uint8_t type;                   /* MP_PROC. */
+    uint8_t apic_id;                /* Local APIC ID. */
+    uint8_t apic_version;
+    uint8_t flags;                  /* MP_PROC_* flags. */
+    uint32_t signature;
+    uint32_t features;
+    uint32_t reserved[2];
+  };
+
+/* MP configuration table entry types and sizes. */
+#define MP_PROC 0                   /* Processor, 20 bytes. */
+#define MP_PROC_ENABLED 0x01        /* Processor is usable. */
+#define MP_PROC_BSP 0x02            /* Processor is the BSP. */
+#define MP_OTHER_SIZE 8             /* Bus, I/O APIC, interrupt entries. */
+
+static void init_cpu (struct cpu *, int id, uint8_t apic_id);
+
+/* Sets up the state for the bootstrap processor, which is the
+   one running this code.  Must be called before anything that
+   needs cpu_current(), i.e. before thread_init(). */
+void
+cpu_init (void)
+{
+  init_cpu (&cpus[0], 0, 0);
+  cpus[0].online = true;
+  cpu_cnt = 1;
+}
+
+/* Returns true if the LEN bytes at P sum to zero. */
+static bool
+checksum_ok (const void *p, size_t len)
+{
+  const uint8_t *b = p;
+  uint8_t sum = 0;
+
+  while (len-- > 0)
+    sum += *b++;
+  return sum == 0;
+}
+
+/* Returns true if physical range [PADDR, PADDR + LEN) is covered
+   by the kernel's mapping of physical memory. */
+static bool
+paddr_mapped (uint32_t paddr, size_t len)
+{
+  return paddr + len > paddr && paddr + len <= init_ram_pages * PGSIZE;
+}
+
+/* Looks for an MP floating pointer in the LEN bytes at physical
+   address PADDR.  Returns it if found, otherwise a null pointer. */
+static struct mp_float *
+search_mp_float (uint32_t paddr, size_t len)
+{
+  uint8_t *p, *end;
+
+  if (!paddr_mapped (paddr, len))
+    return NULL;
+  p = ptov (paddr);
+  end = p + len;
+  for (; p + sizeof (struct mp_float) <= end; p += 16)
+    if (!memcmp (p, "_MP_", 4) && checksum_ok (p, sizeof (struct mp_float)))
+      return (struct mp_float *) p;
+  return NULL;
+}
+
+/* Finds the MP floating pointer in one of the places [MP] 4
+   says it may be: the first kB of the EBDA, the last kB of base
+   memory, or the BIOS ROM. */
+static struct mp_float *
+find_mp_float (void)
+{
+  struct mp_float *mp;
+  uint32_t ebda = *(uint16_t *) ptov (0x40e) << 4;
+  uint32_t base_kb = *(uint16_t *) ptov (0x413);
+
+  if (ebda != 0 && (mp = search_mp_float (ebda, 1024)) != NULL)
+    return mp;
+  if ((mp = search_mp_float (base_kb * 1024 - 1024, 1024)) != NULL)
+    return mp;
+  return search_mp_float (0xf0000, 0x10000);
+}
+
+/* Counts the processors described by the firmware's MP tables
+   and records them in cpus[].  Only the BSP is brought online:
+   the rest of the kernel still relies on intr_disable() for
+   mutual exclusion, so application processors are left parked
+   in the BIOS's wait-for-SIPI state. */
+void
+cpu_probe (void)
+{
+  struct mp_float *mp = find_mp_float ();
+  struct mp_config *conf;
+  uint8_t *p, *end;
+  int i;
+
+  if (mp == NULL || mp->config_paddr == 0
+      || !paddr_mapped (mp->config_paddr, sizeof *conf))
+    {
+      printf ("cpu: no MP configuration table, assuming 1 CPU\n");
+      return;
+    }
+
+  conf = ptov (mp->config_paddr);
+  if (memcmp (conf->signature, "PCMP", 4)
+      || !paddr_mapped (mp->config_paddr, conf->length)
+      || !checksum_ok (conf, conf->length))
+    {
+      printf ("cpu: bad MP configuration table, assuming 1 CPU\n");
+      return;
+    }
+  lapic_paddr = conf->lapic_paddr;
+
+  p = (uint8_t *) (conf + 1);
+  end = (uint8_t *) conf + conf->length;
+  for (i = 0; i < conf->entry_cnt && p < end; i++)
+    {
+      if (*p == MP_PROC)
+        {
+          struct mp_proc *proc = (struct mp_proc *) p;
+          if (proc->flags & MP_PROC_BSP)
+            cpus[0].apic_id = proc->apic_id;
+          else if ((proc->flags & MP_PROC_ENABLED) && cpu_cnt < CPU_MAX)
+            {
+              init_cpu (&cpus[cpu_cnt], cpu_cnt, proc->apic_id);
+              cpu_cnt++;
+            }
+          p += sizeof *proc;
+        }
+      else
+        p += MP_OTHER_SIZE;
+    }
+
+  printf ("cpu: %d CPU(s) found, local APIC at %#"PRIx32", 1 online\n",
+          cpu_cnt, lapic_paddr);
+}
+
+/* Returns the CPU this code is running on.
+
+   Only the BSP is ever online today.  Once application
+   processors run the scheduler this must be answered from the
+   local APIC ID register instead. */
+struct cpu *
+cpu_current (void)
+{
+  return &cpus[0];
+}
+
+/* Does basic initialization of C as CPU number ID with local APIC
+   ID APIC_ID. */
+static void
+init_cpu (struct cpu *c, int id, uint8_t apic_id)
+{
+  memset (c, 0, sizeof *c);
+  c->id = id;
+  c->apic_id = apic_id;
+  spinlock_init (&c->rq_lock, "run queue");
+  list_init (&c->ready_list);
+  list_init (&c->rt_list);
+  list_init (&c->rt_throttled);
+}
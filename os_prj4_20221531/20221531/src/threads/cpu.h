@@ -0,0 +1,66 @@
+#ifndef THREADS_CPU_H
+#define THREADS_CPU_H
+
+#include <list.h>
+#include <rbtree.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "threads/spinlock.h"
+
+/* Per-CPU state: groundwork for multiprocessor support, not the
+   support itself.  The kernel runs on the bootstrap processor
+   only.  Scheduling and TSS code already reach their state
+   through cpu_current() and each CPU has its own run queue, but
+   these are still missing:
+
+     - starting application processors with INIT/SIPI through
+       the local APIC;
+     - answering cpu_current() from the local APIC ID;
+     - balancing or stealing threads between run queues;
+     - mutual exclusion that does not rely on intr_disable(), in
+       synch.c, palloc, the file system and elsewhere, and
+       building with -DSMP so that spinlocks really spin.
+
+   Until then, -smp N only makes cpu_probe() count N CPUs. */
+
+/* Maximum number of CPUs we keep state for. */
+#define CPU_MAX 8
+
+/* Per-CPU state.
+
+   Everything here belongs to one processor.  Threads are woken
+   onto the run queue of the CPU they last ran on, possibly from
+   another CPU, so it is protected by `rq_lock'; the remaining
+   members are only touched by their own CPU, with interrupts
+   off. */
+struct cpu
+  {
+    int id;                         /* Index into cpus[]. */
+    uint8_t apic_id;                /* Local APIC ID. */
+    bool online;                    /* Running the scheduler? */
+
+    /* Scheduling.  Owned by thread.c. */
+    struct spinlock rq_lock;        /* Protects the run queue. */
+    struct list ready_list;         /* Threads ready to run here. */
+    struct rb_tree fair_tree;       /* Same, by vruntime, for -fair. */
+    struct list rt_list;            /* Real-time threads, by deadline. */
+    struct list rt_throttled;       /* Real-time threads out of budget. */
+    size_t ready_cnt;               /* Number of threads ready here. */
+    unsigned long fair_load;        /* Sum of weights in fair_tree. */
+    int64_t min_vruntime;           /* Monotonic vruntime floor. */
+    struct thread *idle_thread;     /* This CPU's idle thread. */
+    unsigned thread_ticks;          /* # of timer ticks since last yield. */
+
+    /* Owned by userprog/tss.c. */
+    struct tss *tss;                /* Task-state segment. */
+  };
+
+extern struct cpu cpus[CPU_MAX];
+extern int cpu_cnt;
+
+void cpu_init (void);
+void cpu_probe (void);
+struct cpu *cpu_current (void);
+
+#endif /* threads/cpu.h */
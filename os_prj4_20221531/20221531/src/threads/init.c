@@ -15,18 +15,22 @@
 #include "devices/timer.h"
 #include "devices/vga.h"
 #include "devices/rtc.h"
+#include "threads/cpu.h"
 #include "threads/interrupt.h"
 #include "threads/io.h"
 #include "threads/loader.h"
 #include "threads/malloc.h"
 #include "threads/palloc.h"
+#include "threads/profile.h"
 #include "threads/pte.h"
 #include "threads/thread.h"
+#include "threads/workqueue.h"
 #ifdef USERPROG
 #include "userprog/process.h"
 #include "userprog/exception.h"
 #include "userprog/gdt.h"
 #include "userprog/syscall.h"
+#include "userprog/trace.h"
 #include "userprog/tss.h"
 #else
 #include "tests/threads/tests.h"
@@ -38,6 +42,7 @@
 #include "filesys/fsutil.h"
 #endif
 #include "vm/frame.h"
+#include "vm/shm.h"
 #include "vm/swap.h"
 
 /* Page directory with kernel mappings only. */
@@ -56,6 +61,14 @@ static const char *swap_bdev_name;
 #endif
 #endif /* FILESYS */
 
+/* -workers: Number of workqueue worker threads. */
+static size_t workqueue_workers = WORKQUEUE_DEFAULT_WORKERS;
+
+/* -profile: Sample for the profiler?  At what rate (0 for every
+   timer tick)? */
+static bool profile;
+static int profile_hz;
+
 /* -ul: Maximum number of pages to put into palloc's user pool. */
 static size_t user_page_limit = SIZE_MAX;
 
@@ -100,8 +113,10 @@ main (void)
   palloc_init (user_page_limit);
   malloc_init ();
   paging_init ();
+  cpu_probe ();
   
   vm_frame_init();
+  shm_init();
   
   /* Segmentation. */
 #ifdef USERPROG
@@ -112,6 +127,8 @@ main (void)
   /* Initialize interrupt handlers. */
   intr_init ();
   timer_init ();
+  if (profile)
+    profile_init (profile_hz);
   kbd_init ();
   input_init ();
 #ifdef USERPROG
@@ -121,7 +138,11 @@ main (void)
 
   /* Start thread scheduler and enable interrupts. */
   thread_start ();
+  softirq_init ();
+  workqueue_init (workqueue_workers);
+  thread_aging_start ();
   serial_init_queue ();
+  vga_init_deferred ();
   timer_calibrate ();
 
 #ifdef FILESYS
@@ -262,16 +283,30 @@ parse_options (char **argv)
         random_init (atoi (value));
       else if (!strcmp (name, "-mlfqs"))
         thread_mlfqs = true;
+      else if (!strcmp (name, "-fair"))
+        thread_fair = true;
       else if (!strcmp (name, "-aging"))
         thread_prior_aging = true;
+      else if (!strcmp (name, "-workers"))
+        workqueue_workers = atoi (value);
+      else if (!strcmp (name, "-profile"))
+        {
+          profile = true;
+          profile_hz = value != NULL ? atoi (value) : 0;
+        }
 #ifdef USERPROG
       else if (!strcmp (name, "-ul"))
         user_page_limit = atoi (value);
+      else if (!strcmp (name, "-trace"))
+        trace_all = true;
 #endif
       else
         PANIC ("unknown option `%s' (use -h for help)", name);
     }
 
+  if (thread_mlfqs && thread_fair)
+    PANIC ("-mlfqs and -fair are mutually exclusive");
+
   /* Initialize the random number generator based on the system
      time.  This has no effect if an "-rs" option was specified.
 
@@ -387,8 +422,12 @@ usage (void)
 #endif
           "  -rs=SEED           Set random number seed to SEED.\n"
           "  -mlfqs             Use multi-level feedback queue scheduler.\n"
+          "  -fair              Use fair-share (virtual runtime) scheduler.\n"
+          "  -workers=COUNT     Start COUNT workqueue worker threads.\n"
+          "  -profile[=HZ]      Sample for the profiler on each tick or at HZ.\n"
 #ifdef USERPROG
           "  -ul=COUNT          Limit user memory to COUNT pages.\n"
+          "  -trace             Trace the system calls of every process.\n"
 #endif
           );
   shutdown_power_off ();
@@ -1,14 +1,21 @@
 #include "threads/interrupt.h"
 #include <debug.h>
+#include <histogram.h>
 #include <inttypes.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 #include "threads/flags.h"
 #include "threads/intr-stubs.h"
 #include "threads/io.h"
+#include "threads/synch.h"
 #include "threads/thread.h"
 #include "threads/vaddr.h"
 #include "devices/timer.h"
+#ifdef USERPROG
+#include "userprog/gdt.h"
+#include "userprog/process.h"
+#endif
 
 /* Programmable Interrupt Controller (PIC) registers.
    A PC has two PICs, called the master and slave PICs, with the
@@ -47,6 +54,15 @@ static unsigned int unexpected_cnt[INTR_CNT];
 static bool in_external_intr;   /* Are we processing an external interrupt? */
 static bool yield_on_return;    /* Should we yield on interrupt return? */
 
+/* Softirqs.  A softirq handler runs with interrupts on, but no
+   other thread runs until it finishes. */
+#define SOFTIRQ_RESTART_MAX 4   /* Rounds before deferring to ksoftirqd. */
+static softirq_func *softirq_handlers[SOFTIRQ_CNT];
+static unsigned softirq_pending;        /* Bit I set: softirq I raised. */
+static bool in_softirq;                 /* Running softirq handlers? */
+static struct thread *ksoftirqd;        /* Runs softirqs left over. */
+static struct semaphore ksoftirqd_wakeup;
+
 /* Programmable Interrupt Controller helpers. */
 static void pic_init (void);
 static void pic_end_of_interrupt (int irq);
@@ -59,6 +75,18 @@ static inline uint64_t make_idtr_operand (uint16_t limit, void *base);
 /* Interrupt handlers. */
 void intr_handler (struct intr_frame *args);
 static void unexpected_interrupt (const struct intr_frame *);
+
+/* Interrupts-off latency tracer. */
+#ifdef INTRTRACE
+static void trace_off (void *site);
+static void trace_on (void *site);
+#endif
+static enum intr_level enable_at (void *site);
+static enum intr_level disable_at (void *site);
+
+/* Softirqs. */
+static void softirq_run (void);
+static thread_func ksoftirqd_thread;
 
 /* Returns the current interrupt status. */
 enum intr_level
@@ -80,15 +108,36 @@ intr_get_level (void)
 enum intr_level
 intr_set_level (enum intr_level level) 
 {
-  return level == INTR_ON ? intr_enable () : intr_disable ();
+  void *site = __builtin_return_address (0);
+  return level == INTR_ON ? enable_at (site) : disable_at (site);
 }
 
 /* Enables interrupts and returns the previous interrupt status. */
 enum intr_level
 intr_enable (void) 
+{
+  return enable_at (__builtin_return_address (0));
+}
+
+/* Disables interrupts and returns the previous interrupt status. */
+enum intr_level
+intr_disable (void) 
+{
+  return disable_at (__builtin_return_address (0));
+}
+
+/* Enables interrupts on behalf of a caller at SITE and returns
+   the previous interrupt status. */
+static inline enum intr_level
+enable_at (void *site UNUSED)
 {
   enum intr_level old_level = intr_get_level ();
-  ASSERT (!intr_context ());
+  ASSERT (!in_external_intr);
+
+#ifdef INTRTRACE
+  if (old_level == INTR_OFF)
+    trace_on (site);
+#endif
 
   /* Enable interrupts by setting the interrupt flag.
 
@@ -99,9 +148,10 @@ intr_enable (void)
   return old_level;
 }
 
-/* Disables interrupts and returns the previous interrupt status. */
-enum intr_level
-intr_disable (void) 
+/* Disables interrupts on behalf of a caller at SITE and returns
+   the previous interrupt status. */
+static inline enum intr_level
+disable_at (void *site UNUSED)
 {
   enum intr_level old_level = intr_get_level ();
 
@@ -110,6 +160,11 @@ intr_disable (void)
      Hardware Interrupts". */
   asm volatile ("cli" : : : "memory");
 
+#ifdef INTRTRACE
+  if (old_level == INTR_ON)
+    trace_off (site);
+#endif
+
   return old_level;
 }
 
@@ -206,18 +261,18 @@ intr_register_int (uint8_t vec_no, int dpl, enum intr_level level,
   register_handler (vec_no, dpl, level, handler, name);
 }
 
-/* Returns true during processing of an external interrupt
-   and false at all other times. */
+/* Returns true during processing of an external interrupt or
+   a softirq and false at all other times. */
 bool
 intr_context (void) 
 {
-  return in_external_intr;
+  return in_external_intr || in_softirq;
 }
 
-/* During processing of an external interrupt, directs the
-   interrupt handler to yield to a new process just before
-   returning from the interrupt.  May not be called at any other
-   time. */
+/* During processing of an external interrupt or a softirq,
+   directs the interrupt handler to yield to a new process just
+   before returning from the interrupt.  May not be called at any
+   other time. */
 void
 intr_yield_on_return (void) 
 {
@@ -347,6 +402,13 @@ intr_handler (struct intr_frame *frame)
   bool external;
   intr_handler_func *handler;
 
+#ifdef INTRTRACE
+  /* Taking an interrupt through an interrupt gate turned
+     interrupts off. */
+  if ((frame->eflags & FLAG_IF) && intr_get_level () == INTR_OFF)
+    trace_off (intr_handlers[frame->vec_no]);
+#endif
+
   /* External interrupts are special.
      We only handle one at a time (so interrupts must be off)
      and they need to be acknowledged on the PIC (see below).
@@ -355,10 +417,9 @@ intr_handler (struct intr_frame *frame)
   if (external) 
     {
       ASSERT (intr_get_level () == INTR_OFF);
-      ASSERT (!intr_context ());
+      ASSERT (!in_external_intr);
 
       in_external_intr = true;
-      yield_on_return = false;
     }
 
   /* Invoke the interrupt's handler. */
@@ -383,8 +444,139 @@ intr_handler (struct intr_frame *frame)
       in_external_intr = false;
       pic_end_of_interrupt (frame->vec_no); 
 
-      if (yield_on_return) 
-        thread_yield (); 
+      /* Run deferred work, unless this interrupt arrived in the
+         middle of it, in which case the softirqs we were running
+         will pick up anything we raised, as well as any request
+         to yield. */
+      if (!in_softirq)
+        {
+          softirq_run ();
+          if (yield_on_return) 
+            {
+              yield_on_return = false;
+              thread_yield (); 
+            }
+        }
+    }
+
+#ifdef USERPROG
+  /* Last chance to stop a thread whose process is exiting
+     before it goes back to user mode. */
+  if (frame->cs == SEL_UCSEG)
+    process_check_exiting ();
+#endif
+
+#ifdef INTRTRACE
+  /* Returning will restore the interrupted code's interrupt
+     flag. */
+  if ((frame->eflags & FLAG_IF) && intr_get_level () == INTR_OFF)
+    trace_on (intr_handlers[frame->vec_no]);
+#endif
+}
+
+/* Softirqs. */
+
+/* Starts the ksoftirqd thread.  Until this is called, softirqs
+   that are left over are run at the next interrupt instead.
+   Must be called after thread_start(). */
+void
+softirq_init (void)
+{
+  struct semaphore started;
+
+  sema_init (&ksoftirqd_wakeup, 0);
+  sema_init (&started, 0);
+  if (thread_create ("ksoftirqd", PRI_MAX, ksoftirqd_thread, &started)
+      == TID_ERROR)
+    PANIC ("could not start ksoftirqd");
+  sema_down (&started);
+}
+
+/* Sets HANDLER as the handler for softirq SOFTIRQ. */
+void
+softirq_register (enum softirq softirq, softirq_func *handler)
+{
+  ASSERT (softirq < SOFTIRQ_CNT);
+  ASSERT (softirq_handlers[softirq] == NULL);
+  softirq_handlers[softirq] = handler;
+}
+
+/* Marks SOFTIRQ to be run when the current external interrupt
+   returns, or at the next one if called from a thread. */
+void
+softirq_raise (enum softirq softirq)
+{
+  enum intr_level old_level;
+
+  ASSERT (softirq < SOFTIRQ_CNT);
+  old_level = intr_disable ();
+  softirq_pending |= 1u << softirq;
+  intr_set_level (old_level);
+}
+
+/* Returns true if T is the ksoftirqd thread. */
+bool
+softirq_is_ksoftirqd (const struct thread *t)
+{
+  return ksoftirqd != NULL && t == ksoftirqd;
+}
+
+/* Runs the pending softirq handlers with interrupts on, over and
+   over until none are pending or SOFTIRQ_RESTART_MAX rounds have
+   run, then wakes ksoftirqd for any that remain.  Must be
+   called, and returns, with interrupts off. */
+static void
+softirq_run (void)
+{
+  int round;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+  ASSERT (!in_softirq);
+
+  in_softirq = true;
+  for (round = 0; softirq_pending != 0 && round < SOFTIRQ_RESTART_MAX;
+       round++)
+    {
+      unsigned pending = softirq_pending;
+      int i;
+
+      softirq_pending = 0;
+      intr_enable ();
+      for (i = 0; i < SOFTIRQ_CNT; i++)
+        if ((pending & (1u << i)) && softirq_handlers[i] != NULL)
+          softirq_handlers[i] ();
+      intr_disable ();
+    }
+  in_softirq = false;
+
+  if (softirq_pending != 0 && ksoftirqd != NULL)
+    sema_up (&ksoftirqd_wakeup);
+}
+
+/* Runs softirqs that were raised too often to finish on the
+   return path of an interrupt. */
+static void
+ksoftirqd_thread (void *started_)
+{
+  struct semaphore *started = started_;
+
+  ksoftirqd = thread_current ();
+  sema_up (started);
+  for (;;)
+    {
+      enum intr_level old_level;
+      bool yield;
+
+      sema_down (&ksoftirqd_wakeup);
+
+      old_level = intr_disable ();
+      softirq_run ();
+      yield = yield_on_return;
+      yield_on_return = false;
+      intr_set_level (old_level);
+
+      if (yield)
+        thread_yield ();
     }
 }
 
@@ -436,3 +628,153 @@ intr_name (uint8_t vec)
 {
   return intr_names[vec];
 }
+
+#ifdef INTRTRACE
+/* Interrupts-off latency tracer. */
+
+#define TRACE_BUCKETS 16        /* Histogram buckets. */
+#define TRACE_PAIRS 64          /* Distinct pairs of call sites. */
+#define TRACE_TOP 16            /* Pairs printed. */
+
+/* Interrupts-off sections that started and ended at the same
+   call sites.  Times are in CPU cycles. */
+struct trace_pair
+  {
+    void *off_site;             /* Where interrupts went off. */
+    void *on_site;              /* Where they came back on. */
+    unsigned long long cnt;     /* # of sections. */
+    uint64_t total, max;        /* Time with interrupts off. */
+  };
+
+static struct trace_pair trace_pairs[TRACE_PAIRS];
+static size_t trace_pair_cnt;
+static struct trace_pair trace_other;   /* Pairs that didn't fit. */
+
+/* Histogram of section lengths, laid out as described in
+   lib/kernel/histogram.h. */
+static unsigned long long trace_hist[TRACE_BUCKETS];
+
+/* The section in progress, if any. */
+static bool trace_open;
+static void *trace_site;
+static uint64_t trace_start;
+
+/* Notes that interrupts just went off at SITE.  Code that turns
+   them back on without going through this file, like the idle
+   thread's `sti; hlt', leaves a section open; a new one simply
+   replaces it, unrecorded. */
+static void
+trace_off (void *site)
+{
+  trace_open = true;
+  trace_site = site;
+  trace_start = timer_cycles ();
+}
+
+/* Records the section in progress, which interrupts are about to
+   end at SITE.  Runs with interrupts off, so it must not turn them
+   on or off itself. */
+static void
+trace_on (void *site)
+{
+  uint64_t len;
+  struct trace_pair *p;
+  size_t i;
+
+  if (!trace_open)
+    return;
+  trace_open = false;
+  len = timer_cycles () - trace_start;
+
+  trace_hist[histogram_bucket (timer_cycles_to_ns (len), TRACE_BUCKETS)]++;
+
+  p = &trace_other;
+  for (i = 0; i < trace_pair_cnt; i++)
+    if (trace_pairs[i].off_site == trace_site
+        && trace_pairs[i].on_site == site)
+      {
+        p = &trace_pairs[i];
+        break;
+      }
+  if (i == trace_pair_cnt && trace_pair_cnt < TRACE_PAIRS)
+    {
+      p = &trace_pairs[trace_pair_cnt++];
+      p->off_site = trace_site;
+      p->on_site = site;
+    }
+  p->cnt++;
+  p->total += len;
+  if (len > p->max)
+    p->max = len;
+}
+
+/* Prints the histogram of interrupts-off section lengths and the
+   TRACE_TOP pairs of call sites with the longest sections.  Call
+   sites are return addresses or, for sections begun by an
+   interrupt, the interrupt's handler; pass them to the
+   `backtrace' utility to get source lines. */
+void
+intr_trace_print (void)
+{
+  static struct trace_pair pairs[TRACE_PAIRS];
+  static unsigned long long hist[TRACE_BUCKETS];
+  size_t pair_cnt, i, j;
+  enum intr_level old_level;
+
+  /* Take a snapshot, since printing turns interrupts on and
+     off. */
+  old_level = intr_disable ();
+  pair_cnt = trace_pair_cnt;
+  memcpy (pairs, trace_pairs, pair_cnt * sizeof *pairs);
+  memcpy (hist, trace_hist, sizeof hist);
+  intr_set_level (old_level);
+
+  printf ("Interrupts-off sections:\n");
+  histogram_print (hist, TRACE_BUCKETS);
+
+  printf ("Longest interrupts-off sections (times in ns):\n");
+  printf ("%10s %10s %12s  %-10s  %-10s\n",
+          "max", "count", "total", "off at", "on at");
+  for (i = 0; i < pair_cnt && i < TRACE_TOP; i++)
+    {
+      /* Selection sort, by max. */
+      size_t longest = i;
+      struct trace_pair tmp;
+
+      for (j = i + 1; j < pair_cnt; j++)
+        if (pairs[j].max > pairs[longest].max)
+          longest = j;
+      tmp = pairs[i];
+      pairs[i] = pairs[longest];
+      pairs[longest] = tmp;
+
+      printf ("%10llu %10llu %12llu  %-10p  %-10p\n",
+              timer_cycles_to_ns (pairs[i].max), pairs[i].cnt,
+              timer_cycles_to_ns (pairs[i].total),
+              pairs[i].off_site, pairs[i].on_site);
+    }
+  if (trace_other.cnt > 0)
+    printf ("%10llu %10llu %12llu  (other call sites)\n",
+            timer_cycles_to_ns (trace_other.max), trace_other.cnt,
+            timer_cycles_to_ns (trace_other.total));
+}
+
+/* Returns the length of the longest interrupts-off section
+   recorded so far, in nanoseconds. */
+uint64_t
+intr_trace_max_ns (void)
+{
+  uint64_t max;
+  enum intr_level old_level;
+  size_t i;
+
+  old_level = intr_disable ();
+  max = trace_other.max;
+  for (i = 0; i < trace_pair_cnt; i++)
+    if (trace_pairs[i].max > max)
+      max = trace_pairs[i].max;
+  intr_set_level (old_level);
+
+  return timer_cycles_to_ns (max);
+}
+#endif /* INTRTRACE */
@@ -67,4 +67,47 @@ void intr_yield_on_return (void);
 void intr_dump_frame (const struct intr_frame *);
 const char *intr_name (uint8_t vec);
 
+/* Deferred interrupt work ("softirqs").
+
+   An external interrupt handler should do only what must be
+   done with interrupts off, such as acknowledging the device,
+   and raise a softirq for the rest.  Raised softirqs run just
+   before the interrupt returns, with interrupts on, so that
+   other interrupts can preempt them.  Like external interrupt
+   handlers, softirq handlers count as interrupt context: they
+   may not sleep, but they may call intr_yield_on_return().
+   Softirqs that keep being raised while they run are handed to
+   the "ksoftirqd" kernel thread, so that they cannot starve the
+   interrupted thread forever. */
+enum softirq
+  {
+    SOFTIRQ_TIMER,              /* Timer tick bookkeeping. */
+    SOFTIRQ_BLOCK,              /* Block device completions. */
+    SOFTIRQ_VGA,                /* Deferred VGA text drawing. */
+    SOFTIRQ_TEST,               /* Used by tests/threads/softirq. */
+    SOFTIRQ_CNT                 /* Number of softirqs. */
+  };
+
+struct thread;
+typedef void softirq_func (void);
+
+void softirq_init (void);
+void softirq_register (enum softirq, softirq_func *);
+void softirq_raise (enum softirq);
+bool softirq_is_ksoftirqd (const struct thread *);
+
+/* Interrupts-off latency tracer.
+   Building with -DINTRTRACE (add it to DEFINES in Make.vars)
+   times every stretch of code that runs with interrupts off,
+   from the intr_disable() or interrupt entry that turned them
+   off to the intr_enable(), intr_set_level() or interrupt
+   return that turned them back on.  intr_trace_print() reports
+   a histogram of their lengths and the pairs of call sites
+   with the longest ones, and intr_trace_max_ns() returns the
+   longest.  Without INTRTRACE none of this code is compiled. */
+#ifdef INTRTRACE
+void intr_trace_print (void);
+uint64_t intr_trace_max_ns (void);
+#endif
+
 #endif /* threads/interrupt.h */
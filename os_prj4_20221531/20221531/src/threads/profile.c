@@ -0,0 +1,279 @@
+#include "threads/profile.h"
+#include <debug.h>
+#include <stdio.h>
+#include <string.h>
+#include "devices/rtc.h"
+#include "devices/serial.h"
+#include "devices/timer.h"
+#include "threads/palloc.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+#ifdef USERPROG
+#include "userprog/gdt.h"
+#include "userprog/pagedir.h"
+#endif
+
+/* Return addresses recorded per sample, counting the
+   interrupted program counter. */
+#define PROFILE_DEPTH 8
+
+/* Pages of sample buffer. */
+#define PROFILE_PAGES 16
+
+/* Threads whose names are recorded for the dump. */
+#define PROFILE_THREADS 64
+
+/* Format of the dump, all little-endian:
+
+     struct profile_header, then
+     `thread_cnt' times { int32_t tid; char name[16]; }, then
+     `sample_cnt' times { int32_t tid; uint8_t flags; uint8_t depth;
+                          uint16_t reserved; uint32_t pc[depth]; }
+
+   pc[0] is the interrupted program counter and pc[1...] are the
+   return addresses of its callers, innermost first. */
+#define PROFILE_MAGIC 0x46525050        /* "PPRF". */
+#define PROFILE_VERSION 1
+#define PROFILE_USER 0x01               /* Sample flag: in user mode. */
+
+struct profile_header
+  {
+    uint32_t magic;             /* PROFILE_MAGIC. */
+    uint16_t version;           /* PROFILE_VERSION. */
+    uint16_t max_depth;         /* PROFILE_DEPTH. */
+    uint32_t hz;                /* Samples per second. */
+    uint32_t sample_cnt;        /* Number of samples that follow. */
+    uint32_t lost_cnt;          /* Older samples overwritten. */
+    uint32_t thread_cnt;        /* Number of thread names that follow. */
+  };
+
+/* One sample. */
+struct sample
+  {
+    tid_t tid;                  /* Interrupted thread. */
+    uint8_t flags;              /* PROFILE_USER or 0. */
+    uint8_t depth;              /* Number of valid entries in PC. */
+    uint32_t pc[PROFILE_DEPTH]; /* Program counter and callers. */
+  };
+
+/* A thread's name, saved when it is first sampled. */
+struct profile_thread
+  {
+    tid_t tid;
+    char name[16];
+  };
+
+static bool enabled;            /* Taking samples? */
+static bool use_timer;          /* Sampling on timer ticks? */
+static int sample_hz;           /* Samples per second. */
+
+/* Ring buffer of samples. */
+static struct sample *samples;
+static size_t sample_max;       /* Capacity. */
+static size_t sample_head;      /* Index of next sample to write. */
+static unsigned long long sample_cnt;   /* Samples taken in all. */
+
+static struct profile_thread threads[PROFILE_THREADS];
+static size_t thread_cnt;
+
+static void sample (struct intr_frame *);
+static size_t walk_kernel (const struct intr_frame *, uint32_t *pc);
+#ifdef USERPROG
+static size_t walk_user (const struct intr_frame *, uint32_t *pc);
+#endif
+static void remember_thread (struct thread *);
+static void put_bytes (const void *, size_t);
+
+/* Starts profiling.  With HZ of 0, samples on every timer tick;
+   otherwise, samples HZ times a second using the RTC's periodic
+   interrupt, in which case HZ must be a power of 2 between 2
+   and 8192.  Must be called after the page allocator and the
+   interrupt system have been initialized. */
+void
+profile_init (int hz)
+{
+  samples = palloc_get_multiple (0, PROFILE_PAGES);
+  if (samples == NULL)
+    {
+      printf ("profile: out of memory, profiling disabled\n");
+      return;
+    }
+  sample_max = PROFILE_PAGES * PGSIZE / sizeof *samples;
+
+  if (hz == 0)
+    {
+      use_timer = true;
+      sample_hz = TIMER_FREQ;
+    }
+  else if (rtc_periodic_start (hz, sample))
+    sample_hz = hz;
+  else
+    PANIC ("-profile=%d: rate must be a power of 2 from 2 to 8192", hz);
+  enabled = true;
+  printf ("profile: sampling %d times a second, %zu samples kept\n",
+          sample_hz, sample_max);
+}
+
+/* Called by the timer interrupt handler on every tick. */
+void
+profile_tick (struct intr_frame *f)
+{
+  if (use_timer)
+    sample (f);
+}
+
+/* Records a sample of the code interrupted by F. */
+static void
+sample (struct intr_frame *f)
+{
+  struct thread *t = thread_current ();
+  struct sample *s;
+
+  if (!enabled)
+    return;
+
+  s = &samples[sample_head];
+  sample_head = (sample_head + 1) % sample_max;
+  sample_cnt++;
+
+  s->tid = t->tid;
+  s->flags = 0;
+#ifdef USERPROG
+  if (f->cs == SEL_UCSEG)
+    {
+      s->flags = PROFILE_USER;
+      s->depth = walk_user (f, s->pc);
+    }
+  else
+#endif
+    s->depth = walk_kernel (f, s->pc);
+
+  remember_thread (t);
+}
+
+/* Stores the program counter interrupted by kernel-mode frame F
+   and the return addresses of its callers into PC.  Returns the
+   number stored.  Only frame pointers within the thread's own
+   stack page are followed. */
+static size_t
+walk_kernel (const struct intr_frame *f, uint32_t *pc)
+{
+  uint32_t *frame = (uint32_t *) f->ebp;
+  uint8_t *stack_top = pg_round_down (f) + PGSIZE;
+  size_t depth = 0;
+
+  pc[depth++] = (uint32_t) f->eip;
+  while (depth < PROFILE_DEPTH
+         && (uint8_t *) frame > (uint8_t *) f
+         && (uint8_t *) (frame + 2) <= stack_top)
+    {
+      uint32_t *next = (uint32_t *) frame[0];
+      pc[depth++] = frame[1];
+      if (next <= frame)
+        break;
+      frame = next;
+    }
+  return depth;
+}
+
+#ifdef USERPROG
+/* Like walk_kernel(), but for user-mode frame F.  Only frame
+   pointers into mapped user pages are followed, since a page
+   fault here would be fatal. */
+static size_t
+walk_user (const struct intr_frame *f, uint32_t *pc)
+{
+  uint32_t *pd = thread_current ()->pagedir;
+  uint32_t *frame = (uint32_t *) f->ebp;
+  size_t depth = 0;
+
+  pc[depth++] = (uint32_t) f->eip;
+  while (depth < PROFILE_DEPTH
+         && is_user_vaddr (frame + 2)
+         && (uintptr_t) frame % sizeof *frame == 0
+         && pagedir_get_page (pd, frame) != NULL
+         && pagedir_get_page (pd, frame + 1) != NULL)
+    {
+      uint32_t *next = (uint32_t *) frame[0];
+      pc[depth++] = frame[1];
+      if (next <= frame)
+        break;
+      frame = next;
+    }
+  return depth;
+}
+#endif
+
+/* Saves T's name if this is the first sample of T. */
+static void
+remember_thread (struct thread *t)
+{
+  size_t i;
+
+  for (i = 0; i < thread_cnt; i++)
+    if (threads[i].tid == t->tid)
+      return;
+  if (thread_cnt < PROFILE_THREADS)
+    {
+      threads[thread_cnt].tid = t->tid;
+      strlcpy (threads[thread_cnt].name, t->name, sizeof threads->name);
+      thread_cnt++;
+    }
+}
+
+/* Stops profiling and writes the samples to the serial port, in
+   the format described at the top of this file.  Nothing else
+   should be writing to the console meanwhile. */
+void
+profile_dump (void)
+{
+  struct profile_header h;
+  size_t cnt, first, i;
+
+  if (!enabled)
+    return;
+  enabled = false;
+
+  cnt = sample_cnt < sample_max ? sample_cnt : sample_max;
+  first = sample_cnt < sample_max ? 0 : sample_head;
+
+  printf ("profile: %llu samples taken, dumping %zu\n", sample_cnt, cnt);
+  h.magic = PROFILE_MAGIC;
+  h.version = PROFILE_VERSION;
+  h.max_depth = PROFILE_DEPTH;
+  h.hz = sample_hz;
+  h.sample_cnt = cnt;
+  h.lost_cnt = sample_cnt - cnt;
+  h.thread_cnt = thread_cnt;
+  put_bytes (&h, sizeof h);
+
+  for (i = 0; i < thread_cnt; i++)
+    {
+      put_bytes (&threads[i].tid, sizeof threads[i].tid);
+      put_bytes (threads[i].name, sizeof threads[i].name);
+    }
+
+  for (i = 0; i < cnt; i++)
+    {
+      const struct sample *s = &samples[(first + i) % sample_max];
+      uint16_t reserved = 0;
+
+      put_bytes (&s->tid, sizeof s->tid);
+      put_bytes (&s->flags, 1);
+      put_bytes (&s->depth, 1);
+      put_bytes (&reserved, sizeof reserved);
+      put_bytes (s->pc, s->depth * sizeof *s->pc);
+    }
+  serial_flush ();
+  printf ("\n");
+}
+
+/* Writes SIZE bytes from BUF to the serial port only. */
+static void
+put_bytes (const void *buf_, size_t size)
+{
+  const uint8_t *buf = buf_;
+
+  while (size-- > 0)
+    serial_putc (*buf++);
+}
@@ -0,0 +1,21 @@
+#ifndef THREADS_PROFILE_H
+#define THREADS_PROFILE_H
+
+#include <stdbool.h>
+#include "threads/interrupt.h"
+
+/* Sampling profiler.
+
+   When enabled with -profile, each sample records the thread
+   and the program counter interrupted by a clock interrupt,
+   plus as much of the call chain as the frame pointers reveal,
+   into a ring buffer that keeps the most recent samples.  At
+   shutdown the buffer is written to the serial port in binary;
+   utils/pintos-profile turns it into a flat profile or folded
+   stacks. */
+
+void profile_init (int hz);
+void profile_tick (struct intr_frame *);
+void profile_dump (void);
+
+#endif /* threads/profile.h */
@@ -0,0 +1,109 @@
+#include "threads/spinlock.h"
+#include <debug.h>
+#include <stddef.h>
+#include "threads/cpu.h"
+
+/* Atomically stores NEW into *P and returns the old value.
+   See [IA32-v2b] "XCHG".
+
+   Without SMP only one CPU ever touches a spinlock, always with
+   interrupts off, so a plain load and store suffice. */
+static inline unsigned
+atomic_xchg (volatile unsigned *p, unsigned new)
+{
+#ifdef SMP
+  asm volatile ("lock; xchgl %0, %1"
+                : "+m" (*p), "+r" (new)
+                :
+                : "memory", "cc");
+  return new;
+#else
+  unsigned old = *p;
+  *p = new;
+  return old;
+#endif
+}
+
+/* Initializes LOCK as an unheld spinlock named NAME. */
+void
+spinlock_init (struct spinlock *lock, const char *name)
+{
+  ASSERT (lock != NULL);
+
+  lock->locked = 0;
+  lock->cpu = NULL;
+  lock->name = name;
+}
+
+/* Acquires LOCK, spinning until it becomes available.
+   Disables interrupts on the local CPU and returns the previous
+   interrupt level, which must be passed to spinlock_release().
+   The lock must not already be held by this CPU. */
+enum intr_level
+spinlock_acquire (struct spinlock *lock)
+{
+  enum intr_level old_level;
+
+  ASSERT (lock != NULL);
+
+  old_level = intr_disable ();
+  ASSERT (!spinlock_held_by_current_cpu (lock));
+
+#ifndef SMP
+  /* Nobody else can hold it. */
+  ASSERT (!lock->locked);
+#endif
+  while (atomic_xchg (&lock->locked, 1) != 0)
+    {
+      /* Spin on a plain read, so that waiting CPUs do not keep
+         stealing the cache line from the holder.  See
+         [IA32-v2b] "PAUSE". */
+      while (lock->locked)
+        asm volatile ("pause" : : : "memory");
+    }
+  lock->cpu = cpu_current ();
+  return old_level;
+}
+
+/* Tries to acquire LOCK without spinning.  On success, stores the
+   previous interrupt level into *OLD_LEVEL and returns true with
+   interrupts disabled.  On failure, returns false with the
+   interrupt level unchanged. */
+bool
+spinlock_try_acquire (struct spinlock *lock, enum intr_level *old_level)
+{
+  ASSERT (lock != NULL);
+  ASSERT (old_level != NULL);
+
+  *old_level = intr_disable ();
+  if (atomic_xchg (&lock->locked, 1) != 0)
+    {
+      intr_set_level (*old_level);
+      return false;
+    }
+  lock->cpu = cpu_current ();
+  return true;
+}
+
+/* Releases LOCK, which must be held by this CPU, and restores
+   the interrupt level OLD_LEVEL returned by spinlock_acquire(). */
+void
+spinlock_release (struct spinlock *lock, enum intr_level old_level)
+{
+  ASSERT (spinlock_held_by_current_cpu (lock));
+
+  lock->cpu = NULL;
+  atomic_xchg (&lock->locked, 0);
+  intr_set_level (old_level);
+}
+
+/* Returns true if this CPU holds LOCK.  Interrupts must be off,
+   or the answer could be stale by the time it is used. */
+bool
+spinlock_held_by_current_cpu (const struct spinlock *lock)
+{
+  ASSERT (lock != NULL);
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  return lock->locked && lock->cpu == cpu_current ();
+}
@@ -0,0 +1,36 @@
+#ifndef THREADS_SPINLOCK_H
+#define THREADS_SPINLOCK_H
+
+#include <stdbool.h>
+#include "threads/interrupt.h"
+
+struct cpu;
+
+/* Spin lock, for data that may be touched by more than one CPU.
+
+   Unlike `struct lock', a spinlock never sleeps, so it may be
+   taken with interrupts off and from interrupt handlers.
+   Acquiring a spinlock also disables interrupts on the local
+   CPU, so that an interrupt handler can never spin on a lock its
+   own CPU already holds.  Hold spinlocks only for short, bounded
+   stretches of code.
+
+   Only the bootstrap processor runs today (see threads/cpu.c), so
+   unless the kernel is built with -DSMP a spinlock is just an
+   interrupt-disabled section plus the bookkeeping that lets
+   spinlock_held_by_current_cpu() check its users; it takes no
+   bus-locked instructions and never spins. */
+struct spinlock
+  {
+    volatile unsigned locked;   /* Nonzero while held. */
+    struct cpu *cpu;            /* CPU holding the lock (for debugging). */
+    const char *name;           /* Name (for debugging). */
+  };
+
+void spinlock_init (struct spinlock *, const char *name);
+enum intr_level spinlock_acquire (struct spinlock *);
+bool spinlock_try_acquire (struct spinlock *, enum intr_level *);
+void spinlock_release (struct spinlock *, enum intr_level);
+bool spinlock_held_by_current_cpu (const struct spinlock *);
+
+#endif /* threads/spinlock.h */
@@ -27,10 +27,187 @@
 */
 
 #include "threads/synch.h"
+#include <lockstat.h>
 #include <stdio.h>
 #include <string.h>
+#include "threads/cpu.h"
 #include "threads/interrupt.h"
 #include "threads/thread.h"
+#include "devices/timer.h"
+
+/* Wait queues. */
+
+/* Arrival counter, used to keep equal-priority waiters FIFO. */
+static unsigned wait_seq;
+
+static void wait_queue_init (struct wait_queue *);
+static void wait_queue_push (struct wait_queue *, struct wait_elem *);
+static struct thread *wait_queue_pop (struct wait_queue *);
+
+/* Returns true if waiter A should be woken before waiter B:
+   higher priority first, then earlier arrival. */
+static bool
+wait_elem_before (const struct wait_elem *a, const struct wait_elem *b)
+{
+  if (a->thread->priority != b->thread->priority)
+    return a->thread->priority > b->thread->priority;
+  return (int) (a->seq - b->seq) < 0;
+}
+
+/* Links heaps A and B together and returns the new root. */
+static struct wait_elem *
+wait_heap_meld (struct wait_elem *a, struct wait_elem *b)
+{
+  struct wait_elem *t;
+
+  if (a == NULL)
+    return b;
+  if (b == NULL)
+    return a;
+  if (wait_elem_before (b, a))
+    {
+      t = a;
+      a = b;
+      b = t;
+    }
+
+  /* Make B the leftmost child of A. */
+  b->prev = a;
+  b->sibling = a->child;
+  if (a->child != NULL)
+    a->child->prev = b;
+  a->child = b;
+  a->sibling = NULL;
+  a->prev = NULL;
+  return a;
+}
+
+/* Combines the sibling list starting at FIRST into a single heap
+   with the usual two-pass pairing.  Iterative, so that it does
+   not eat kernel stack no matter how many waiters there are. */
+static struct wait_elem *
+wait_heap_merge_pairs (struct wait_elem *first)
+{
+  struct wait_elem *pairs = NULL;
+  struct wait_elem *result = NULL;
+
+  /* Left to right: meld adjacent pairs, stacking the results
+     through their `sibling' pointers. */
+  while (first != NULL)
+    {
+      struct wait_elem *a = first;
+      struct wait_elem *b = a->sibling;
+      struct wait_elem *m;
+
+      first = b != NULL ? b->sibling : NULL;
+      a->sibling = a->prev = NULL;
+      if (b != NULL)
+        b->sibling = b->prev = NULL;
+      m = wait_heap_meld (a, b);
+      m->sibling = pairs;
+      pairs = m;
+    }
+
+  /* Right to left: meld the pairs into one heap. */
+  while (pairs != NULL)
+    {
+      struct wait_elem *next = pairs->sibling;
+      pairs->sibling = NULL;
+      result = wait_heap_meld (result, pairs);
+      pairs = next;
+    }
+  return result;
+}
+
+/* Initializes Q as an empty wait queue. */
+static void
+wait_queue_init (struct wait_queue *q)
+{
+  q->root = NULL;
+  q->size = 0;
+}
+
+/* Adds the current thread to Q using E as its queue entry.
+   Interrupts must be off. */
+static void
+wait_queue_push (struct wait_queue *q, struct wait_elem *e)
+{
+  struct thread *t = thread_current ();
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  e->thread = t;
+  e->seq = wait_seq++;
+  e->queue = q;
+  e->child = e->sibling = e->prev = NULL;
+  list_push_back (&t->wait_list, &e->thread_elem);
+
+  q->root = wait_heap_meld (q->root, e);
+  q->size++;
+}
+
+/* Unlinks E from its queue's heap, leaving the queue otherwise
+   intact.  E's own `queue' and thread links are not touched. */
+static void
+wait_heap_remove (struct wait_elem *e)
+{
+  struct wait_queue *q = e->queue;
+
+  if (e == q->root)
+    q->root = wait_heap_merge_pairs (e->child);
+  else
+    {
+      /* Cut E out of its parent's child list... */
+      if (e->prev->child == e)
+        e->prev->child = e->sibling;
+      else
+        e->prev->sibling = e->sibling;
+      if (e->sibling != NULL)
+        e->sibling->prev = e->prev;
+
+      /* ...and put its children back. */
+      q->root = wait_heap_meld (q->root, wait_heap_merge_pairs (e->child));
+    }
+  e->child = e->sibling = e->prev = NULL;
+}
+
+/* Removes the highest-priority waiter from Q and returns its
+   thread, or returns a null pointer if Q is empty.  Interrupts
+   must be off. */
+static struct thread *
+wait_queue_pop (struct wait_queue *q)
+{
+  struct wait_elem *e = q->root;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  if (e == NULL)
+    return NULL;
+  wait_heap_remove (e);
+  list_remove (&e->thread_elem);
+  e->queue = NULL;
+  q->size--;
+  return e->thread;
+}
+
+/* Repositions every queue entry of thread T after T's priority
+   has changed, e.g. through aging or the MLFQS recalculation.
+   Interrupts must be off. */
+void
+wait_queue_reprioritize (struct thread *t)
+{
+  struct list_elem *le;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  for (le = list_begin (&t->wait_list); le != list_end (&t->wait_list);
+       le = list_next (le))
+    {
+      struct wait_elem *e = list_entry (le, struct wait_elem, thread_elem);
+      wait_heap_remove (e);
+      e->queue->root = wait_heap_meld (e->queue->root, e);
+    }
+}
 
 /* Initializes semaphore SEMA to VALUE.  A semaphore is a
    nonnegative integer along with two atomic operators for
@@ -47,7 +224,7 @@ sema_init (struct semaphore *sema, unsigned value)
   ASSERT (sema != NULL);
 
   sema->value = value;
-  list_init (&sema->waiters);
+  wait_queue_init (&sema->waiters);
 }
 
 /* Down or "P" operation on a semaphore.  Waits for SEMA's value
@@ -61,6 +238,7 @@ void
 sema_down (struct semaphore *sema) 
 {
   enum intr_level old_level;
+  struct wait_elem waiter;
 
   ASSERT (sema != NULL);
   ASSERT (!intr_context ());
@@ -68,7 +246,7 @@ sema_down (struct semaphore *sema)
   old_level = intr_disable ();
   while (sema->value == 0) 
     {
-      list_push_back (&sema->waiters, &thread_current ()->elem);
+      wait_queue_push (&sema->waiters, &waiter);
       thread_block ();
     }
   sema->value--;
@@ -113,29 +291,8 @@ sema_up (struct semaphore *sema)
   ASSERT (sema != NULL);
 
   old_level = intr_disable ();
-  if (!list_empty (&sema->waiters)) 
-  //  thread_unblock (list_entry (list_pop_front (&sema->waiters),
-  //                              struct thread, elem));
-  {
-// (새 코드: waiters 리스트를 순회하며 가장 높은 우선순위의 스레드를 찾아 깨움)
-    struct list_elem *e;
-    struct thread *best_thread = NULL;
-    int max_priority = -1;
-
-    
-    for (e = list_begin(&sema->waiters); e != list_end(&sema->waiters); e = list_next(e)) {
-      struct thread *t = list_entry(e, struct thread, elem);
-      if (t->priority > max_priority) {
-        max_priority = t->priority;
-        best_thread = t;
-      }
-    }
-
-    if (best_thread != NULL) {
-      list_remove(&best_thread->elem);
-      thread_unblock(best_thread);
-    }
-  }
+  if (sema->waiters.size > 0)
+    thread_unblock (wait_queue_pop (&sema->waiters));
   sema->value++;
   intr_set_level (old_level);
 
@@ -195,14 +352,250 @@ sema_test_helper (void *sema_)
    onerous, it's a good sign that a semaphore should be used,
    instead of a lock. */
 void
-lock_init (struct lock *lock)
+(lock_init) (struct lock *lock)
 {
   ASSERT (lock != NULL);
 
   lock->holder = NULL;
   sema_init (&lock->semaphore, 1);
+#ifdef LOCKSTAT
+  lock->class = NULL;
+#endif
 }
 
+#ifdef LOCKSTAT
+/* Most lock classes tracked.  Further classes share one
+   catch-all class. */
+#define LOCKSTAT_CLASSES 64
+
+/* A call site that waited for a lock. */
+struct lock_site
+  {
+    void *pc;                   /* Return address of lock_acquire(). */
+    unsigned long long cnt;     /* # of contended acquisitions. */
+    uint64_t wait;              /* Total cycles waited. */
+  };
+
+/* Statistics shared by the locks initialized by the same
+   lock_init() expression in the same file.  Times are in CPU
+   cycles, converted to nanoseconds when printed. */
+struct lock_class
+  {
+    const char *name;           /* Expression passed to lock_init(). */
+    const char *file;           /* Source file of the lock_init(). */
+    unsigned long long acquired;        /* # of acquisitions. */
+    unsigned long long contended;       /* # that had to wait. */
+    uint64_t wait_total, wait_max;      /* Time spent waiting. */
+    uint64_t hold_total, hold_max;      /* Time spent holding. */
+    struct lock_site sites[LOCKSTAT_SITES]; /* Longest waiting sites. */
+  };
+
+static struct lock_class lock_classes[LOCKSTAT_CLASSES];
+static size_t lock_class_cnt;
+static struct lock_class other_class = { .name = "(other locks)", .file = "" };
+
+/* Initializes LOCK, like lock_init(), and attaches it to the
+   statistics class for NAME in FILE. */
+void
+lockstat_init (struct lock *lock, const char *name, const char *file)
+{
+  struct lock_class *class = NULL;
+  enum intr_level old_level;
+  size_t i;
+
+  (lock_init) (lock);
+
+  /* Strip "../" from paths relative to the build directory and
+     "&" from the lock expression. */
+  while (!memcmp (file, "../", 3))
+    file += 3;
+  if (*name == '&')
+    name++;
+
+  old_level = intr_disable ();
+  for (i = 0; i < lock_class_cnt; i++)
+    if (!strcmp (lock_classes[i].name, name)
+        && !strcmp (lock_classes[i].file, file))
+      {
+        class = &lock_classes[i];
+        break;
+      }
+  if (class == NULL)
+    {
+      if (lock_class_cnt < LOCKSTAT_CLASSES)
+        {
+          class = &lock_classes[lock_class_cnt++];
+          class->name = name;
+          class->file = file;
+        }
+      else
+        class = &other_class;
+    }
+  intr_set_level (old_level);
+
+  lock->class = class;
+}
+
+/* Records that the current thread got LOCK, after waiting WAIT
+   cycles from call site PC if CONTENDED. */
+static void
+lockstat_acquired (struct lock *lock, bool contended, uint64_t wait, void *pc)
+{
+  struct lock_class *class = lock->class;
+  enum intr_level old_level;
+
+  lock->acquired_at = timer_cycles ();
+  if (class == NULL)
+    return;
+
+  old_level = intr_disable ();
+  class->acquired++;
+  if (contended)
+    {
+      struct lock_site *site = NULL;
+      size_t i;
+
+      class->contended++;
+      class->wait_total += wait;
+      if (wait > class->wait_max)
+        class->wait_max = wait;
+
+      /* Find PC's slot, or replace the site that has waited
+         least. */
+      for (i = 0; i < LOCKSTAT_SITES; i++)
+        {
+          struct lock_site *s = &class->sites[i];
+          if (s->pc == pc)
+            {
+              site = s;
+              break;
+            }
+          if (site == NULL || s->wait < site->wait)
+            site = s;
+        }
+      if (site->pc != pc)
+        {
+          site->pc = pc;
+          site->cnt = 0;
+          site->wait = 0;
+        }
+      site->cnt++;
+      site->wait += wait;
+    }
+  intr_set_level (old_level);
+}
+
+/* Records that the current thread is releasing LOCK. */
+static void
+lockstat_released (struct lock *lock)
+{
+  struct lock_class *class = lock->class;
+  uint64_t hold = timer_cycles () - lock->acquired_at;
+  enum intr_level old_level;
+
+  if (class == NULL)
+    return;
+
+  old_level = intr_disable ();
+  class->hold_total += hold;
+  if (hold > class->hold_max)
+    class->hold_max = hold;
+  intr_set_level (old_level);
+}
+
+/* Clears the statistics of CLASS. */
+static void
+reset_lock_class (struct lock_class *class)
+{
+  const char *name = class->name;
+  const char *file = class->file;
+
+  memset (class, 0, sizeof *class);
+  class->name = name;
+  class->file = file;
+}
+
+/* Prints the statistics of one lock class. */
+static void
+print_lock_class (struct lock_class *class, bool reset)
+{
+  size_t i;
+
+  if (class->acquired == 0)
+    return;
+  printf ("%-24s %-22s %10llu %9llu %12llu %10llu %12llu %10llu\n",
+          class->name, class->file, class->acquired, class->contended,
+          timer_cycles_to_ns (class->wait_total),
+          timer_cycles_to_ns (class->wait_max),
+          timer_cycles_to_ns (class->hold_total),
+          timer_cycles_to_ns (class->hold_max));
+  for (i = 0; i < LOCKSTAT_SITES; i++)
+    if (class->sites[i].cnt > 0)
+      printf ("  waited at %p: %llu times, %llu ns\n",
+              class->sites[i].pc, class->sites[i].cnt,
+              timer_cycles_to_ns (class->sites[i].wait));
+
+  if (reset)
+    reset_lock_class (class);
+}
+
+/* Prints statistics for every lock class that has been
+   acquired, then clears them if RESET.  Call sites are return
+   addresses; pass them to the `backtrace' utility to get source
+   lines.  Returns the number of lock classes. */
+int
+lockstat_print (bool reset)
+{
+  size_t i;
+
+  printf ("Lock statistics (times in ns):\n");
+  printf ("%-24s %-22s %10s %9s %12s %10s %12s %10s\n",
+          "lock", "file", "acquired", "contended",
+          "wait total", "wait max", "hold total", "hold max");
+  for (i = 0; i < lock_class_cnt; i++)
+    print_lock_class (&lock_classes[i], reset);
+  print_lock_class (&other_class, reset);
+  return lock_class_cnt;
+}
+
+/* Stores the statistics of lock class IDX in *OUT, then clears
+   them if RESET.  Classes are numbered in the order their first
+   lock was initialized; the one after the last is the catch-all
+   class.  Returns false if there is no class IDX. */
+bool
+lockstat_get (int idx, struct lockstat *out, bool reset)
+{
+  struct lock_class *class;
+  enum intr_level old_level;
+  size_t i;
+
+  if (idx < 0 || (size_t) idx > lock_class_cnt)
+    return false;
+  class = (size_t) idx < lock_class_cnt ? &lock_classes[idx] : &other_class;
+
+  memset (out, 0, sizeof *out);
+  old_level = intr_disable ();
+  strlcpy (out->name, class->name, sizeof out->name);
+  strlcpy (out->file, class->file, sizeof out->file);
+  out->acquired = class->acquired;
+  out->contended = class->contended;
+  out->wait_total_ns = timer_cycles_to_ns (class->wait_total);
+  out->wait_max_ns = timer_cycles_to_ns (class->wait_max);
+  out->hold_total_ns = timer_cycles_to_ns (class->hold_total);
+  out->hold_max_ns = timer_cycles_to_ns (class->hold_max);
+  for (i = 0; i < LOCKSTAT_SITES; i++)
+    {
+      out->sites[i].pc = (uint32_t) class->sites[i].pc;
+      out->sites[i].cnt = class->sites[i].cnt;
+      out->sites[i].wait_ns = timer_cycles_to_ns (class->sites[i].wait);
+    }
+  if (reset)
+    reset_lock_class (class);
+  intr_set_level (old_level);
+  return true;
+}
+#endif /* LOCKSTAT */
+
 /* Acquires LOCK, sleeping until it becomes available if
    necessary.  The lock must not already be held by the current
    thread.
@@ -223,7 +616,19 @@ lock_acquire (struct lock *lock)
   }
   ASSERT (!lock_held_by_current_thread (lock));
 
+#ifdef LOCKSTAT
+  if (sema_try_down (&lock->semaphore))
+    lockstat_acquired (lock, false, 0, NULL);
+  else
+    {
+      uint64_t start = timer_cycles ();
+      sema_down (&lock->semaphore);
+      lockstat_acquired (lock, true, timer_cycles () - start,
+                         __builtin_return_address (0));
+    }
+#else
   sema_down (&lock->semaphore);
+#endif
   lock->holder = thread_current ();
 }
 
@@ -243,7 +648,12 @@ lock_try_acquire (struct lock *lock)
 
   success = sema_try_down (&lock->semaphore);
   if (success)
-    lock->holder = thread_current ();
+    {
+      lock->holder = thread_current ();
+#ifdef LOCKSTAT
+      lockstat_acquired (lock, false, 0, NULL);
+#endif
+    }
   return success;
 }
 
@@ -258,6 +668,9 @@ lock_release (struct lock *lock)
   ASSERT (lock != NULL);
   ASSERT (lock_held_by_current_thread (lock));
 
+#ifdef LOCKSTAT
+  lockstat_released (lock);
+#endif
   lock->holder = NULL;
   sema_up (&lock->semaphore);
 }
@@ -273,10 +686,10 @@ lock_held_by_current_thread (const struct lock *lock)
   return lock->holder == thread_current ();
 }
 
-/* One semaphore in a list. */
+/* One semaphore in a condition's wait queue. */
 struct semaphore_elem 
   {
-    struct list_elem elem;              /* List element. */
+    struct wait_elem elem;              /* Wait queue element. */
     struct semaphore semaphore;         /* This semaphore. */
   };
 
@@ -288,7 +701,7 @@ cond_init (struct condition *cond)
 {
   ASSERT (cond != NULL);
 
-  list_init (&cond->waiters);
+  wait_queue_init (&cond->waiters);
 }
 
 /* Atomically releases LOCK and waits for COND to be signaled by
@@ -315,6 +728,7 @@ void
 cond_wait (struct condition *cond, struct lock *lock) 
 {
   struct semaphore_elem waiter;
+  enum intr_level old_level;
 
   ASSERT (cond != NULL);
   ASSERT (lock != NULL);
@@ -322,7 +736,9 @@ cond_wait (struct condition *cond, struct lock *lock)
   ASSERT (lock_held_by_current_thread (lock));
   
   sema_init (&waiter.semaphore, 0);
-  list_push_back (&cond->waiters, &waiter.elem);
+  old_level = intr_disable ();
+  wait_queue_push (&cond->waiters, &waiter.elem);
+  intr_set_level (old_level);
   lock_release (lock);
   sema_down (&waiter.semaphore);
   lock_acquire (lock);
@@ -338,14 +754,24 @@ cond_wait (struct condition *cond, struct lock *lock)
 void
 cond_signal (struct condition *cond, struct lock *lock UNUSED) 
 {
+  struct wait_elem *e;
+  enum intr_level old_level;
+
   ASSERT (cond != NULL);
   ASSERT (lock != NULL);
   ASSERT (!intr_context ());
   ASSERT (lock_held_by_current_thread (lock));
 
-  if (!list_empty (&cond->waiters)) 
-    sema_up (&list_entry (list_pop_front (&cond->waiters),
-                          struct semaphore_elem, elem)->semaphore);
+  /* The waiter's priority may be changed from the timer
+     interrupt, which touches this queue, so keep it out. */
+  old_level = intr_disable ();
+  e = cond->waiters.root;
+  if (e != NULL)
+    wait_queue_pop (&cond->waiters);
+  intr_set_level (old_level);
+
+  if (e != NULL)
+    sema_up (&wait_entry (e, struct semaphore_elem, elem)->semaphore);
 }
 
 /* Wakes up all threads, if any, waiting on COND (protected by
@@ -360,6 +786,285 @@ cond_broadcast (struct condition *cond, struct lock *lock)
   ASSERT (cond != NULL);
   ASSERT (lock != NULL);
 
-  while (!list_empty (&cond->waiters))
+  while (cond->waiters.size > 0)
     cond_signal (cond, lock);
 }
+
+/* Number of times adaptive_lock_acquire() polls a running holder
+   before going to sleep. */
+#define ADAPTIVE_SPIN_LIMIT 1000
+
+/* Initializes adaptive lock LOCK. */
+void
+adaptive_lock_init (struct adaptive_lock *lock)
+{
+  ASSERT (lock != NULL);
+
+  lock_init (&lock->lock);
+  lock->spin_cnt = lock->sleep_cnt = 0;
+}
+
+/* Returns true if thread T is running right now on some other
+   CPU.  The answer may be stale by the time it is used. */
+static bool
+running_elsewhere (const struct thread *t)
+{
+  return (t != NULL && t->status == THREAD_RUNNING
+          && t->cpu != cpu_current ());
+}
+
+/* Acquires LOCK.  If the lock is held by a thread that is running
+   on another CPU, polls for up to ADAPTIVE_SPIN_LIMIT iterations
+   for it to be released before sleeping as lock_acquire() does.
+   With only one CPU the holder is never running while we are, so
+   this always sleeps at once.
+
+   The same restrictions apply as to lock_acquire(). */
+void
+adaptive_lock_acquire (struct adaptive_lock *lock)
+{
+  int spins;
+
+  ASSERT (lock != NULL);
+  ASSERT (!intr_context ());
+  ASSERT (!adaptive_lock_held_by_current_thread (lock));
+
+  for (spins = 0; spins < ADAPTIVE_SPIN_LIMIT; spins++)
+    {
+      if (lock_try_acquire (&lock->lock))
+        {
+          lock->spin_cnt++;
+          return;
+        }
+      if (!running_elsewhere (lock->lock.holder))
+        break;
+      asm volatile ("pause" : : : "memory");
+    }
+
+  lock_acquire (&lock->lock);
+  lock->sleep_cnt++;
+}
+
+/* Tries to acquire LOCK without sleeping or polling.  Returns
+   true if successful. */
+bool
+adaptive_lock_try_acquire (struct adaptive_lock *lock)
+{
+  ASSERT (lock != NULL);
+
+  return lock_try_acquire (&lock->lock);
+}
+
+/* Releases LOCK, which must be owned by the current thread. */
+void
+adaptive_lock_release (struct adaptive_lock *lock)
+{
+  ASSERT (lock != NULL);
+
+  lock_release (&lock->lock);
+}
+
+/* Returns true if the current thread holds LOCK. */
+bool
+adaptive_lock_held_by_current_thread (const struct adaptive_lock *lock)
+{
+  ASSERT (lock != NULL);
+
+  return lock_held_by_current_thread (&lock->lock);
+}
+
+/* Returns the priority of the first waiter in Q, or PRI_MIN - 1
+   if Q is empty. */
+static int
+wait_queue_top_priority (const struct wait_queue *q)
+{
+  return q->root != NULL ? q->root->thread->priority : PRI_MIN - 1;
+}
+
+/* Initializes readers-writer lock RW, initially not held. */
+void
+rwlock_init (struct rwlock *rw)
+{
+  ASSERT (rw != NULL);
+
+  rw->readers = 0;
+  rw->writer = NULL;
+  wait_queue_init (&rw->read_waiters);
+  wait_queue_init (&rw->write_waiters);
+}
+
+/* Returns true if the current thread, wanting to read, may take
+   RW now: no writer holds it and no writer of at least our
+   priority is waiting for it.  Interrupts must be off. */
+static bool
+rwlock_can_read (const struct rwlock *rw)
+{
+  return (rw->writer == NULL
+          && (wait_queue_top_priority (&rw->write_waiters)
+              < thread_current ()->priority));
+}
+
+/* Hands RW to waiters after it has been released by its writer
+   or its last reader.  If the best waiting writer is at least as
+   urgent as the best waiting reader, and RW is now free, it gets
+   RW; otherwise every reader more urgent than the best waiting
+   writer gets it.  Woken threads already own RW when they run,
+   so no one can slip in ahead of them.  Interrupts must be
+   off. */
+static void
+rwlock_grant (struct rwlock *rw)
+{
+  int writer_pri = wait_queue_top_priority (&rw->write_waiters);
+
+  ASSERT (intr_get_level () == INTR_OFF);
+  ASSERT (rw->writer == NULL);
+
+  if (rw->write_waiters.size > 0
+      && writer_pri >= wait_queue_top_priority (&rw->read_waiters))
+    {
+      if (rw->readers == 0)
+        {
+          rw->writer = wait_queue_pop (&rw->write_waiters);
+          thread_unblock (rw->writer);
+        }
+      return;
+    }
+
+  while (rw->read_waiters.size > 0
+         && wait_queue_top_priority (&rw->read_waiters) > writer_pri)
+    {
+      rw->readers++;
+      thread_unblock (wait_queue_pop (&rw->read_waiters));
+    }
+}
+
+/* Acquires RW for reading, sleeping until it is available if
+   necessary.
+
+   This function may sleep, so it must not be called within an
+   interrupt handler. */
+void
+rwlock_acquire_read (struct rwlock *rw)
+{
+  enum intr_level old_level;
+
+  ASSERT (rw != NULL);
+  ASSERT (!intr_context ());
+  ASSERT (!rwlock_held_by_current_thread (rw));
+
+  old_level = intr_disable ();
+  if (rwlock_can_read (rw))
+    rw->readers++;
+  else
+    {
+      struct wait_elem waiter;
+      wait_queue_push (&rw->read_waiters, &waiter);
+      thread_block ();
+    }
+  intr_set_level (old_level);
+}
+
+/* Acquires RW for writing, sleeping until it is available if
+   necessary.  The lock must not already be held by the current
+   thread.
+
+   This function may sleep, so it must not be called within an
+   interrupt handler. */
+void
+rwlock_acquire_write (struct rwlock *rw)
+{
+  enum intr_level old_level;
+
+  ASSERT (rw != NULL);
+  ASSERT (!intr_context ());
+  ASSERT (!rwlock_held_by_current_thread (rw));
+
+  old_level = intr_disable ();
+  if (rw->writer == NULL && rw->readers == 0)
+    rw->writer = thread_current ();
+  else
+    {
+      struct wait_elem waiter;
+      wait_queue_push (&rw->write_waiters, &waiter);
+      thread_block ();
+    }
+  ASSERT (rw->writer == thread_current ());
+  intr_set_level (old_level);
+}
+
+/* Tries to acquire RW for reading without sleeping.  Returns
+   true if successful. */
+bool
+rwlock_try_acquire_read (struct rwlock *rw)
+{
+  enum intr_level old_level;
+  bool success;
+
+  ASSERT (rw != NULL);
+
+  old_level = intr_disable ();
+  success = rwlock_can_read (rw);
+  if (success)
+    rw->readers++;
+  intr_set_level (old_level);
+  return success;
+}
+
+/* Tries to acquire RW for writing without sleeping.  Returns
+   true if successful. */
+bool
+rwlock_try_acquire_write (struct rwlock *rw)
+{
+  enum intr_level old_level;
+  bool success;
+
+  ASSERT (rw != NULL);
+
+  old_level = intr_disable ();
+  success = rw->writer == NULL && rw->readers == 0;
+  if (success)
+    rw->writer = thread_current ();
+  intr_set_level (old_level);
+  return success;
+}
+
+/* Releases RW, which the current thread must hold for reading. */
+void
+rwlock_release_read (struct rwlock *rw)
+{
+  enum intr_level old_level;
+
+  ASSERT (rw != NULL);
+
+  old_level = intr_disable ();
+  ASSERT (rw->readers > 0);
+  if (--rw->readers == 0)
+    rwlock_grant (rw);
+  intr_set_level (old_level);
+}
+
+/* Releases RW, which must be held for writing by the current
+   thread. */
+void
+rwlock_release_write (struct rwlock *rw)
+{
+  enum intr_level old_level;
+
+  ASSERT (rw != NULL);
+  ASSERT (rwlock_held_by_current_thread (rw));
+
+  old_level = intr_disable ();
+  rw->writer = NULL;
+  rwlock_grant (rw);
+  intr_set_level (old_level);
+}
+
+/* Returns true if the current thread holds RW for writing.
+   Readers are not tracked individually. */
+bool
+rwlock_held_by_current_thread (const struct rwlock *rw)
+{
+  ASSERT (rw != NULL);
+
+  return rw->writer == thread_current ();
+}
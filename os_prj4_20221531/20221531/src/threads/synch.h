@@ -3,12 +3,50 @@
 
 #include <list.h>
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct thread;
+
+/* One thread waiting in a wait_queue.
+   A thread may sit in more than one queue at a time (cond_wait()
+   puts it on the condition and then on a private semaphore), so
+   each queue entry is separate from `struct thread' and is
+   linked into the owner's `wait_list'. */
+struct wait_elem
+  {
+    struct thread *thread;      /* Waiting thread, supplies priority. */
+    unsigned seq;               /* Arrival order, breaks ties FIFO. */
+    struct wait_queue *queue;   /* Queue this element is in. */
+    struct wait_elem *child;    /* Leftmost child in the heap. */
+    struct wait_elem *sibling;  /* Next sibling in the heap. */
+    struct wait_elem *prev;     /* Previous sibling, or parent. */
+    struct list_elem thread_elem; /* Element in thread's wait_list. */
+  };
+
+/* Converts pointer to wait element WAIT_ELEM into a pointer to
+   the structure that WAIT_ELEM is embedded inside. */
+#define wait_entry(WAIT_ELEM, STRUCT, MEMBER)                   \
+        ((STRUCT *) ((uint8_t *) &(WAIT_ELEM)->thread           \
+                     - offsetof (STRUCT, MEMBER.thread)))
+
+/* Priority-ordered queue of waiting threads.
+   Kept as a pairing heap keyed on thread priority, so adding a
+   waiter is O(1) and removing the highest-priority waiter is
+   O(log n) amortized, regardless of how many threads wait. */
+struct wait_queue
+  {
+    struct wait_elem *root;     /* Highest-priority waiter. */
+    size_t size;                /* Number of waiters. */
+  };
+
+void wait_queue_reprioritize (struct thread *);
 
 /* A counting semaphore. */
 struct semaphore 
   {
     unsigned value;             /* Current value. */
-    struct list waiters;        /* List of waiting threads. */
+    struct wait_queue waiters;  /* Queue of waiting threads. */
   };
 
 void sema_init (struct semaphore *, unsigned value);
@@ -22,6 +60,10 @@ struct lock
   {
     struct thread *holder;      /* Thread holding lock (for debugging). */
     struct semaphore semaphore; /* Binary semaphore controlling access. */
+#ifdef LOCKSTAT
+    struct lock_class *class;   /* Statistics shared with like locks. */
+    uint64_t acquired_at;       /* TSC when last acquired. */
+#endif
   };
 
 void lock_init (struct lock *);
@@ -30,10 +72,67 @@ bool lock_try_acquire (struct lock *);
 void lock_release (struct lock *);
 bool lock_held_by_current_thread (const struct lock *);
 
+/* Lock statistics.
+   Building with -DLOCKSTAT (add it to DEFINES in Make.vars)
+   makes every lock count its acquisitions, contention, wait and
+   hold times and the call sites that waited longest.  Locks are
+   grouped into classes by the expression passed to lock_init()
+   and the file it appears in, so that, say, the locks of all
+   inodes share one line of output.  Without LOCKSTAT none of
+   this code is compiled.  The table is printed at shutdown;
+   programs read it a class at a time with the lockstat system
+   call. */
+#ifdef LOCKSTAT
+struct lockstat;
+void lockstat_init (struct lock *, const char *name, const char *file);
+#define lock_init(LOCK) lockstat_init (LOCK, #LOCK, __FILE__)
+int lockstat_print (bool reset);
+bool lockstat_get (int idx, struct lockstat *, bool reset);
+#endif
+
+/* Adaptive lock.
+   A lock whose waiters first poll for a while, instead of going
+   to sleep at once, when the holder is running on another CPU
+   and so is likely to release the lock soon. */
+struct adaptive_lock
+  {
+    struct lock lock;           /* Underlying sleeping lock. */
+    long long spin_cnt;         /* # of acquisitions won by polling. */
+    long long sleep_cnt;        /* # of acquisitions that slept. */
+  };
+
+void adaptive_lock_init (struct adaptive_lock *);
+void adaptive_lock_acquire (struct adaptive_lock *);
+bool adaptive_lock_try_acquire (struct adaptive_lock *);
+void adaptive_lock_release (struct adaptive_lock *);
+bool adaptive_lock_held_by_current_thread (const struct adaptive_lock *);
+
+/* Readers-writer lock.
+   Any number of readers, or a single writer, may hold it.
+   Writers are preferred: a reader does not get in while a
+   writer of equal or higher priority is waiting.  Waiters are
+   woken in priority order and handed the lock directly. */
+struct rwlock
+  {
+    unsigned readers;           /* Number of readers holding the lock. */
+    struct thread *writer;      /* Writer holding the lock, if any. */
+    struct wait_queue read_waiters;  /* Waiting readers. */
+    struct wait_queue write_waiters; /* Waiting writers. */
+  };
+
+void rwlock_init (struct rwlock *);
+void rwlock_acquire_read (struct rwlock *);
+void rwlock_acquire_write (struct rwlock *);
+bool rwlock_try_acquire_read (struct rwlock *);
+bool rwlock_try_acquire_write (struct rwlock *);
+void rwlock_release_read (struct rwlock *);
+void rwlock_release_write (struct rwlock *);
+bool rwlock_held_by_current_thread (const struct rwlock *);
+
 /* Condition variable. */
 struct condition 
   {
-    struct list waiters;        /* List of waiting threads. */
+    struct wait_queue waiters;  /* Queue of waiting threads. */
   };
 
 void cond_init (struct condition *);
@@ -1,9 +1,11 @@
 #include "threads/thread.h"
 #include <debug.h>
+#include <histogram.h>
 #include <stddef.h>
 #include <random.h>
 #include <stdio.h>
 #include <string.h>
+#include "threads/cpu.h"
 #include "threads/flags.h"
 #include "threads/interrupt.h"
 #include "threads/intr-stubs.h"
@@ -11,6 +13,7 @@
 #include "threads/switch.h"
 #include "threads/synch.h"
 #include "threads/vaddr.h"
+#include "threads/workqueue.h"
 #ifdef USERPROG
 #include "userprog/process.h"
 #endif
@@ -25,17 +28,10 @@ static int load_avg;
 #define THREAD_MAGIC 0xcd6abf4b
 #define FRACTION (1 << 14)
 
-/* List of processes in THREAD_READY state, that is, processes
-   that are ready to run but not actually running. */
-static struct list ready_list;
-
 /* List of all processes.  Processes are added to this list
    when they are first scheduled and removed when they exit. */
 static struct list all_list;
 
-/* Idle thread. */
-static struct thread *idle_thread;
-
 /* Initial thread, the thread running init.c:main(). */
 static struct thread *initial_thread;
 
@@ -55,9 +51,35 @@ static long long idle_ticks;    /* # of timer ticks spent idle. */
 static long long kernel_ticks;  /* # of timer ticks in kernel threads. */
 static long long user_ticks;    /* # of timer ticks in user programs. */
 
+/* Scheduler statistics summed over every thread, including
+   those that have exited.  Like the tick counts above, these
+   are updated by each CPU without synchronization. */
+static struct sched_stats sched_total;
+
+/* Cache of pages freed by dying threads, which thread_create()
+   reuses before going back to the page allocator.
+   thread_schedule_tail() pushes a dying thread's page on
+   `dirty_pages'; the idle thread zeroes its struct thread and
+   moves it to `clean_pages', so that creating a thread from a
+   clean page needs neither the allocator nor the zeroing.  Both
+   are stacks linked through the first word of each page,
+   protected by disabling interrupts. */
+#define THREAD_CACHE_MAX 16     /* Max pages cached. */
+struct cached_page
+  {
+    struct cached_page *next;
+  };
+static struct cached_page *clean_pages;
+static struct cached_page *dirty_pages;
+static size_t cached_page_cnt;  /* Pages on either list or scrubbing. */
+
+/* Thread page statistics. */
+static long long page_alloc_cnt;        /* # from the page allocator. */
+static long long page_reuse_cnt;        /* # from the cache. */
+static long long page_clean_cnt;        /* # of those already zeroed. */
+
 /* Scheduling. */
 #define TIME_SLICE 4            /* # of timer ticks to give each thread. */
-static unsigned thread_ticks;   /* # of timer ticks since last yield. */
 
 
 bool thread_prior_aging;
@@ -68,6 +90,46 @@ bool thread_prior_aging;
    Controlled by kernel command-line option "-o mlfqs". */
 bool thread_mlfqs;
 
+/* If true, use the fair-share scheduler instead.
+   Controlled by kernel command-line option "-fair".
+
+   Each thread accumulates virtual runtime (vruntime) while it
+   runs, at a rate inversely proportional to its weight, which
+   is derived from its nice value.  The runnable thread with the
+   least vruntime runs next, so over time every thread receives
+   CPU in proportion to its weight.  Time slices are carved out
+   of FAIR_LATENCY so that every runnable thread gets to run once
+   per that many ticks. */
+bool thread_fair;
+
+#define FAIR_LATENCY 8          /* Target scheduling latency, in ticks. */
+#define FAIR_MIN_SLICE 1        /* Minimum time slice, in ticks. */
+#define FAIR_SCALE (1 << 10)    /* vruntime units per nice-0 tick. */
+#define NICE_0_WEIGHT 1024      /* Weight of a nice-0 thread. */
+
+/* Real-time scheduling class, entered with thread_set_deadline().
+
+   A real-time thread reserves RUNTIME ticks of CPU in every
+   PERIOD ticks, to be used within DEADLINE ticks of the start of
+   the period.  Real-time threads always run before all other
+   threads, earliest absolute deadline first (EDF).
+
+   Each time a real-time thread becomes ready at least PERIOD
+   ticks after its last job started, a new job starts: its budget
+   is refilled with RUNTIME ticks and its absolute deadline set
+   DEADLINE ticks ahead.  The running thread's budget is charged
+   at each timer tick.  A thread that uses up its budget is
+   throttled, that is, kept off the run queue until its next job
+   may start, so that it cannot take more than it reserved.
+
+   Admission control keeps the sum of RUNTIME / DEADLINE over all
+   real-time threads at most RT_UTIL_MAX.  This is enough for EDF
+   to meet every deadline on one CPU, and leaves some time for
+   the other threads. */
+#define RT_UTIL_SCALE 1000000   /* A whole CPU. */
+#define RT_UTIL_MAX (RT_UTIL_SCALE / 100 * 95)
+static long rt_util;            /* Reserved by real-time threads. */
+
 static void kernel_thread (thread_func *, void *aux);
 
 static void idle (void *aux UNUSED);
@@ -76,9 +138,31 @@ static struct thread *next_thread_to_run (void);
 static void init_thread (struct thread *, const char *name, int priority);
 static bool is_thread (struct thread *) UNUSED;
 static void *alloc_frame (struct thread *, size_t size);
+static struct thread *thread_page_get (void);
+static void thread_page_put (struct thread *);
+static void thread_page_scrub (void);
 static void schedule (void);
 void thread_schedule_tail (struct thread *prev);
 static tid_t allocate_tid (void);
+static bool is_idle_thread (struct thread *);
+static void runq_push (struct cpu *, struct thread *);
+static struct thread *runq_pop (struct cpu *);
+static bool vruntime_less (const struct rb_elem *, const struct rb_elem *,
+                           void *aux);
+static bool fair_tick (struct cpu *, struct thread *);
+static void fair_place (struct cpu *, struct thread *);
+static bool fair_should_preempt (struct thread *, struct thread *);
+static unsigned long fair_weight (int nice);
+static bool is_realtime (const struct thread *);
+static long rt_density (int64_t runtime, int64_t deadline);
+static void rt_replenish (struct thread *, int64_t now);
+static void rt_release_throttled (struct cpu *, int64_t now);
+static bool rt_should_preempt (struct cpu *, struct thread *cur);
+static bool deadline_less (const struct list_elem *, const struct list_elem *,
+                           void *aux);
+static void sched_account (struct cpu *, struct thread *cur,
+                           struct thread *next);
+static void print_schedstat (const char *name, const struct sched_stats *);
 
 static int
 clamp_priority (int priority)
@@ -95,7 +179,7 @@ clamp_priority (int priority)
    general and it is possible in this case only because loader.S
    was careful to put the bottom of the stack at a page boundary.
 
-   Also initializes the run queue and the tid lock.
+   Also initializes the per-CPU run queues and the tid lock.
 
    After calling this function, be sure to initialize the page
    allocator before trying to create any threads with
@@ -106,16 +190,21 @@ clamp_priority (int priority)
 void
 thread_init (void) 
 {
+  int i;
+
   ASSERT (intr_get_level () == INTR_OFF);
 
   load_avg = 0;
 
+  cpu_init ();
+  for (i = 0; i < CPU_MAX; i++)
+    rb_init (&cpus[i].fair_tree, vruntime_less, NULL);
   lock_init (&tid_lock);
-  list_init (&ready_list);
   list_init (&all_list);
 
   /* Set up a thread structure for the running thread. */
   initial_thread = running_thread ();
+  memset (initial_thread, 0, sizeof *initial_thread);
   init_thread (initial_thread, "main", PRI_DEFAULT);
   initial_thread->status = THREAD_RUNNING;
   initial_thread->tid = allocate_tid ();
@@ -147,9 +236,10 @@ void
 thread_tick (void) 
 {
   struct thread *t = thread_current ();
+  struct cpu *c = cpu_current ();
 
   /* Update statistics. */
-  if (t == idle_thread)
+  if (t == c->idle_thread)
     idle_ticks++;
 #ifdef USERPROG
   else if (t->pagedir != NULL)
@@ -158,18 +248,27 @@ thread_tick (void)
   else
     kernel_ticks++;
 
-  /* Enforce preemption. */
-  if (++thread_ticks >= TIME_SLICE)
+  /* Enforce preemption.  A real-time thread runs until its
+     budget is spent or a thread with an earlier deadline is
+     ready; runq_push() throttles it once the budget is gone. */
+  if (is_realtime (t))
+    {
+      if (--t->rt_budget <= 0)
+        intr_yield_on_return ();
+    }
+  else if (thread_fair)
+    {
+      if (fair_tick (c, t))
+        intr_yield_on_return ();
+    }
+  else if (++c->thread_ticks >= TIME_SLICE)
     intr_yield_on_return ();
 
-  if (thread_prior_aging == true)
-    {
+  rt_release_throttled (c, timer_ticks ());
+  if (rt_should_preempt (c, t))
+    intr_yield_on_return ();
 
-      if (timer_ticks () % TIMER_FREQ == 0)
-        {
-          thread_aging ();
-        }
-    }
+  /* Aging is done by the timer's softirq. */
 }
 
 /* Prints thread statistics. */
@@ -178,6 +277,82 @@ thread_print_stats (void)
 {
   printf ("Thread: %lld idle ticks, %lld kernel ticks, %lld user ticks\n",
           idle_ticks, kernel_ticks, user_ticks);
+  printf ("Thread pages: %lld allocated, %lld reused (%lld pre-zeroed)\n",
+          page_alloc_cnt, page_reuse_cnt, page_clean_cnt);
+  print_schedstat ("all threads", &sched_total);
+}
+
+/* Converts scheduler statistics S to nanoseconds in *OUT. */
+static void
+sched_stats_convert (const struct sched_stats *s, struct schedstat *out)
+{
+  out->run_ns = timer_cycles_to_ns (s->run);
+  out->wait_ns = timer_cycles_to_ns (s->wait);
+  out->latency_max_ns = timer_cycles_to_ns (s->latency_max);
+  out->voluntary = s->voluntary;
+  out->involuntary = s->involuntary;
+  out->wakeups = s->wakeups;
+  memcpy (out->latency, s->latency, sizeof out->latency);
+}
+
+/* Stores the scheduler statistics of the thread with the given
+   TID, or for the whole system if TID is 0, in *OUT.  Returns
+   false if there is no such thread. */
+bool
+thread_get_schedstat (tid_t tid, struct schedstat *out)
+{
+  struct sched_stats s;
+  enum intr_level old_level;
+  bool found = false;
+
+  old_level = intr_disable ();
+  if (tid == 0)
+    {
+      s = sched_total;
+      found = true;
+    }
+  else
+    {
+      struct list_elem *e;
+
+      for (e = list_begin (&all_list); e != list_end (&all_list);
+           e = list_next (e))
+        {
+          struct thread *t = list_entry (e, struct thread, allelem);
+          if (t->tid == tid)
+            {
+              s = t->sched;
+              found = true;
+              break;
+            }
+        }
+    }
+  intr_set_level (old_level);
+
+  if (found)
+    sched_stats_convert (&s, out);
+  return found;
+}
+
+/* Prints scheduler statistics S under the heading NAME. */
+static void
+print_schedstat (const char *name, const struct sched_stats *s)
+{
+  struct schedstat ss;
+  unsigned long long latency[SCHEDSTAT_BUCKETS];
+  int i;
+
+  sched_stats_convert (s, &ss);
+  printf ("Scheduler (%s): %lld ns running, %lld ns waiting, "
+          "%u voluntary and %u involuntary switches\n",
+          name, ss.run_ns, ss.wait_ns, ss.voluntary, ss.involuntary);
+  if (ss.wakeups == 0)
+    return;
+  printf ("Wakeup latency: %u wakeups, max %lld ns\n",
+          ss.wakeups, ss.latency_max_ns);
+  for (i = 0; i < SCHEDSTAT_BUCKETS; i++)
+    latency[i] = ss.latency[i];
+  histogram_print (latency, SCHEDSTAT_BUCKETS);
 }
 
 /* Creates a new kernel thread named NAME with the given initial
@@ -208,13 +383,14 @@ thread_create (const char *name, int priority,
   ASSERT (function != NULL);
 
   /* Allocate thread. */
-  t = palloc_get_page (PAL_ZERO);
+  t = thread_page_get ();
   if (t == NULL)
     return TID_ERROR;
 
   /* Initialize thread. */
   init_thread (t, name, priority);
   tid = t->tid = allocate_tid ();
+  t->vruntime = cpu_current ()->min_vruntime;
 
   /* Stack frame for kernel_thread(). */
   kf = alloc_frame (t, sizeof *kf);
@@ -234,7 +410,7 @@ thread_create (const char *name, int priority,
   /* Add to run queue. */
   thread_unblock (t);
 
-  bool needs_yield = (priority > thread_get_priority());
+  bool needs_yield = !thread_fair && priority > thread_get_priority ();
   if (needs_yield) {
       thread_yield();
   }
@@ -269,15 +445,35 @@ thread_block (void)
 void
 thread_unblock (struct thread *t) 
 {
+  struct cpu *c;
   enum intr_level old_level;
 
   ASSERT (is_thread (t));
 
   old_level = intr_disable ();
   ASSERT (t->status == THREAD_BLOCKED);
- // list_push_back (&ready_list, &t->elem);
-  list_insert_ordered(&ready_list, &t->elem, (list_less_func *) &compare_thread_priority, NULL);
   t->status = THREAD_READY;
+  t->sched_stamp = timer_cycles ();
+  t->sched_woken = true;
+  c = t->cpu != NULL && t->cpu->online ? t->cpu : cpu_current ();
+  if (thread_fair)
+    {
+      fair_place (c, t);
+
+      /* Interrupt handlers wake up sleepers and I/O waiters.  Let
+         them run as soon as the handler returns, if they are far
+         enough behind, to keep wakeup latency low. */
+      if (intr_context () && c == cpu_current ()
+          && fair_should_preempt (t, thread_current ()))
+        intr_yield_on_return ();
+    }
+  runq_push (c, t);
+
+  /* Likewise, a real-time thread preempts any thread with a later
+     deadline or none. */
+  if (intr_context () && c == cpu_current ()
+      && rt_should_preempt (c, thread_current ()))
+    intr_yield_on_return ();
   intr_set_level (old_level);
 }
 
@@ -329,6 +525,9 @@ thread_exit (void)
      and schedule another process.  That process will destroy us
      when it calls thread_schedule_tail(). */
   intr_disable ();
+  if (is_realtime (thread_current ()))
+    rt_util -= rt_density (thread_current ()->rt_runtime,
+                           thread_current ()->rt_deadline);
   list_remove (&thread_current()->allelem);
   thread_current ()->status = THREAD_DYING;
   schedule ();
@@ -348,15 +547,16 @@ void
 thread_yield (void) 
 {
   struct thread *cur = thread_current ();
+  struct cpu *c;
   enum intr_level old_level;
   
   ASSERT (!intr_context ());
 
   old_level = intr_disable ();
-  if (cur != idle_thread) 
-    //list_push_back (&ready_list, &cur->elem);
-    list_insert_ordered(&ready_list, &cur->elem, (list_less_func *) &compare_thread_priority, NULL);
+  c = cpu_current ();
   cur->status = THREAD_READY;
+  if (cur != c->idle_thread) 
+    runq_push (c, cur);
   schedule ();
   intr_set_level (old_level);
 }
@@ -378,6 +578,9 @@ thread_foreach (thread_action_func *func, void *aux)
     }
 }
 
+/* Raises the priority of every thread but the idle threads by
+   one, up to PRI_MAX.  With -aging this runs once a second, from
+   the aging workqueue. */
 void
 thread_aging (void)
 {
@@ -389,19 +592,48 @@ thread_aging (void)
     {
       struct thread *t = list_entry (e, struct thread, allelem);
 
-      if (t == idle_thread)
+      if (is_idle_thread (t))
         continue;
       
       
       if (t->priority < PRI_MAX)
         {
           t->priority++;
+          if (!list_empty (&t->wait_list))
+            wait_queue_reprioritize (t);
         }
     }
   
   intr_set_level (old_level);
 }
 
+/* Workqueue for priority aging.  It runs at PRI_MAX, because
+   aging has to run even while higher-priority threads would
+   starve the ones it is meant to help. */
+static struct workqueue aging_wq;
+static struct delayed_work aging_work;
+
+/* Ages all threads, then queues itself to run again a second
+   later. */
+static void
+aging_work_func (struct work *w UNUSED)
+{
+  thread_aging ();
+  queue_delayed_work (&aging_wq, &aging_work, TIMER_FREQ);
+}
+
+/* Starts aging thread priorities once a second if -aging was
+   given.  Must be called after workqueue_init(). */
+void
+thread_aging_start (void)
+{
+  if (!thread_prior_aging)
+    return;
+  workqueue_create (&aging_wq, "aging", PRI_MAX);
+  delayed_work_init (&aging_work, aging_work_func, NULL);
+  queue_delayed_work (&aging_wq, &aging_work, TIMER_FREQ);
+}
+
 /* Sets the current thread's priority to NEW_PRIORITY. */
 void
 thread_set_priority (int new_priority) 
@@ -422,12 +654,63 @@ thread_get_priority (void)
   return thread_current ()->priority;
 }
 
+/* Makes the current thread a real-time thread that needs
+   RUNTIME timer ticks of CPU time in every PERIOD ticks, within
+   DEADLINE ticks of the period's start, or, if RUNTIME is 0,
+   returns it to normal scheduling.  Requires 0 < RUNTIME <=
+   DEADLINE <= PERIOD.  Returns false, leaving the thread as it
+   was, if the parameters are invalid or admitting the thread
+   would overcommit the CPU.  See the comment on RT_UTIL_SCALE
+   for details. */
+bool
+thread_set_deadline (int64_t runtime, int64_t deadline, int64_t period)
+{
+  struct thread *cur = thread_current ();
+  enum intr_level old_level;
+  long old_density = 0;
+  long density = 0;
+
+  if (runtime != 0)
+    {
+      if (runtime < 0 || runtime > deadline || deadline > period)
+        return false;
+      density = rt_density (runtime, deadline);
+    }
+
+  old_level = intr_disable ();
+  if (is_realtime (cur))
+    old_density = rt_density (cur->rt_runtime, cur->rt_deadline);
+  if (rt_util - old_density + density > RT_UTIL_MAX)
+    {
+      intr_set_level (old_level);
+      return false;
+    }
+  rt_util += density - old_density;
+
+  cur->rt_runtime = runtime;
+  cur->rt_deadline = deadline;
+  cur->rt_period = runtime != 0 ? period : 0;
+  if (runtime != 0)
+    {
+      /* Start the first job now. */
+      cur->rt_release = timer_ticks ();
+      rt_replenish (cur, cur->rt_release);
+    }
+  intr_set_level (old_level);
+
+  /* Requeue ourselves in our new class. */
+  thread_yield ();
+  return true;
+}
+
 /* Sets the current thread's nice value to NICE. */
 void
 thread_set_nice (int nice UNUSED) 
 {
   struct thread *t = thread_current();
   t->nice = nice;
+  if (thread_fair)
+    return;     /* The new weight takes effect from the next tick. */
   update_thread_priority(t); // nice 값이 바뀌면 우선순위를 즉시 재계산
   if (t->priority < get_max_priority()) thread_yield(); // 재계산 결과, ready_list의 누군가보다 우선순위가 낮아졌다면 양보
 }
@@ -467,11 +750,14 @@ static void
 idle (void *idle_started_ UNUSED) 
 {
   struct semaphore *idle_started = idle_started_;
-  idle_thread = thread_current ();
+  cpu_current ()->idle_thread = thread_current ();
   sema_up (idle_started);
 
   for (;;) 
     {
+      /* Nothing else to do: prepare cached thread pages. */
+      thread_page_scrub ();
+
       /* Let someone else run. */
       intr_disable ();
       thread_block ();
@@ -525,7 +811,7 @@ is_thread (struct thread *t)
 }
 
 /* Does basic initialization of T as a blocked thread named
-   NAME. */
+   NAME.  *T must already be zeroed. */
 static void
 init_thread (struct thread *t, const char *name, int priority)
 {
@@ -535,12 +821,12 @@ init_thread (struct thread *t, const char *name, int priority)
   ASSERT (PRI_MIN <= priority && priority <= PRI_MAX);
   ASSERT (name != NULL);
 
-  memset (t, 0, sizeof *t);
   t->status = THREAD_BLOCKED;
   strlcpy (t->name, name, sizeof t->name);
   t->stack = (uint8_t *) t + PGSIZE;
   t->priority = priority;
   t->magic = THREAD_MAGIC;
+  list_init (&t->wait_list);
 
 
   old_level = intr_disable ();
@@ -564,10 +850,111 @@ init_thread (struct thread *t, const char *name, int priority)
     //project 4
     list_init(&t->mmap_list);
     t->next_mapid = 1;
+
+    t->leader = t;
+    t->uthread = NULL;
+    lock_init (&t->vm_lock);
+    rwlock_init (&t->fd_lock);
+    lock_init (&t->uthread_lock);
+    list_init (&t->uthreads);
+    t->uthread_cnt = 0;
+    t->stack_slots = 0;
+    t->exiting = false;
+    sema_init (&t->uthreads_gone, 0);
   #endif
 
 }
 
+/* Returns a page for a new thread, with its struct thread
+   zeroed, or a null pointer if none is available.  Prefers the
+   cache of pages freed by dying threads.  Only the struct thread
+   is zeroed; the stack above it is left as it was. */
+static struct thread *
+thread_page_get (void)
+{
+  struct cached_page *p;
+  enum intr_level old_level;
+  bool clean;
+
+  old_level = intr_disable ();
+  clean = clean_pages != NULL;
+  p = clean ? clean_pages : dirty_pages;
+  if (p != NULL)
+    {
+      if (clean)
+        clean_pages = p->next;
+      else
+        dirty_pages = p->next;
+      cached_page_cnt--;
+      page_reuse_cnt++;
+      if (clean)
+        page_clean_cnt++;
+    }
+  intr_set_level (old_level);
+
+  if (p == NULL)
+    {
+      p = palloc_get_page (0);
+      if (p == NULL)
+        return NULL;
+      old_level = intr_disable ();
+      page_alloc_cnt++;
+      intr_set_level (old_level);
+    }
+
+  if (clean)
+    p->next = NULL;
+  else
+    memset (p, 0, sizeof (struct thread));
+  return (struct thread *) p;
+}
+
+/* Frees the page of dying thread T, keeping it in the cache if
+   there is room.  Called with interrupts off. */
+static void
+thread_page_put (struct thread *t)
+{
+  struct cached_page *p = (struct cached_page *) t;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  if (cached_page_cnt < THREAD_CACHE_MAX)
+    {
+      p->next = dirty_pages;
+      dirty_pages = p;
+      cached_page_cnt++;
+    }
+  else
+    palloc_free_page (t);
+}
+
+/* Zeroes the struct thread in each page on `dirty_pages' and
+   moves it to `clean_pages'.  Called by the idle thread. */
+static void
+thread_page_scrub (void)
+{
+  for (;;)
+    {
+      struct cached_page *p;
+      enum intr_level old_level;
+
+      old_level = intr_disable ();
+      p = dirty_pages;
+      if (p != NULL)
+        dirty_pages = p->next;
+      intr_set_level (old_level);
+      if (p == NULL)
+        break;
+
+      memset (p, 0, sizeof (struct thread));
+
+      old_level = intr_disable ();
+      p->next = clean_pages;
+      clean_pages = p;
+      intr_set_level (old_level);
+    }
+}
+
 /* Allocates a SIZE-byte frame at the top of thread T's stack and
    returns a pointer to the frame's base. */
 static void *
@@ -581,18 +968,297 @@ alloc_frame (struct thread *t, size_t size)
   return t->stack;
 }
 
+/* Returns true if T is the idle thread of some CPU. */
+static bool
+is_idle_thread (struct thread *t)
+{
+  int i;
+
+  for (i = 0; i < cpu_cnt; i++)
+    if (cpus[i].idle_thread == t)
+      return true;
+  return false;
+}
+
+/* Adds T, which must be ready, to the run queue of CPU C.
+   T will prefer to keep running on C from now on. */
+static void
+runq_push (struct cpu *c, struct thread *t)
+{
+  int64_t now = is_realtime (t) ? timer_ticks () : 0;
+  enum intr_level old_level = spinlock_acquire (&c->rq_lock);
+
+  t->cpu = c;
+  if (is_realtime (t))
+    {
+      rt_replenish (t, now);
+      if (t->rt_budget <= 0)
+        {
+          /* Out of budget: rt_release_throttled() will queue T
+             when its next job may start. */
+          list_push_back (&c->rt_throttled, &t->elem);
+          spinlock_release (&c->rq_lock, old_level);
+          return;
+        }
+      list_insert_ordered (&c->rt_list, &t->elem, deadline_less, NULL);
+    }
+  else if (thread_fair)
+    {
+      rb_insert (&c->fair_tree, &t->fair_elem);
+      c->fair_load += fair_weight (t->nice);
+    }
+  else
+    list_insert_ordered (&c->ready_list, &t->elem,
+                         (list_less_func *) &compare_thread_priority, NULL);
+  c->ready_cnt++;
+  spinlock_release (&c->rq_lock, old_level);
+}
+
+/* Removes and returns the real-time thread with the earliest
+   deadline in CPU C's run queue, or if there is none the
+   highest-priority thread, or with -fair the one with the least
+   vruntime, or a null pointer if the queue is empty. */
+static struct thread *
+runq_pop (struct cpu *c)
+{
+  struct thread *t = NULL;
+  enum intr_level old_level = spinlock_acquire (&c->rq_lock);
+  if (!list_empty (&c->rt_list))
+    {
+      t = list_entry (list_pop_front (&c->rt_list), struct thread, elem);
+      c->ready_cnt--;
+    }
+  else if (thread_fair)
+    {
+      if (!rb_empty (&c->fair_tree))
+        {
+          t = rb_entry (rb_first (&c->fair_tree), struct thread, fair_elem);
+          rb_remove (&c->fair_tree, &t->fair_elem);
+          c->fair_load -= fair_weight (t->nice);
+          c->ready_cnt--;
+        }
+    }
+  else if (!list_empty (&c->ready_list))
+    {
+      t = list_entry (list_pop_front (&c->ready_list), struct thread, elem);
+      c->ready_cnt--;
+    }
+  spinlock_release (&c->rq_lock, old_level);
+  return t;
+}
+
+/* Table of weights by nice value, from NICE_MIN to NICE_MAX.
+   Each step in nice changes a thread's share of the CPU,
+   relative to a thread at the next step, by about 10%. */
+static const unsigned long fair_weights[NICE_MAX - NICE_MIN + 1] =
+  {
+    /* -20 */ 88761, 71755, 56483, 46273, 36291,
+    /* -15 */ 29154, 23254, 18705, 14949, 11916,
+    /* -10 */  9548,  7620,  6100,  4904,  3906,
+    /*  -5 */  3121,  2501,  1991,  1586,  1277,
+    /*   0 */  1024,   820,   655,   526,   423,
+    /*   5 */   335,   272,   215,   172,   137,
+    /*  10 */   110,    87,    70,    56,    45,
+    /*  15 */    36,    29,    23,    18,    15,
+    /*  20 */    12,
+  };
+
+/* Returns the scheduling weight of a thread with the given
+   NICE value. */
+static unsigned long
+fair_weight (int nice)
+{
+  if (nice < NICE_MIN)
+    nice = NICE_MIN;
+  if (nice > NICE_MAX)
+    nice = NICE_MAX;
+  return fair_weights[nice - NICE_MIN];
+}
+
+/* Orders threads in a fair_tree by vruntime. */
+static bool
+vruntime_less (const struct rb_elem *a_, const struct rb_elem *b_,
+               void *aux UNUSED)
+{
+  const struct thread *a = rb_entry (a_, struct thread, fair_elem);
+  const struct thread *b = rb_entry (b_, struct thread, fair_elem);
+
+  return a->vruntime < b->vruntime;
+}
+
+/* Advances C's min_vruntime to the least vruntime of its running
+   thread CUR (if it is not idle) and its queued threads.  The
+   floor never moves backward. */
+static void
+fair_update_min_vruntime (struct cpu *c, struct thread *cur)
+{
+  struct rb_elem *first = rb_first (&c->fair_tree);
+  int64_t min = c->min_vruntime;
+  bool have_min = false;
+
+  if (cur != c->idle_thread)
+    {
+      min = cur->vruntime;
+      have_min = true;
+    }
+  if (first != NULL)
+    {
+      int64_t v = rb_entry (first, struct thread, fair_elem)->vruntime;
+      if (!have_min || v < min)
+        min = v;
+    }
+  if (min > c->min_vruntime)
+    c->min_vruntime = min;
+}
+
+/* Returns the time slice, in ticks, of thread T running on C:
+   its weighted share of FAIR_LATENCY, stretched if there are
+   too many runnable threads to give each FAIR_MIN_SLICE. */
+static unsigned
+fair_slice (struct cpu *c, struct thread *t)
+{
+  unsigned long weight = fair_weight (t->nice);
+  unsigned long load = c->fair_load + weight;
+  unsigned long period = FAIR_LATENCY;
+  unsigned long slice;
+
+  if ((c->ready_cnt + 1) * FAIR_MIN_SLICE > period)
+    period = (c->ready_cnt + 1) * FAIR_MIN_SLICE;
+  slice = period * weight / load;
+  return slice > FAIR_MIN_SLICE ? slice : FAIR_MIN_SLICE;
+}
+
+/* Charges the current thread T on C for one timer tick.
+   Returns true if T has used up its time slice and should be
+   preempted. */
+static bool
+fair_tick (struct cpu *c, struct thread *t)
+{
+  if (t == c->idle_thread)
+    return c->ready_cnt > 0;
+
+  t->vruntime += (int64_t) NICE_0_WEIGHT * FAIR_SCALE / fair_weight (t->nice);
+  fair_update_min_vruntime (c, t);
+  return ++c->thread_ticks >= fair_slice (c, t) && c->ready_cnt > 0;
+}
+
+/* Sets the vruntime of T, which is about to be queued on C after
+   sleeping.  A sleeper keeps the vruntime it had, so it cannot
+   bank CPU time by blocking, except that it is credited with up
+   to half a target latency, so that interactive threads run
+   soon after waking. */
+static void
+fair_place (struct cpu *c, struct thread *t)
+{
+  int64_t floor = c->min_vruntime - FAIR_LATENCY * FAIR_SCALE / 2;
+
+  if (t->vruntime < floor)
+    t->vruntime = floor;
+}
+
+/* Returns true if woken thread T should preempt running thread
+   CUR: CUR is idle, or T is behind it by more than one tick. */
+static bool
+fair_should_preempt (struct thread *t, struct thread *cur)
+{
+  return (cur == cpu_current ()->idle_thread
+          || t->vruntime + FAIR_SCALE < cur->vruntime);
+}
+
+/* Returns true if T is in the real-time class. */
+static bool
+is_realtime (const struct thread *t)
+{
+  return t->rt_period != 0;
+}
+
+/* Returns the share of a CPU, in RT_UTIL_SCALE units, reserved
+   by RUNTIME ticks in every DEADLINE ticks. */
+static long
+rt_density (int64_t runtime, int64_t deadline)
+{
+  return runtime * RT_UTIL_SCALE / deadline;
+}
+
+/* Starts a new job of real-time thread T, refilling its budget
+   and setting its deadline, if at time NOW its period is over. */
+static void
+rt_replenish (struct thread *t, int64_t now)
+{
+  if (now < t->rt_release)
+    return;
+  t->rt_budget = t->rt_runtime;
+  t->rt_abs_deadline = now + t->rt_deadline;
+  t->rt_release = now + t->rt_period;
+}
+
+/* Moves each real-time thread throttled on C whose next job may
+   start at time NOW back onto C's run queue. */
+static void
+rt_release_throttled (struct cpu *c, int64_t now)
+{
+  enum intr_level old_level = spinlock_acquire (&c->rq_lock);
+  struct list_elem *e, *next;
+
+  for (e = list_begin (&c->rt_throttled); e != list_end (&c->rt_throttled);
+       e = next)
+    {
+      struct thread *t = list_entry (e, struct thread, elem);
+      next = list_next (e);
+      if (now >= t->rt_release)
+        {
+          list_remove (e);
+          rt_replenish (t, now);
+          list_insert_ordered (&c->rt_list, e, deadline_less, NULL);
+          c->ready_cnt++;
+        }
+    }
+  spinlock_release (&c->rq_lock, old_level);
+}
+
+/* Returns true if the first real-time thread in C's run queue
+   should preempt CUR, which is running on C: CUR is not a
+   real-time thread or its deadline is later. */
+static bool
+rt_should_preempt (struct cpu *c, struct thread *cur)
+{
+  enum intr_level old_level = spinlock_acquire (&c->rq_lock);
+  bool preempt = false;
+
+  if (!list_empty (&c->rt_list))
+    {
+      struct thread *t = list_entry (list_front (&c->rt_list),
+                                     struct thread, elem);
+      preempt = (!is_realtime (cur)
+                 || t->rt_abs_deadline < cur->rt_abs_deadline);
+    }
+  spinlock_release (&c->rq_lock, old_level);
+  return preempt;
+}
+
+/* Orders threads in an rt_list by absolute deadline. */
+static bool
+deadline_less (const struct list_elem *a_, const struct list_elem *b_,
+               void *aux UNUSED)
+{
+  const struct thread *a = list_entry (a_, struct thread, elem);
+  const struct thread *b = list_entry (b_, struct thread, elem);
+
+  return a->rt_abs_deadline < b->rt_abs_deadline;
+}
+
 /* Chooses and returns the next thread to be scheduled.  Should
-   return a thread from the run queue, unless the run queue is
-   empty.  (If the running thread can continue running, then it
-   will be in the run queue.)  If the run queue is empty, return
-   idle_thread. */
+   return a thread from this CPU's run queue, unless the run
+   queue is empty.  (If the running thread can continue running,
+   then it will be in the run queue.)  If the run queue is empty,
+   return this CPU's idle thread. */
 static struct thread *
 next_thread_to_run (void) 
 {
-  if (list_empty (&ready_list))
-    return idle_thread;
-  else
-    return list_entry (list_pop_front (&ready_list), struct thread, elem);
+  struct cpu *c = cpu_current ();
+  struct thread *t = runq_pop (c);
+
+  return t != NULL ? t : c->idle_thread;
 }
 
 /* Completes a thread switch by activating the new thread's page
@@ -615,14 +1281,16 @@ void
 thread_schedule_tail (struct thread *prev)
 {
   struct thread *cur = running_thread ();
+  struct cpu *c = cpu_current ();
   
   ASSERT (intr_get_level () == INTR_OFF);
 
   /* Mark us as running. */
   cur->status = THREAD_RUNNING;
+  cur->cpu = c;
 
   /* Start new time slice. */
-  thread_ticks = 0;
+  c->thread_ticks = 0;
 
 #ifdef USERPROG
   /* Activate the new address space. */
@@ -633,11 +1301,12 @@ thread_schedule_tail (struct thread *prev)
      thread.  This must happen late so that thread_exit() doesn't
      pull out the rug under itself.  (We don't free
      initial_thread because its memory was not obtained via
-     palloc().) */
+     palloc().)  The page usually goes to the thread page
+     cache. */
   if (prev != NULL && prev->status == THREAD_DYING && prev != initial_thread) 
     {
       ASSERT (prev != cur);
-      palloc_free_page (prev);
+      thread_page_put (prev);
     }
 }
 
@@ -660,10 +1329,65 @@ schedule (void)
   ASSERT (is_thread (next));
 
   if (cur != next)
-    prev = switch_threads (cur, next);
+    {
+      sched_account (cpu_current (), cur, next);
+      prev = switch_threads (cur, next);
+    }
   thread_schedule_tail (prev);
 }
 
+/* Adds a wakeup LATENCY, in cycles, to the histogram of S. */
+static void
+sched_add_latency (struct sched_stats *s, uint64_t latency, int bucket)
+{
+  s->wakeups++;
+  s->latency[bucket]++;
+  if (latency > s->latency_max)
+    s->latency_max = latency;
+}
+
+/* Updates the scheduler statistics of CUR, which is giving up C,
+   and NEXT, which is about to run on it. */
+static void
+sched_account (struct cpu *c, struct thread *cur, struct thread *next)
+{
+  uint64_t now = timer_cycles ();
+
+  if (cur != c->idle_thread)
+    {
+      uint64_t ran = now - cur->sched_stamp;
+      cur->sched.run += ran;
+      sched_total.run += ran;
+      if (cur->status == THREAD_READY)
+        {
+          cur->sched.involuntary++;
+          sched_total.involuntary++;
+        }
+      else
+        {
+          cur->sched.voluntary++;
+          sched_total.voluntary++;
+        }
+      cur->sched_stamp = now;
+    }
+
+  if (next != c->idle_thread)
+    {
+      uint64_t waited = now - next->sched_stamp;
+      next->sched.wait += waited;
+      sched_total.wait += waited;
+      if (next->sched_woken)
+        {
+          int bucket = histogram_bucket (timer_cycles_to_ns (waited),
+                                         SCHEDSTAT_BUCKETS);
+          sched_add_latency (&next->sched, waited, bucket);
+          sched_add_latency (&sched_total, waited, bucket);
+          next->sched_woken = false;
+        }
+      next->sched_stamp = now;
+    }
+}
+
 /* Returns a tid to use for a new thread. */
 static tid_t
 allocate_tid (void) 
@@ -685,10 +1409,16 @@ uint32_t thread_stack_ofs = offsetof (struct thread, stack);
 
 void update_load_avg(void) {
     int64_t old_load_avg = 59 * (int64_t)load_avg;
-    
-    
-    int ready_count = list_size(&ready_list);
-    if (thread_current() != idle_thread) {
+    int ready_count = 0;
+    int i;
+
+    for (i = 0; i < cpu_cnt; i++)
+        if (cpus[i].online)
+            ready_count += cpus[i].ready_cnt;
+    /* Timer work left over to ksoftirqd runs this on its behalf,
+       but ksoftirqd is not part of the load it is sampling. */
+    if (thread_current() != cpu_current()->idle_thread
+        && !softirq_is_ksoftirqd(thread_current())) {
         ready_count++;
     }
 
@@ -709,7 +1439,7 @@ void update_recent_cpu(void) {
   for (elem = list_begin (&all_list); elem != list_end (&all_list); elem = list_next (elem))
     {
       struct thread *t = list_entry (elem, struct thread, allelem);
-      if (t == idle_thread)
+      if (is_idle_thread (t))
         continue;
 
       /* decay * recent_cpu 부분 */
@@ -724,7 +1454,7 @@ void update_recent_cpu(void) {
 
 void update_thread_priority (struct thread *t)
 {
-  if (t == idle_thread)
+  if (is_idle_thread (t))
     return;
 
   int64_t base_prio = (PRI_MAX * FRACTION) - (t->recent_cpu / 4);
@@ -733,8 +1463,17 @@ void update_thread_priority (struct thread *t)
   int64_t nice_adjust = (int64_t)t->nice * 2 * FRACTION;
 
   int raw_priority = (int)((base_prio - nice_adjust) / FRACTION);
+  int old_priority = t->priority;
 
   t->priority = clamp_priority (raw_priority);
+
+  /* Keep any semaphore or condition queue T waits in ordered. */
+  if (t->priority != old_priority && !list_empty (&t->wait_list))
+    {
+      enum intr_level old_level = intr_disable ();
+      wait_queue_reprioritize (t);
+      intr_set_level (old_level);
+    }
 }
 
 /* 모든 스레드의 우선순위를 갱신한다. */
@@ -757,15 +1496,14 @@ int
 get_max_priority (void)
 {
   int max_priority = -1; // 우선순위는 0부터 시작하므로 -1로 초기화
-
-  // ready_list가 비어있으면 바로 반환
-  if (list_empty (&ready_list))
-    return max_priority;
-
+  struct cpu *c = cpu_current ();
   struct list_elem *e;
+  enum intr_level old_level;
 
-  // ready_list를 순회
-  for (e = list_begin (&ready_list); e != list_end (&ready_list); e = list_next (e))
+  // 이 CPU의 ready_list를 순회
+  old_level = spinlock_acquire (&c->rq_lock);
+  for (e = list_begin (&c->ready_list); e != list_end (&c->ready_list);
+       e = list_next (e))
     {
       struct thread *t = list_entry (e, struct thread, elem);
       if (t->priority > max_priority)
@@ -773,6 +1511,7 @@ get_max_priority (void)
           max_priority = t->priority;
         }
     }
+  spinlock_release (&c->rq_lock, old_level);
   
   return max_priority;
 }
\ No newline at end of file
@@ -3,6 +3,8 @@
 
 #include <debug.h>
 #include <list.h>
+#include <rbtree.h>
+#include <schedstat.h>
 #include <stdint.h>
 #include "synch.h"
 #include <hash.h>
@@ -29,9 +31,28 @@ typedef int tid_t;
 #define PRI_DEFAULT 31                  /* Default priority. */
 #define PRI_MAX 63                      /* Highest priority. */
 
+/* Thread niceness. */
+#define NICE_MIN -20                    /* Least nice. */
+#define NICE_DEFAULT 0                  /* Default niceness. */
+#define NICE_MAX 20                     /* Nicest. */
+
 //project 4
 typedef int mapid_t;
 
+/* Scheduler statistics, kept by schedule() and thread_unblock().
+   Times are in time-stamp counter cycles; thread_get_schedstat()
+   converts them to the nanoseconds of a struct schedstat. */
+struct sched_stats
+  {
+    uint64_t run;                       /* Time spent running. */
+    uint64_t wait;                      /* Time ready but not running. */
+    uint64_t latency_max;               /* Longest wakeup latency. */
+    unsigned voluntary;                 /* Switches away by blocking. */
+    unsigned involuntary;               /* Switches away while ready. */
+    unsigned wakeups;                   /* Runs after thread_unblock(). */
+    unsigned latency[SCHEDSTAT_BUCKETS]; /* Wakeup latency histogram. */
+  };
+
 /* A kernel thread or user process.
 
    Each thread structure is stored in its own 4 kB page.  The
@@ -100,6 +121,25 @@ struct thread
 
     /* Shared between thread.c and synch.c. */
     struct list_elem elem;              /* List element. */
+    struct list wait_list;              /* Wait queue entries we hold. */
+    struct cpu *cpu;                    /* CPU we last ran on. */
+    struct rb_elem fair_elem;           /* Run queue element for -fair. */
+    int64_t vruntime;                   /* Weighted run time for -fair. */
+
+    /* Real-time (EDF) reservation, in timer ticks.  `rt_period'
+       is 0 for threads outside the real-time class. */
+    int64_t rt_runtime;                 /* Budget per period. */
+    int64_t rt_deadline;                /* Relative deadline. */
+    int64_t rt_period;                  /* Minimum time between jobs. */
+    int64_t rt_abs_deadline;            /* Deadline of current job. */
+    int64_t rt_release;                 /* Earliest start of next job. */
+    int64_t rt_budget;                  /* Ticks left for current job. */
+
+    /* Scheduler statistics. */
+    struct sched_stats sched;           /* Our statistics. */
+    uint64_t sched_stamp;               /* When we last became ready
+                                           or started running. */
+    bool sched_woken;                   /* Ready from thread_unblock()? */
 
     //project 3
     int64_t wakeup_tick;
@@ -124,6 +164,25 @@ struct thread
     struct hash vm;
     struct list mmap_list;
     int next_mapid;
+
+    /* Threads of a multithreaded process share the leader's
+       address space, `vm', `FD' table and `mmap_list'; only the
+       leader's copies of those are used.  Owned by
+       userprog/process.c. */
+    struct thread *leader;              /* Process leader, maybe us. */
+    struct uthread *uthread;            /* Our join record, if not leader. */
+    void *user_esp;                     /* User esp at last system call. */
+    struct lock vm_lock;                /* Leader: serializes `vm', faults. */
+    struct rwlock fd_lock;              /* Leader: protects `FD', `pipes'. */
+    struct pipe_end *pipes;             /* Leader: pipe ends by fd, or null. */
+    struct ring *ring;                  /* Leader: rings, a user address. */
+    struct trace *trace;                /* Leader: system call trace. */
+    struct lock uthread_lock;           /* Leader: protects `uthreads'. */
+    struct list uthreads;               /* Leader: join records. */
+    int uthread_cnt;                    /* Leader: # of other live threads. */
+    uint32_t stack_slots;               /* Leader: thread stacks in use. */
+    bool exiting;                       /* Leader: process is exiting. */
+    struct semaphore uthreads_gone;     /* Leader: others have exited. */
 #endif
 
     /* Owned by thread.c. */
@@ -135,11 +194,16 @@ struct thread
    Controlled by kernel command-line option "-o mlfqs". */
 extern bool thread_mlfqs;
 
+/* If true, use the fair-share (virtual runtime) scheduler.
+   Controlled by kernel command-line option "-fair". */
+extern bool thread_fair;
+
 void thread_init (void);
 void thread_start (void);
 
 void thread_tick (void);
 void thread_print_stats (void);
+bool thread_get_schedstat (tid_t, struct schedstat *);
 
 typedef void thread_func (void *aux);
 tid_t thread_create (const char *name, int priority, thread_func *, void *);
@@ -161,6 +225,8 @@ void thread_foreach (thread_action_func *, void *);
 int thread_get_priority (void);
 void thread_set_priority (int);
 
+bool thread_set_deadline (int64_t runtime, int64_t deadline, int64_t period);
+
 int thread_get_nice (void);
 void thread_set_nice (int);
 int thread_get_recent_cpu (void);
@@ -175,5 +241,6 @@ void update_thread_priority(struct thread *t);
 int get_max_priority(void);
 int thread_get_load_avg(void);
 void thread_aging(void);
+void thread_aging_start (void);
 
 #endif /* threads/thread.h */
@@ -0,0 +1,374 @@
+#include "threads/workqueue.h"
+#include <debug.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include "devices/timer.h"
+#include "threads/interrupt.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+/* Maximum number of worker threads. */
+#define WORKER_MAX 16
+
+/* All workqueues, highest priority first. */
+static struct list workqueues = LIST_INITIALIZER (workqueues);
+
+/* Delayed work waiting for its tick, earliest first.  The timer
+   softirq scans it from timer_init() on, before workqueue_init()
+   runs, so it is initialized statically. */
+static struct list delayed_list = LIST_INITIALIZER (delayed_list);
+
+/* Number of pending work items across all queues.  Each worker
+   downs this before taking an item, so idle workers sleep.  It
+   may count an item that cancel_work() removed after a worker
+   had already downed it; that worker finds nothing to take. */
+static struct semaphore work_avail;
+
+/* Number of worker threads actually started. */
+static size_t worker_cnt;
+
+struct workqueue system_wq;
+
+static thread_func worker_thread;
+
+/* Returns true if workqueue A has higher priority than B. */
+static bool
+workqueue_more (const struct list_elem *a, const struct list_elem *b,
+                void *aux UNUSED)
+{
+  return (list_entry (a, struct workqueue, elem)->priority
+          > list_entry (b, struct workqueue, elem)->priority);
+}
+
+/* Returns true if delayed work A is due before B. */
+static bool
+delayed_work_earlier (const struct list_elem *a, const struct list_elem *b,
+                      void *aux UNUSED)
+{
+  return (list_entry (a, struct delayed_work, timer_elem)->due
+          < list_entry (b, struct delayed_work, timer_elem)->due);
+}
+
+/* Initializes the workqueue system and starts WORKER_CNT worker
+   threads (at least 1, at most WORKER_MAX).  Must be called
+   after thread_start(). */
+void
+workqueue_init (size_t worker_cnt_)
+{
+  size_t i;
+
+  sema_init (&work_avail, 0);
+  workqueue_create (&system_wq, "system", PRI_DEFAULT);
+
+  if (worker_cnt_ < 1)
+    worker_cnt_ = 1;
+  if (worker_cnt_ > WORKER_MAX)
+    worker_cnt_ = WORKER_MAX;
+  for (i = 0; i < worker_cnt_; i++)
+    {
+      char name[16];
+      snprintf (name, sizeof name, "kworker/%zu", i);
+      if (thread_create (name, PRI_MAX, worker_thread, NULL) == TID_ERROR)
+        break;
+      worker_cnt++;
+    }
+  if (worker_cnt == 0)
+    PANIC ("could not start any workqueue worker");
+}
+
+/* Initializes WQ as an empty queue named NAME whose work runs at
+   PRIORITY, and makes it visible to the workers. */
+void
+workqueue_create (struct workqueue *wq, const char *name, int priority)
+{
+  enum intr_level old_level;
+
+  ASSERT (wq != NULL);
+  ASSERT (PRI_MIN <= priority && priority <= PRI_MAX);
+
+  wq->name = name;
+  wq->priority = priority;
+  list_init (&wq->pending);
+  wq->depth = wq->max_depth = 0;
+  wq->queued_cnt = wq->done_cnt = 0;
+  wq->total_latency = wq->max_latency = 0;
+
+  old_level = intr_disable ();
+  list_insert_ordered (&workqueues, &wq->elem, workqueue_more, NULL);
+  intr_set_level (old_level);
+}
+
+/* Initializes W to call FUNC with AUX when run. */
+void
+work_init (struct work *w, work_func *func, void *aux)
+{
+  ASSERT (w != NULL);
+  ASSERT (func != NULL);
+
+  w->func = func;
+  w->aux = aux;
+  w->wq = NULL;
+  w->queued_at = 0;
+  w->pending = false;
+}
+
+/* Puts W on WQ.  Interrupts must be off. */
+static void
+enqueue (struct workqueue *wq, struct work *w)
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  w->wq = wq;
+  w->pending = true;
+  w->queued_at = timer_ticks ();
+  list_push_back (&wq->pending, &w->elem);
+  wq->queued_cnt++;
+  if (++wq->depth > wq->max_depth)
+    wq->max_depth = wq->depth;
+  sema_up (&work_avail);
+}
+
+/* Queues W on WQ, to be run by a worker thread at WQ's
+   priority.  Returns false without doing anything if W is
+   already pending.  Never sleeps, so it may be called from an
+   interrupt handler. */
+bool
+queue_work (struct workqueue *wq, struct work *w)
+{
+  enum intr_level old_level;
+  bool queued = false;
+
+  ASSERT (wq != NULL);
+  ASSERT (w != NULL);
+
+  old_level = intr_disable ();
+  if (!w->pending)
+    {
+      enqueue (wq, w);
+      queued = true;
+    }
+  intr_set_level (old_level);
+  return queued;
+}
+
+/* Removes W from its queue if it has not started running yet.
+   Returns true if W was pending.  A work item that is already
+   running is not waited for. */
+bool
+cancel_work (struct work *w)
+{
+  enum intr_level old_level;
+  bool was_pending;
+
+  ASSERT (w != NULL);
+
+  old_level = intr_disable ();
+  was_pending = w->pending;
+  if (was_pending)
+    {
+      list_remove (&w->elem);
+      w->wq->depth--;
+      w->pending = false;
+
+      /* Keep work_avail equal to the number of pending items.
+         It is positive here, because W was counted in it. */
+      sema_try_down (&work_avail);
+    }
+  intr_set_level (old_level);
+  return was_pending;
+}
+
+/* Initializes DW to call FUNC with AUX when run. */
+void
+delayed_work_init (struct delayed_work *dw, work_func *func, void *aux)
+{
+  ASSERT (dw != NULL);
+
+  work_init (&dw->work, func, aux);
+  dw->target = NULL;
+  dw->due = 0;
+  dw->timer_pending = false;
+}
+
+/* Queues DW on WQ after TICKS timer ticks have passed.  Returns
+   false without doing anything if DW is already waiting or
+   pending.  Never sleeps. */
+bool
+queue_delayed_work (struct workqueue *wq, struct delayed_work *dw,
+                    int64_t ticks)
+{
+  enum intr_level old_level;
+  bool queued = false;
+
+  ASSERT (wq != NULL);
+  ASSERT (dw != NULL);
+
+  old_level = intr_disable ();
+  if (!dw->timer_pending && !dw->work.pending)
+    {
+      if (ticks <= 0)
+        enqueue (wq, &dw->work);
+      else
+        {
+          dw->target = wq;
+          dw->due = timer_ticks () + ticks;
+          dw->timer_pending = true;
+          list_insert_ordered (&delayed_list, &dw->timer_elem,
+                               delayed_work_earlier, NULL);
+        }
+      queued = true;
+    }
+  intr_set_level (old_level);
+  return queued;
+}
+
+/* Cancels DW, whether it is still waiting for its delay or is
+   already pending on its queue.  Returns true if it was either. */
+bool
+cancel_delayed_work (struct delayed_work *dw)
+{
+  enum intr_level old_level;
+  bool was_waiting;
+
+  ASSERT (dw != NULL);
+
+  old_level = intr_disable ();
+  was_waiting = dw->timer_pending;
+  if (was_waiting)
+    {
+      list_remove (&dw->timer_elem);
+      dw->timer_pending = false;
+    }
+  intr_set_level (old_level);
+  return cancel_work (&dw->work) || was_waiting;
+}
+
+/* Moves delayed work whose time has come onto its queue.
+   Called by the timer softirq, with interrupts off; when nothing
+   is due this only looks at the head of the list. */
+void
+workqueue_tick (int64_t now)
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  while (!list_empty (&delayed_list))
+    {
+      struct delayed_work *dw = list_entry (list_front (&delayed_list),
+                                            struct delayed_work, timer_elem);
+      if (dw->due > now)
+        break;
+      list_pop_front (&delayed_list);
+      dw->timer_pending = false;
+      if (!dw->work.pending)
+        enqueue (dw->target, &dw->work);
+    }
+}
+
+/* Removes and returns the oldest item on the highest-priority
+   nonempty queue, or a null pointer if every queue is empty.
+   Interrupts must be off. */
+static struct work *
+dequeue (void)
+{
+  struct list_elem *e;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  for (e = list_begin (&workqueues); e != list_end (&workqueues);
+       e = list_next (e))
+    {
+      struct workqueue *wq = list_entry (e, struct workqueue, elem);
+      if (!list_empty (&wq->pending))
+        {
+          struct work *w = list_entry (list_pop_front (&wq->pending),
+                                       struct work, elem);
+          int64_t latency = timer_ticks () - w->queued_at;
+
+          wq->depth--;
+          wq->total_latency += latency;
+          if (latency > wq->max_latency)
+            wq->max_latency = latency;
+          w->pending = false;
+          return w;
+        }
+    }
+  return NULL;
+}
+
+/* Makes the running worker run at PRIORITY.  The -mlfqs and
+   -fair schedulers ignore thread_set_priority(), so there the
+   priority is turned into a niceness instead: each step of nice
+   is worth two of priority under -mlfqs, and PRI_DEFAULT maps to
+   NICE_DEFAULT. */
+static void
+worker_set_priority (int priority)
+{
+  if (thread_mlfqs || thread_fair)
+    {
+      int nice = NICE_DEFAULT - (priority - PRI_DEFAULT) / 2;
+      if (nice < NICE_MIN)
+        nice = NICE_MIN;
+      if (nice > NICE_MAX)
+        nice = NICE_MAX;
+      if (nice != thread_get_nice ())
+        thread_set_nice (nice);
+    }
+  else
+    thread_set_priority (priority);
+}
+
+/* Worker thread.  Repeatedly takes the most urgent pending work
+   item and runs it at its queue's priority. */
+static void
+worker_thread (void *aux UNUSED)
+{
+  for (;;)
+    {
+      enum intr_level old_level;
+      struct workqueue *wq;
+      struct work *w;
+
+      sema_down (&work_avail);
+
+      old_level = intr_disable ();
+      w = dequeue ();
+      intr_set_level (old_level);
+      if (w == NULL)
+        continue;
+      wq = w->wq;
+
+      worker_set_priority (wq->priority);
+      w->func (w);
+
+      /* W may have been freed or requeued by FUNC, so only WQ's
+         counters are touched from here on. */
+      old_level = intr_disable ();
+      wq->done_cnt++;
+      intr_set_level (old_level);
+    }
+}
+
+/* Prints workqueue statistics. */
+void
+workqueue_print_stats (void)
+{
+  struct list_elem *e;
+
+  if (worker_cnt == 0)
+    return;
+  printf ("Workqueue: %zu workers\n", worker_cnt);
+  for (e = list_begin (&workqueues); e != list_end (&workqueues);
+       e = list_next (e))
+    {
+      struct workqueue *wq = list_entry (e, struct workqueue, elem);
+      long long started_cnt = wq->queued_cnt - wq->depth;
+      if (wq->queued_cnt == 0)
+        continue;
+      printf ("  %s: %lld queued, %lld done, depth %zu (max %zu), "
+              "latency avg %"PRId64" max %"PRId64" ticks\n",
+              wq->name, wq->queued_cnt, wq->done_cnt, wq->depth,
+              wq->max_depth,
+              started_cnt > 0 ? wq->total_latency / started_cnt : 0,
+              wq->max_latency);
+    }
+}
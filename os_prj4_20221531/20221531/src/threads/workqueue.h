@@ -0,0 +1,83 @@
+#ifndef THREADS_WORKQUEUE_H
+#define THREADS_WORKQUEUE_H
+
+#include <list.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Deferred work.
+
+   A work item is a function to be called later by one of a pool
+   of kernel worker threads.  Submitting work never sleeps, so it
+   may be done from interrupt handlers and from paths that must
+   not block, such as page eviction.  Work is grouped into
+   workqueues; each queue has a priority, which is the priority
+   its work runs at, and queues with higher priority are drained
+   first.  Under -mlfqs and -fair, which compute priorities
+   themselves, the queue's priority sets its workers' niceness. */
+
+struct work;
+typedef void work_func (struct work *);
+
+/* A unit of deferred work.  Usually embedded in a larger
+   structure, which the function recovers with
+   list_entry()-style pointer arithmetic or through AUX. */
+struct work
+  {
+    struct list_elem elem;      /* Element in workqueue's pending list. */
+    work_func *func;            /* Function to call. */
+    void *aux;                  /* Auxiliary data for FUNC. */
+    struct workqueue *wq;       /* Queue we are pending on, if any. */
+    int64_t queued_at;          /* Tick at which we were queued. */
+    bool pending;               /* Queued but not yet started? */
+  };
+
+/* Work that is queued only after a delay has elapsed. */
+struct delayed_work
+  {
+    struct work work;           /* The work itself. */
+    struct list_elem timer_elem; /* Element in list of delayed work. */
+    struct workqueue *target;   /* Queue to put WORK on when due. */
+    int64_t due;                /* Tick at which WORK becomes due. */
+    bool timer_pending;         /* Waiting for DUE? */
+  };
+
+/* A queue of work items. */
+struct workqueue
+  {
+    const char *name;           /* Name (for debugging). */
+    int priority;               /* Priority at which work runs. */
+    struct list pending;        /* Work waiting for a worker. */
+    struct list_elem elem;      /* Element in list of all queues. */
+
+    /* Statistics. */
+    size_t depth;               /* Current number of pending items. */
+    size_t max_depth;           /* Largest DEPTH seen. */
+    long long queued_cnt;       /* # of items queued. */
+    long long done_cnt;         /* # of items run to completion. */
+    int64_t total_latency;      /* Sum of queue-to-start ticks. */
+    int64_t max_latency;        /* Largest queue-to-start ticks. */
+  };
+
+/* The general-purpose queue, running at PRI_DEFAULT. */
+extern struct workqueue system_wq;
+
+/* Default number of worker threads, overridden by -workers=N. */
+#define WORKQUEUE_DEFAULT_WORKERS 2
+
+void workqueue_init (size_t worker_cnt);
+void workqueue_create (struct workqueue *, const char *name, int priority);
+void workqueue_tick (int64_t now);
+void workqueue_print_stats (void);
+
+void work_init (struct work *, work_func *, void *aux);
+bool queue_work (struct workqueue *, struct work *);
+bool cancel_work (struct work *);
+
+void delayed_work_init (struct delayed_work *, work_func *, void *aux);
+bool queue_delayed_work (struct workqueue *, struct delayed_work *,
+                         int64_t ticks);
+bool cancel_delayed_work (struct delayed_work *);
+
+#endif /* threads/workqueue.h */
@@ -2,20 +2,26 @@
 #include <inttypes.h>
 #include <stdio.h>
 #include "userprog/gdt.h"
+#include "threads/flags.h"
 #include "threads/interrupt.h"
 #include "threads/thread.h"
 #include "threads/vaddr.h"
 #include "threads/palloc.h"
 #include "vm/page.h"
 #include "vm/frame.h"
+#include "vm/shm.h"
 #include "vm/swap.h"
+#include "userprog/pagedir.h"
+#include "userprog/process.h"
+#include "userprog/syscall.h"
+#include "userprog/uaccess.h"
 
 /* Number of page faults processed. */
 static long long page_fault_cnt;
 
-const int EIGHT_MB = 8388608;
 
 static void kill (struct intr_frame *);
+static void debug_exception (struct intr_frame *);
 static void page_fault (struct intr_frame *);
 
 /* Registers handlers for interrupts that can be caused by user
@@ -50,7 +56,8 @@ exception_init (void)
      caused indirectly, e.g. #DE can be caused by dividing by
      0.  */
   intr_register_int (0, 0, INTR_ON, kill, "#DE Divide Error");
-  intr_register_int (1, 0, INTR_ON, kill, "#DB Debug Exception");
+  intr_register_int (1, 0, INTR_OFF, debug_exception,
+                     "#DB Debug Exception");
   intr_register_int (6, 0, INTR_ON, kill, "#UD Invalid Opcode Exception");
   intr_register_int (7, 0, INTR_ON, kill,
                      "#NM Device Not Available Exception");
@@ -115,6 +122,27 @@ kill (struct intr_frame *f)
     }
 }
 
+/* Debug exception handler.
+
+   SYSENTER does not clear the trap flag, so a user program that
+   single-steps into it traps on the first instruction of
+   sysenter_entry, before that has switched to a real kernel
+   stack.  All we may do there is clear the flag and carry on, so
+   this handler runs with interrupts off and does not touch the
+   current thread.  Any other debug exception kills the process
+   as usual. */
+static void
+debug_exception (struct intr_frame *f)
+{
+  if (f->cs == SEL_KCSEG && f->eip == sysenter_entry)
+    {
+      f->eflags &= ~FLAG_TF;
+      return;
+    }
+  intr_enable ();
+  kill (f);
+}
+
 bool handle_mm_fault (struct vm_entry *vme);
 
 /* Page fault handler.  This is a skeleton that must be filled in
@@ -159,21 +187,36 @@ page_fault(struct intr_frame *f)
     user = (f->error_code & PF_U) != 0;
 
    if (not_present) {
+        /* Another thread of the process may be faulting on the
+           same page; whoever gets the lock first brings it in. */
+        bool acquired = vm_acquire();
+        if (pagedir_get_page(thread_current()->pagedir, fault_addr) != NULL) {
+            vm_release(acquired);
+            return;
+        }
+
         /* SPT(보조 페이지 테이블)에 이미 존재하는지 먼저 확인
            (Swap Out된 페이지거나, 파일 매핑된 페이지인 경우) */
         struct vm_entry *vme = find_vme(fault_addr);
         if (vme != NULL) {
             /* 이미 관리되고 있는 페이지라면 복구(Load) 시도 */
-            if (handle_mm_fault(vme)) {
+            bool loaded = handle_mm_fault(vme);
+            vm_release(acquired);
+            if (loaded) {
                 return; 
             }
-            /* 복구 실패 시 종료 */
-            exit(-1);
+            /* 복구 실패 */
+            goto fail;
         }
 
-        /* SPT에 없다면, 그때 스택 확장 조건인지 확인 */
-        if ((PHYS_BASE - EIGHT_MB <= fault_addr && fault_addr < PHYS_BASE) &&
-            (f->esp - 32 <= fault_addr)) 
+        /* SPT에 없다면, 그때 스택 확장 조건인지 확인.
+           Stacks of the process's other threads lie below the
+           main stack.  F's esp is only saved on entry from user
+           mode; a fault in the kernel uses the esp that the
+           current system call came in with. */
+        void *esp = user ? f->esp : thread_current()->user_esp;
+        if ((USER_STACK_BOTTOM <= fault_addr && fault_addr < PHYS_BASE) &&
+            (esp - 32 <= fault_addr)) 
         {
             void *kpage = alloc_page(PAL_USER | PAL_ZERO);
             if (kpage != NULL) {
@@ -184,9 +227,10 @@ page_fault(struct intr_frame *f)
                     new_vme->writable = true;
                     new_vme->is_loaded = true;
 
-                    if (insert_vme(&thread_current()->vm, new_vme)) {
+                    if (insert_vme(&thread_current()->leader->vm, new_vme)) {
                          if (pagedir_set_page(thread_current()->pagedir, new_vme->vaddr, kpage, true)) {
                              add_page_to_frame(kpage, new_vme);
+                             vm_release(acquired);
                              return; 
                          }
                     }
@@ -196,11 +240,20 @@ page_fault(struct intr_frame *f)
             }
             printf("Fail: Fault Addr: %p, Present: %d, Stack Limit Check: %d\n", 
             fault_addr, not_present, 
-            (PHYS_BASE - EIGHT_MB <= fault_addr && fault_addr < PHYS_BASE));
-            /* 스택 확장 실패 시 종료 */
-            exit(-1);
+            (USER_STACK_BOTTOM <= fault_addr && fault_addr < PHYS_BASE));
+            /* 스택 확장 실패 */
+            vm_release(acquired);
+            goto fail;
         }
+        vm_release(acquired);
     }
+
+ fail:
+    /* A bad user address passed to a system call fails the
+       accessor in uaccess.c that touched it, which decides what
+       to do, rather than the process. */
+    if (!user && uaccess_fixup(f))
+        return;
     exit(-1);
 
 
@@ -217,7 +270,7 @@ page_fault(struct intr_frame *f)
 
 bool load_file (void *kpage, struct vm_entry *vme) {
     if (vme->read_bytes > 0) {
-        if (file_read_at(vme->file, kpage, vme->read_bytes, vme->offset) != (int)vme->read_bytes) {
+        if (file_page_read(vme->file, kpage, vme->read_bytes, vme->offset) != (int)vme->read_bytes) {
             return false;
         }
     }
@@ -229,6 +282,9 @@ bool load_file (void *kpage, struct vm_entry *vme) {
 }
 
 bool handle_mm_fault (struct vm_entry *vme) {
+    /* 공유 메모리 페이지는 다른 프로세스가 이미 불러왔을 수 있다 */
+    if (vme->type == VM_SHM) return shm_fault(vme);
+
     /* 1. 물리 프레임 할당 */
     void *kpage = alloc_page(PAL_USER);
     if (kpage == NULL) return false;
@@ -0,0 +1,145 @@
+#include "userprog/exec-cache.h"
+#include <list.h>
+#include "filesys/inode.h"
+#include "threads/malloc.h"
+#include "threads/synch.h"
+
+/* Cache of the layouts of recently executed programs, so that
+   executing one again does not read and check its headers.
+
+   Each entry keeps its inode open, so that the inode, and with
+   it its write count, stays in memory for the entry's lifetime.
+   An entry whose inode has been written since it was made is
+   stale and is dropped on lookup.  An entry is dropped as soon
+   as its inode is removed, so that the cache does not keep a
+   deleted executable's blocks allocated. */
+
+/* Most executables cached at once. */
+#define EXEC_CACHE_SIZE 8
+
+struct exec_cache_entry
+  {
+    struct list_elem elem;      /* Element in `cache'. */
+    struct inode *inode;        /* Executable, held open. */
+    unsigned write_cnt;         /* inode_write_cnt() when read. */
+    struct exec_image image;    /* Its layout. */
+  };
+
+/* Cached executables, most recently used first. */
+static struct list cache;
+static int cache_cnt;
+static struct lock cache_lock;
+
+/* Initializes the exec cache. */
+void
+exec_cache_init (void)
+{
+  list_init (&cache);
+  lock_init (&cache_lock);
+}
+
+/* Returns the entry for INODE, or a null pointer if there is
+   none.  The caller must hold `cache_lock'. */
+static struct exec_cache_entry *
+find_entry (struct inode *inode)
+{
+  struct list_elem *e;
+
+  for (e = list_begin (&cache); e != list_end (&cache); e = list_next (e))
+    {
+      struct exec_cache_entry *ce = list_entry (e, struct exec_cache_entry,
+                                                elem);
+      if (ce->inode == inode)
+        return ce;
+    }
+  return NULL;
+}
+
+/* Removes CE from the cache and frees it.  The caller must hold
+   `cache_lock'. */
+static void
+drop_entry (struct exec_cache_entry *ce)
+{
+  list_remove (&ce->elem);
+  cache_cnt--;
+  inode_close (ce->inode);
+  free (ce);
+}
+
+/* Copies the cached layout of the executable in INODE into
+   *IMAGE and returns true, or returns false if it is not cached
+   or has been written since it was. */
+bool
+exec_cache_lookup (struct inode *inode, struct exec_image *image)
+{
+  struct exec_cache_entry *ce;
+  bool found = false;
+
+  lock_acquire (&cache_lock);
+  ce = find_entry (inode);
+  if (ce != NULL)
+    {
+      if (ce->write_cnt == inode_write_cnt (inode))
+        {
+          list_remove (&ce->elem);
+          list_push_front (&cache, &ce->elem);
+          *image = ce->image;
+          found = true;
+        }
+      else
+        drop_entry (ce);
+    }
+  lock_release (&cache_lock);
+  return found;
+}
+
+/* Caches IMAGE as the layout of the executable in INODE, read
+   from it when its write count was WRITE_CNT.  Makes room by
+   dropping the least recently used entry if necessary.  Does
+   nothing if INODE has been removed or memory is short. */
+void
+exec_cache_insert (struct inode *inode, unsigned write_cnt,
+                   const struct exec_image *image)
+{
+  struct exec_cache_entry *ce;
+
+  lock_acquire (&cache_lock);
+  if (inode_is_removed (inode))
+    {
+      lock_release (&cache_lock);
+      return;
+    }
+  ce = find_entry (inode);
+  if (ce == NULL)
+    {
+      ce = malloc (sizeof *ce);
+      if (ce == NULL)
+        {
+          lock_release (&cache_lock);
+          return;
+        }
+      if (cache_cnt >= EXEC_CACHE_SIZE)
+        drop_entry (list_entry (list_back (&cache),
+                                struct exec_cache_entry, elem));
+      ce->inode = inode_reopen (inode);
+      list_push_front (&cache, &ce->elem);
+      cache_cnt++;
+    }
+  ce->write_cnt = write_cnt;
+  ce->image = *image;
+  lock_release (&cache_lock);
+}
+
+/* Drops the cached layout of the executable in INODE, if any.
+   Called by inode_remove() after marking INODE removed. */
+void
+exec_cache_remove (struct inode *inode)
+{
+  struct exec_cache_entry *ce;
+
+  lock_acquire (&cache_lock);
+  ce = find_entry (inode);
+  if (ce != NULL)
+    drop_entry (ce);
+  lock_release (&cache_lock);
+}
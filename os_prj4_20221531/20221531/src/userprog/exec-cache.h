@@ -0,0 +1,38 @@
+#ifndef USERPROG_EXEC_CACHE_H
+#define USERPROG_EXEC_CACHE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+struct inode;
+
+/* Most loadable segments of an executable that the cache holds.
+   Executables with more are loaded but not cached. */
+#define EXEC_SEGMENT_MAX 8
+
+/* A loadable segment, as load_segment() takes it. */
+struct exec_segment
+  {
+    uint32_t file_page;         /* Page-aligned offset in the file. */
+    uint32_t mem_page;          /* Page-aligned user address. */
+    uint32_t read_bytes;        /* Bytes to read from the file. */
+    uint32_t zero_bytes;        /* Bytes to zero after them. */
+    bool writable;              /* Writable by the process? */
+  };
+
+/* The validated layout of an executable: everything load() reads
+   from its headers. */
+struct exec_image
+  {
+    uint32_t entry;             /* Entry point. */
+    int segment_cnt;            /* Number of segments. */
+    struct exec_segment segments[EXEC_SEGMENT_MAX];
+  };
+
+void exec_cache_init (void);
+bool exec_cache_lookup (struct inode *, struct exec_image *);
+void exec_cache_insert (struct inode *, unsigned write_cnt,
+                        const struct exec_image *);
+void exec_cache_remove (struct inode *);
+
+#endif /* userprog/exec-cache.h */
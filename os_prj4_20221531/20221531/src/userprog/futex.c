@@ -0,0 +1,138 @@
+#include "userprog/futex.h"
+#include <hash.h>
+#include <list.h>
+#include "threads/synch.h"
+#include "threads/vaddr.h"
+#include "userprog/syscall.h"
+#include "userprog/uaccess.h"
+
+/* Number of hash buckets for sleeping threads. */
+#define FUTEX_BUCKETS 64
+
+/* A thread sleeping in futex_wait().  Lives on its stack. */
+struct futex_waiter
+  {
+    struct list_elem elem;      /* Element in a bucket. */
+    struct thread *leader;      /* Process it belongs to. */
+    int *addr;                  /* User address it sleeps on. */
+    struct thread *thread;      /* The sleeping thread. */
+    struct semaphore sema;      /* Upped to wake it. */
+  };
+
+/* Sleeping threads, hashed by address.  One lock covers all
+   buckets: it is only held for short list operations and the
+   comparison in futex_wait(). */
+static struct list buckets[FUTEX_BUCKETS];
+static struct lock futex_lock;
+
+static struct list *
+bucket_of (int *addr)
+{
+  return &buckets[hash_int ((int) addr) % FUTEX_BUCKETS];
+}
+
+/* Initializes the futex hash table. */
+void
+futex_init (void)
+{
+  size_t i;
+
+  for (i = 0; i < FUTEX_BUCKETS; i++)
+    list_init (&buckets[i]);
+  lock_init (&futex_lock);
+}
+
+/* If the word at user address ADDR still holds VAL, sleeps until
+   futex_wake() is called on ADDR; otherwise returns at once.
+   The comparison and going to sleep are atomic with respect to
+   futex_wake().  Returns 0 after being woken, -1 if the word
+   did not hold VAL or the process is exiting. */
+int
+futex_wait (int *addr, int val)
+{
+  struct thread *cur = thread_current ();
+  struct futex_waiter w;
+  int cur_val;
+
+  if ((uintptr_t) addr % sizeof *addr != 0)
+    return -1;
+
+  lock_acquire (&futex_lock);
+  if (!copy_from_user (&cur_val, addr, sizeof cur_val))
+    {
+      lock_release (&futex_lock);
+      exit (-1);
+    }
+  if (cur_val != val || cur->leader->exiting)
+    {
+      lock_release (&futex_lock);
+      return -1;
+    }
+  w.leader = cur->leader;
+  w.addr = addr;
+  w.thread = cur;
+  sema_init (&w.sema, 0);
+  list_push_back (bucket_of (addr), &w.elem);
+  lock_release (&futex_lock);
+
+  sema_down (&w.sema);
+  return 0;
+}
+
+/* Wakes up to CNT threads of the calling process sleeping on
+   user address ADDR, highest priority first.
+   Returns the number of threads woken. */
+int
+futex_wake (int *addr, int cnt)
+{
+  struct thread *leader = thread_current ()->leader;
+  struct list *bucket = bucket_of (addr);
+  int woken = 0;
+
+  lock_acquire (&futex_lock);
+  while (woken < cnt)
+    {
+      struct futex_waiter *best = NULL;
+      struct list_elem *e;
+
+      for (e = list_begin (bucket); e != list_end (bucket); e = list_next (e))
+        {
+          struct futex_waiter *w = list_entry (e, struct futex_waiter, elem);
+          if (w->leader == leader && w->addr == addr
+              && (best == NULL || w->thread->priority > best->thread->priority))
+            best = w;
+        }
+      if (best == NULL)
+        break;
+      list_remove (&best->elem);
+      sema_up (&best->sema);
+      woken++;
+    }
+  lock_release (&futex_lock);
+  return woken;
+}
+
+/* Wakes every thread of the process led by LEADER, which is
+   exiting, wherever it sleeps. */
+void
+futex_wake_process (struct thread *leader)
+{
+  size_t i;
+
+  lock_acquire (&futex_lock);
+  for (i = 0; i < FUTEX_BUCKETS; i++)
+    {
+      struct list_elem *e = list_begin (&buckets[i]);
+      while (e != list_end (&buckets[i]))
+        {
+          struct futex_waiter *w = list_entry (e, struct futex_waiter, elem);
+          e = list_next (e);
+          if (w->leader == leader)
+            {
+              list_remove (&w->elem);
+              sema_up (&w->sema);
+            }
+        }
+    }
+  lock_release (&futex_lock);
+}
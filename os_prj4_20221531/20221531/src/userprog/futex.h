@@ -0,0 +1,16 @@
+#ifndef USERPROG_FUTEX_H
+#define USERPROG_FUTEX_H
+
+#include "threads/thread.h"
+
+/* Futexes: threads of a user process sleep on the address of a
+   word in their shared address space and are woken by address.
+   Userspace only calls in when it finds the word contended, so
+   uncontended locks built on top never enter the kernel. */
+
+void futex_init (void);
+int futex_wait (int *addr, int val);
+int futex_wake (int *addr, int cnt);
+void futex_wake_process (struct thread *leader);
+
+#endif /* userprog/futex.h */
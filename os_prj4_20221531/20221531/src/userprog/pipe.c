@@ -0,0 +1,377 @@
+#include "userprog/pipe.h"
+#include <debug.h>
+#include <stdint.h>
+#include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+#include "userprog/syscall.h"
+#include "userprog/uaccess.h"
+#include "vm/frame.h"
+
+/* Size of the FD table in struct thread. */
+#define FD_CNT 128
+
+/* Pages in a pipe's buffer.  A power of 2. */
+#define PIPE_PAGES 16
+#define PIPE_SIZE (PIPE_PAGES * PGSIZE)
+
+/* A pipe.
+
+   The data is kept in a ring of pages: byte offset POS of the
+   stream is at pages[POS / PGSIZE % PIPE_PAGES][POS % PGSIZE].
+   HEAD and TAIL only ever increase; they wrap around at 2**32,
+   which is a multiple of PIPE_SIZE.
+
+   When a reader asks for a whole page of data into a page-aligned
+   buffer, and a whole page is waiting at HEAD, the pipe's page
+   is mapped into the reader's address space in place of the
+   buffer's page, which takes the pipe page's place in the ring.
+   The writer still copies, because it keeps its buffer.
+
+   Waiting is on condition variables, so the highest-priority
+   waiter wakes first. */
+struct pipe
+  {
+    struct lock lock;           /* Protects everything below. */
+    struct condition readable;  /* Data arrived or writers left. */
+    struct condition writable;  /* Room freed or readers left. */
+    uint8_t *pages[PIPE_PAGES]; /* The buffer. */
+    unsigned head;              /* Offset of the next byte to read. */
+    unsigned tail;              /* Offset of the next byte to write. */
+    int readers;                /* Open read ends. */
+    int writers;                /* Open write ends. */
+    int ref_cnt;                /* Open ends plus calls in progress. */
+  };
+
+/* One descriptor's end of a pipe.  Each process that uses pipes
+   has an array of FD_CNT of them, `pipes' in its leader,
+   protected by the leader's `fd_lock' like `FD'. */
+struct pipe_end
+  {
+    struct pipe *pipe;          /* Null if the descriptor is not a pipe. */
+    bool writer;                /* Write end? */
+  };
+
+static void close_end (struct thread *leader, int fd);
+static void yield_if_woken_higher (void);
+
+/* Creates a pipe and stores its read and write descriptors, in
+   that order, in the two ints at UFDS.  Returns 0 if successful,
+   -1 if memory or descriptors ran out. */
+int
+pipe_create (int *ufds)
+{
+  struct thread *leader = thread_current ()->leader;
+  struct pipe *p;
+  int fds[2];
+  int i, n;
+
+  if (!fault_in_user (ufds, sizeof fds, true))
+    exit (-1);
+
+  p = calloc (1, sizeof *p);
+  if (p == NULL)
+    return -1;
+  for (i = 0; i < PIPE_PAGES; i++)
+    if ((p->pages[i] = palloc_get_page (PAL_USER)) == NULL)
+      goto fail;
+  lock_init (&p->lock);
+  cond_init (&p->readable);
+  cond_init (&p->writable);
+  p->readers = p->writers = p->ref_cnt = 1;
+
+  rwlock_acquire_write (&leader->fd_lock);
+  if (leader->pipes == NULL)
+    leader->pipes = calloc (FD_CNT, sizeof *leader->pipes);
+  for (i = 2, n = 0; leader->pipes != NULL && i < FD_CNT && n < 2; i++)
+    if (leader->FD[i] == NULL && leader->pipes[i].pipe == NULL)
+      fds[n++] = i;
+  if (n < 2)
+    {
+      rwlock_release_write (&leader->fd_lock);
+      goto fail;
+    }
+  leader->pipes[fds[0]].pipe = leader->pipes[fds[1]].pipe = p;
+  leader->pipes[fds[0]].writer = false;
+  leader->pipes[fds[1]].writer = true;
+  p->ref_cnt = 2;
+  rwlock_release_write (&leader->fd_lock);
+
+  if (!copy_to_user (ufds, fds, sizeof fds))
+    {
+      pipe_close (fds[0]);
+      pipe_close (fds[1]);
+      exit (-1);
+    }
+  return 0;
+
+ fail:
+  for (i = 0; i < PIPE_PAGES; i++)
+    palloc_free_page (p->pages[i]);
+  free (p);
+  return -1;
+}
+
+/* Returns the pipe whose write end, if WRITER, or read end, if
+   not, is descriptor FD of the current process, with a reference
+   that the caller must drop with pipe_put().  Returns a null
+   pointer if FD is not such an end. */
+struct pipe *
+pipe_get (int fd, bool writer)
+{
+  struct thread *leader = thread_current ()->leader;
+  struct pipe *p = NULL;
+
+  if (fd < 0 || fd >= FD_CNT)
+    return NULL;
+
+  rwlock_acquire_read (&leader->fd_lock);
+  if (leader->pipes != NULL && leader->pipes[fd].pipe != NULL
+      && leader->pipes[fd].writer == writer)
+    {
+      p = leader->pipes[fd].pipe;
+      lock_acquire (&p->lock);
+      p->ref_cnt++;
+      lock_release (&p->lock);
+    }
+  rwlock_release_read (&leader->fd_lock);
+  return p;
+}
+
+/* Drops a reference to P, freeing it if it was the last. */
+void
+pipe_put (struct pipe *p)
+{
+  bool last;
+  int i;
+
+  lock_acquire (&p->lock);
+  last = --p->ref_cnt == 0;
+  lock_release (&p->lock);
+
+  if (last)
+    {
+      for (i = 0; i < PIPE_PAGES; i++)
+        palloc_free_page (p->pages[i]);
+      free (p);
+    }
+}
+
+/* Reads up to SIZE bytes from P into user buffer UBUF, waiting
+   until at least one byte is available unless P has no writers
+   left.  Returns the number of bytes read, 0 at end of file, or
+   -1 if UBUF is bad. */
+int
+pipe_read (struct pipe *p, void *ubuf, unsigned size)
+{
+  uint8_t *dst = ubuf;
+  unsigned done = 0;
+  bool failed = false;
+
+  lock_acquire (&p->lock);
+  while (p->head == p->tail && p->writers > 0 && size > 0)
+    cond_wait (&p->readable, &p->lock);
+
+  while (done < size && p->head != p->tail)
+    {
+      unsigned slot = p->head / PGSIZE % PIPE_PAGES;
+      unsigned ofs = p->head % PGSIZE;
+      unsigned chunk = PGSIZE - ofs;
+      void *old;
+
+      if (chunk > p->tail - p->head)
+        chunk = p->tail - p->head;
+      if (chunk > size - done)
+        chunk = size - done;
+
+      if (chunk == PGSIZE && pg_ofs (dst + done) == 0
+          && (old = frame_exchange (dst + done, p->pages[slot])) != NULL)
+        p->pages[slot] = old;
+      else if (!copy_to_user (dst + done, p->pages[slot] + ofs, chunk))
+        {
+          failed = true;
+          break;
+        }
+      p->head += chunk;
+      done += chunk;
+    }
+
+  if (done > 0)
+    cond_signal (&p->writable, &p->lock);
+  if (p->head != p->tail)
+    cond_signal (&p->readable, &p->lock);
+  lock_release (&p->lock);
+  yield_if_woken_higher ();
+
+  return failed && done == 0 ? -1 : (int) done;
+}
+
+/* Writes the SIZE bytes in user buffer UBUF to P, waiting for
+   room as necessary.  Returns the number of bytes written, which
+   is less than SIZE only if every read end was closed or UBUF is
+   bad; -1 if that happened before any byte was written. */
+int
+pipe_write (struct pipe *p, const void *ubuf, unsigned size)
+{
+  const uint8_t *src = ubuf;
+  unsigned done = 0;
+  bool failed = false;
+
+  lock_acquire (&p->lock);
+  while (done < size)
+    {
+      unsigned slot = p->tail / PGSIZE % PIPE_PAGES;
+      unsigned ofs = p->tail % PGSIZE;
+      unsigned chunk = PGSIZE - ofs;
+
+      if (p->readers == 0)
+        {
+          failed = true;
+          break;
+        }
+      if (p->tail - p->head == PIPE_SIZE)
+        {
+          cond_signal (&p->readable, &p->lock);
+          cond_wait (&p->writable, &p->lock);
+          continue;
+        }
+
+      if (chunk > PIPE_SIZE - (p->tail - p->head))
+        chunk = PIPE_SIZE - (p->tail - p->head);
+      if (chunk > size - done)
+        chunk = size - done;
+      if (!copy_from_user (p->pages[slot] + ofs, src + done, chunk))
+        {
+          failed = true;
+          break;
+        }
+      p->tail += chunk;
+      done += chunk;
+    }
+
+  if (p->head != p->tail)
+    cond_signal (&p->readable, &p->lock);
+  if (p->tail - p->head < PIPE_SIZE)
+    cond_signal (&p->writable, &p->lock);
+  lock_release (&p->lock);
+  yield_if_woken_higher ();
+
+  return failed && done == 0 ? -1 : (int) done;
+}
+
+/* Closes descriptor FD of the current process if it is a pipe
+   end, and returns true, or returns false if it is not. */
+bool
+pipe_close (int fd)
+{
+  struct thread *leader = thread_current ()->leader;
+  bool is_pipe;
+
+  if (fd < 0 || fd >= FD_CNT)
+    return false;
+
+  rwlock_acquire_read (&leader->fd_lock);
+  is_pipe = leader->pipes != NULL && leader->pipes[fd].pipe != NULL;
+  rwlock_release_read (&leader->fd_lock);
+
+  if (is_pipe)
+    close_end (leader, fd);
+  return is_pipe;
+}
+
+/* Returns true if descriptor FD of the process led by LEADER is
+   a pipe end.  The caller must hold LEADER's `fd_lock'. */
+bool
+pipe_fd_used (struct thread *leader, int fd)
+{
+  return leader->pipes != NULL && leader->pipes[fd].pipe != NULL;
+}
+
+/* Gives CHILD, a new process, PARENT's pipe ends under the same
+   descriptors.  Returns false if memory ran out. */
+bool
+pipe_inherit (struct thread *child, struct thread *parent)
+{
+  bool success = true;
+  int fd;
+
+  rwlock_acquire_read (&parent->fd_lock);
+  if (parent->pipes != NULL)
+    {
+      child->pipes = calloc (FD_CNT, sizeof *child->pipes);
+      if (child->pipes == NULL)
+        success = false;
+      for (fd = 0; child->pipes != NULL && fd < FD_CNT; fd++)
+        {
+          struct pipe *p = parent->pipes[fd].pipe;
+          if (p == NULL)
+            continue;
+
+          child->pipes[fd] = parent->pipes[fd];
+          lock_acquire (&p->lock);
+          if (child->pipes[fd].writer)
+            p->writers++;
+          else
+            p->readers++;
+          p->ref_cnt++;
+          lock_release (&p->lock);
+        }
+    }
+  rwlock_release_read (&parent->fd_lock);
+  return success;
+}
+
+/* Closes every pipe end of the exiting process led by LEADER. */
+void
+pipe_exit (struct thread *leader)
+{
+  int fd;
+
+  if (leader->pipes == NULL)
+    return;
+  for (fd = 0; fd < FD_CNT; fd++)
+    if (leader->pipes[fd].pipe != NULL)
+      close_end (leader, fd);
+  free (leader->pipes);
+  leader->pipes = NULL;
+}
+
+/* Closes pipe end FD of the process led by LEADER, waking
+   everyone waiting on the other end if it was the last end of
+   its kind, and drops its reference. */
+static void
+close_end (struct thread *leader, int fd)
+{
+  struct pipe_end end;
+  struct pipe *p;
+
+  /* Another thread of the process may have closed FD since the
+     caller looked. */
+  rwlock_acquire_write (&leader->fd_lock);
+  end = leader->pipes[fd];
+  leader->pipes[fd].pipe = NULL;
+  rwlock_release_write (&leader->fd_lock);
+  p = end.pipe;
+  if (p == NULL)
+    return;
+
+  lock_acquire (&p->lock);
+  if (end.writer && --p->writers == 0)
+    cond_broadcast (&p->readable, &p->lock);
+  else if (!end.writer && --p->readers == 0)
+    cond_broadcast (&p->writable, &p->lock);
+  lock_release (&p->lock);
+  pipe_put (p);
+}
+
+/* Yields the CPU if a thread that was just woken up outranks the
+   current one, so that a high-priority reader or writer gets to
+   run as soon as its pipe is ready. */
+static void
+yield_if_woken_higher (void)
+{
+  if (thread_current ()->priority < get_max_priority ())
+    thread_yield ();
+}
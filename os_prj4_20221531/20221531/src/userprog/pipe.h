@@ -0,0 +1,24 @@
+#ifndef USERPROG_PIPE_H
+#define USERPROG_PIPE_H
+
+#include <stdbool.h>
+
+struct thread;
+struct pipe;
+
+/* Pipes: a one-way byte stream between a pair of descriptors in
+   the same FD number space as files, kept in a ring of pages.
+   A child started by exec() inherits its parent's pipe ends. */
+
+int pipe_create (int *ufds);
+struct pipe *pipe_get (int fd, bool writer);
+void pipe_put (struct pipe *);
+int pipe_read (struct pipe *, void *ubuf, unsigned size);
+int pipe_write (struct pipe *, const void *ubuf, unsigned size);
+bool pipe_close (int fd);
+
+bool pipe_fd_used (struct thread *leader, int fd);
+bool pipe_inherit (struct thread *child, struct thread *parent);
+void pipe_exit (struct thread *leader);
+
+#endif /* userprog/pipe.h */
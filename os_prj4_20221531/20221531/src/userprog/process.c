@@ -21,13 +21,52 @@
 #include "vm/frame.h"
 #include "userprog/syscall.h"
 #include "threads/synch.h"
+#include "threads/malloc.h"
 #include "userprog/syscall.h"
+#include "userprog/futex.h"
+#include "userprog/pipe.h"
+#include "userprog/exec-cache.h"
+#include "userprog/trace.h"
+#include "filesys/inode.h"
 
-extern struct lock filesys_lock;
+
+/* Join record for a thread of a multithreaded process other
+   than its leader.  Kept in the leader's `uthreads' list until
+   joined or until the process exits. */
+struct uthread
+  {
+    struct list_elem elem;      /* Element in leader's `uthreads'. */
+    tid_t tid;                  /* Thread identifier. */
+    int slot;                   /* User stack slot. */
+    int status;                 /* Exit status. */
+    bool joined;                /* Somebody is joining it. */
+    struct semaphore done;      /* Upped when it exits. */
+  };
+
+/* Passed from process_execute() to start_process(). */
+struct process_start
+  {
+    char cmd_line[CMDLINE_MAX]; /* Command line. */
+    struct thread *parent;      /* Leader of the executing process. */
+  };
+
+/* Passed from process_thread_create() to start_uthread(). */
+struct uthread_start
+  {
+    struct thread *leader;      /* Process to join. */
+    struct uthread *uthread;    /* Join record. */
+    void *eip;                  /* User entry point. */
+    void *esp;                  /* Initial user stack pointer. */
+    struct semaphore started;   /* Upped once the above are read. */
+  };
 
 static thread_func start_process NO_RETURN;
+static thread_func start_uthread NO_RETURN;
 static bool load (const char *cmdline, void (**eip) (void), void **esp);
 static struct thread *get_child_process(tid_t child_tid);
+static bool install_stack_page (void *upage);
+static void uthread_finish (void);
+static void reap_uthreads (void);
 
 
 /* Starts a new thread running a user program loaded from
@@ -39,14 +78,13 @@ static struct thread *get_child_process(tid_t child_tid);
 tid_t
 process_execute (const char *file_name) 
 {
-  char *fn_copy;
+  struct process_start start;
   tid_t tid;
 
-  /* 1. 명령어 복사본 생성 */
-  fn_copy = palloc_get_page (0);
-  if (fn_copy == NULL)
-    return TID_ERROR;
-  strlcpy (fn_copy, file_name, PGSIZE);
+  /* 1. 명령어 복사본 생성.  We wait below until the child has
+     finished loading, so the copy can live on our stack. */
+  strlcpy (start.cmd_line, file_name, sizeof start.cmd_line);
+  start.parent = thread_current ()->leader;
 
   /* 2. 프로그램 이름 파싱 */
   char prog_name[128];
@@ -55,11 +93,10 @@ process_execute (const char *file_name)
   if (space_ptr != NULL) *space_ptr = '\0';
   
   /* 3. 스레드 생성 */
-  tid = thread_create(prog_name, PRI_DEFAULT, start_process, fn_copy);
+  tid = thread_create(prog_name, PRI_DEFAULT, start_process, &start);
 
   /* 4. 스레드 생성 실패를 "즉시" 확인 */
   if (tid == TID_ERROR) {
-    palloc_free_page(fn_copy);
     return TID_ERROR;
   }
   
@@ -83,9 +120,10 @@ process_execute (const char *file_name)
 /* A thread function that loads a user process and starts it
    running. */
 static void
-start_process (void *file_name_)
+start_process (void *start_)
 {
-  char *file_name = file_name_;
+  struct process_start *start = start_;
+  char *file_name = start->cmd_line;
   struct intr_frame if_;
   bool success;
   struct thread *t = thread_current();
@@ -96,11 +134,8 @@ start_process (void *file_name_)
   if_.gs = if_.fs = if_.es = if_.ds = if_.ss = SEL_UDSEG;
   if_.cs = SEL_UCSEG;
   if_.eflags = FLAG_IF | FLAG_MBS;
-  success = load (file_name, &if_.eip, &if_.esp);
-
-  /* If load failed, quit. */
-  palloc_free_page (file_name);
-
+  success = load (file_name, &if_.eip, &if_.esp)
+            && pipe_inherit (t, start->parent);
 
   // 로드 결과를 자신의 구조체에 기록
   thread_current()->load_success = success;
@@ -109,6 +144,8 @@ start_process (void *file_name_)
 
   if (!success) 
     thread_exit ();
+  if (trace_all)
+    trace (true);
 
   /* Start the user process by simulating a return from an
      interrupt, implemented by intr_exit (in
@@ -120,6 +157,212 @@ start_process (void *file_name_)
   NOT_REACHED ();
 }
 
+/* Starts a new thread in the current process, running user
+   code at ENTRY with FUNC and AUX as its two arguments, on a
+   fresh stack in one of the process's stack slots.  The thread
+   shares the address space, file descriptors and memory
+   mappings of every other thread of the process.  Returns the
+   new thread's id, or TID_ERROR if it cannot be created. */
+tid_t
+process_thread_create (void *entry, void *func, void *aux)
+{
+  struct thread *cur = thread_current ();
+  struct thread *leader = cur->leader;
+  struct uthread_start start;
+  struct uthread *u;
+  enum intr_level old_level;
+  uint32_t *sp;
+  tid_t tid;
+  int slot;
+
+  u = malloc (sizeof *u);
+  if (u == NULL)
+    return TID_ERROR;
+
+  lock_acquire (&leader->uthread_lock);
+  for (slot = 0; slot < UTHREAD_MAX; slot++)
+    if ((leader->stack_slots & (1u << slot)) == 0)
+      break;
+  sp = (uint32_t *) ((uint8_t *) PHYS_BASE - USER_STACK_MAX
+                     - slot * UTHREAD_STACK_MAX);
+  if (leader->exiting || slot == UTHREAD_MAX
+      || !install_stack_page ((uint8_t *) sp - PGSIZE))
+    {
+      lock_release (&leader->uthread_lock);
+      free (u);
+      return TID_ERROR;
+    }
+
+  /* Lay out the stack as if ENTRY had been called as
+     entry (FUNC, AUX). */
+  *--sp = (uint32_t) aux;
+  *--sp = (uint32_t) func;
+  *--sp = 0;
+
+  u->tid = TID_ERROR;
+  u->slot = slot;
+  u->status = -1;
+  u->joined = false;
+  sema_init (&u->done, 0);
+  list_push_back (&leader->uthreads, &u->elem);
+
+  /* uthread_finish() updates these with interrupts off. */
+  old_level = intr_disable ();
+  leader->stack_slots |= 1u << slot;
+  leader->uthread_cnt++;
+  intr_set_level (old_level);
+
+  start.leader = leader;
+  start.uthread = u;
+  start.eip = entry;
+  start.esp = sp;
+  sema_init (&start.started, 0);
+  tid = thread_create (leader->name, cur->priority, start_uthread, &start);
+  if (tid != TID_ERROR)
+    sema_down (&start.started);
+  else
+    {
+      old_level = intr_disable ();
+      leader->stack_slots &= ~(1u << slot);
+      leader->uthread_cnt--;
+      intr_set_level (old_level);
+      list_remove (&u->elem);
+      free (u);
+    }
+  lock_release (&leader->uthread_lock);
+  return tid;
+}
+
+/* A thread function that joins a new thread to a user process
+   and starts it running. */
+static void
+start_uthread (void *start_)
+{
+  struct uthread_start *start = start_;
+  struct thread *cur = thread_current ();
+  struct intr_frame if_;
+  enum intr_level old_level;
+
+  /* init_thread() made us a child process of our creator.  We
+     are not; nobody may process_wait() for us. */
+  old_level = intr_disable ();
+  list_remove (&cur->child_elem);
+  intr_set_level (old_level);
+
+  cur->leader = start->leader;
+  cur->uthread = start->uthread;
+  cur->uthread->tid = cur->tid;
+  cur->pagedir = cur->leader->pagedir;
+  process_activate ();
+
+  memset (&if_, 0, sizeof if_);
+  if_.gs = if_.fs = if_.es = if_.ds = if_.ss = SEL_UDSEG;
+  if_.cs = SEL_UCSEG;
+  if_.eflags = FLAG_IF | FLAG_MBS;
+  if_.eip = start->eip;
+  if_.esp = start->esp;
+  sema_up (&start->started);
+
+  if (cur->leader->exiting)
+    thread_exit ();
+  asm volatile ("movl %0, %%esp; jmp intr_exit" : : "g" (&if_) : "memory");
+  NOT_REACHED ();
+}
+
+/* Terminates the calling thread with the given exit STATUS,
+   which process_thread_join() returns.  In the process leader,
+   terminates the whole process instead. */
+void
+process_thread_exit (int status)
+{
+  struct thread *cur = thread_current ();
+
+  if (cur->leader == cur)
+    exit (status);
+  cur->exit_status = status;
+  thread_exit ();
+}
+
+/* Waits for thread TID of the current process to exit and
+   returns its exit status.  Returns -1 at once if TID is not a
+   thread of the current process other than its leader and the
+   caller, or if it is already being joined. */
+int
+process_thread_join (tid_t tid)
+{
+  struct thread *leader = thread_current ()->leader;
+  struct uthread *u = NULL;
+  struct list_elem *e;
+  int status;
+
+  if (tid == thread_current ()->tid)
+    return -1;
+
+  lock_acquire (&leader->uthread_lock);
+  for (e = list_begin (&leader->uthreads); e != list_end (&leader->uthreads);
+       e = list_next (e))
+    {
+      struct uthread *t = list_entry (e, struct uthread, elem);
+      if (t->tid == tid && !t->joined)
+        {
+          u = t;
+          u->joined = true;
+          break;
+        }
+    }
+  lock_release (&leader->uthread_lock);
+  if (u == NULL)
+    return -1;
+
+  sema_down (&u->done);
+  status = u->status;
+  lock_acquire (&leader->uthread_lock);
+  list_remove (&u->elem);
+  lock_release (&leader->uthread_lock);
+  free (u);
+  return status;
+}
+
+/* Terminates the whole current process with exit STATUS, called
+   by a thread other than the leader.  The other threads notice
+   the next time they enter the kernel, in
+   process_check_exiting(), and the leader reports STATUS. */
+void
+process_exit_group (int status)
+{
+  struct thread *leader = thread_current ()->leader;
+  enum intr_level old_level;
+
+  old_level = intr_disable ();
+  if (!leader->exiting)
+    {
+      leader->exit_status = status;
+      leader->exiting = true;
+    }
+  intr_set_level (old_level);
+
+  futex_wake_process (leader);
+  thread_exit ();
+}
+
+/* Called on every interrupt, exception and system call from
+   user mode, just before returning to user mode.  Terminates
+   the current thread if its process is exiting. */
+void
+process_check_exiting (void)
+{
+  struct thread *cur = thread_current ();
+
+  if (!cur->leader->exiting)
+    return;
+
+  intr_enable ();
+  if (cur->leader == cur)
+    exit (cur->exit_status);
+  cur->exit_status = -1;
+  thread_exit ();
+}
+
 /* Waits for thread TID to die and returns its exit status.  If
    it was terminated by the kernel (i.e. killed due to an
    exception), returns -1.  If TID is invalid or if it was not a
@@ -183,9 +426,21 @@ process_exit (void)
   struct thread *cur = thread_current ();
   uint32_t *pd;
 
-  if (lock_held_by_current_thread(&filesys_lock)) {
-      lock_release(&filesys_lock);
+  vm_release(lock_held_by_current_thread(&cur->leader->vm_lock));
+
+  if (cur->leader != cur) {
+      uthread_finish();
+      return;
   }
+  reap_uthreads();
+  trace_exit(cur);
+
+  for (int i = 2; i < 128; i++) {
+    if (cur->FD[i] != NULL) {
+      close(i);
+    }
+  }
+  pipe_exit(cur);
 
   while (!list_empty(&cur->mmap_list)) {
       struct list_elem *e = list_begin(&cur->mmap_list);
@@ -214,6 +469,57 @@ process_exit (void)
     sema_down(&(cur->reap_done_sema));
 }
 
+/* process_exit() for a thread other than its process's leader:
+   reports its exit status to joiners and to the leader, which
+   frees the shared resources once the last thread is gone. */
+static void
+uthread_finish (void)
+{
+  struct thread *cur = thread_current ();
+  struct thread *leader = cur->leader;
+  struct uthread *u = cur->uthread;
+  enum intr_level old_level;
+
+  /* The leader destroys the page directory as soon as we
+     signal, so stop using it first. */
+  cur->pagedir = NULL;
+  pagedir_activate (NULL);
+
+  old_level = intr_disable ();
+  u->status = cur->exit_status;
+  leader->stack_slots &= ~(1u << u->slot);
+  sema_up (&u->done);
+  if (--leader->uthread_cnt == 0 && leader->exiting)
+    sema_up (&leader->uthreads_gone);
+  intr_set_level (old_level);
+}
+
+/* Called by an exiting process leader: waits for the process's
+   other threads, which terminate the next time they enter the
+   kernel, and frees their join records. */
+static void
+reap_uthreads (void)
+{
+  struct thread *cur = thread_current ();
+  enum intr_level old_level;
+  bool live;
+
+  lock_acquire (&cur->uthread_lock);
+  old_level = intr_disable ();
+  cur->exiting = true;
+  live = cur->uthread_cnt > 0;
+  intr_set_level (old_level);
+  lock_release (&cur->uthread_lock);
+
+  if (live)
+    {
+      futex_wake_process (cur);
+      sema_down (&cur->uthreads_gone);
+    }
+  while (!list_empty (&cur->uthreads))
+    free (list_entry (list_pop_front (&cur->uthreads), struct uthread, elem));
+}
+
 /* Sets up the CPU for running user code in the current
    thread.
    This function is called on every context switch. */
@@ -295,10 +601,104 @@ struct Elf32_Phdr
 
 static bool setup_stack (void **esp);
 static bool validate_segment (const struct Elf32_Phdr *, struct file *);
+static int read_image (struct file *, const char *file_name,
+                       struct exec_image *, struct exec_segment *, int);
 static bool load_segment (struct file *file, off_t ofs, uint8_t *upage,
                           uint32_t read_bytes, uint32_t zero_bytes,
                           bool writable);
 
+/* Reads and checks the executable header and program headers of
+   FILE, the executable named FILE_NAME.  Stores the entry point
+   into *IMAGE and the layout of the first SEG_MAX loadable
+   segments into SEGS.
+   Returns the number of loadable segments, which may be more
+   than SEG_MAX, or -1 if the executable is not valid. */
+static int
+read_image (struct file *file, const char *file_name,
+            struct exec_image *image, struct exec_segment *segs,
+            int seg_max)
+{
+  struct Elf32_Ehdr ehdr;
+  off_t file_ofs;
+  int seg_cnt = 0;
+  int i;
+
+  /* Read and verify executable header. */
+  if (file_read (file, &ehdr, sizeof ehdr) != sizeof ehdr
+      || memcmp (ehdr.e_ident, "\177ELF\1\1\1", 7)
+      || ehdr.e_type != 2
+      || ehdr.e_machine != 3
+      || ehdr.e_version != 1
+      || ehdr.e_phentsize != sizeof (struct Elf32_Phdr)
+      || ehdr.e_phnum > 1024) 
+    {
+      printf ("load: %s: error loading executable\n", file_name);
+      return -1;
+    }
+
+  image->entry = ehdr.e_entry;
+
+  /* Read program headers. */
+  file_ofs = ehdr.e_phoff;
+  for (i = 0; i < ehdr.e_phnum; i++) 
+    {
+      struct Elf32_Phdr phdr;
+
+      if (file_ofs < 0 || file_ofs > file_length (file))
+        return -1;
+      file_seek (file, file_ofs);
+
+      if (file_read (file, &phdr, sizeof phdr) != sizeof phdr)
+        return -1;
+      file_ofs += sizeof phdr;
+      switch (phdr.p_type) 
+        {
+        case PT_NULL:
+        case PT_NOTE:
+        case PT_PHDR:
+        case PT_STACK:
+        default:
+          /* Ignore this segment. */
+          break;
+        case PT_DYNAMIC:
+        case PT_INTERP:
+        case PT_SHLIB:
+          return -1;
+        case PT_LOAD:
+          if (!validate_segment (&phdr, file))
+            return -1;
+          if (seg_cnt++ < seg_max)
+            {
+              struct exec_segment *seg = &segs[seg_cnt - 1];
+              uint32_t page_offset = phdr.p_vaddr & PGMASK;
+              seg->writable = (phdr.p_flags & PF_W) != 0;
+              seg->file_page = phdr.p_offset & ~PGMASK;
+              seg->mem_page = phdr.p_vaddr & ~PGMASK;
+              if (phdr.p_filesz > 0)
+                {
+                  /* Normal segment.
+                     Read initial part from disk and zero the rest. */
+                  seg->read_bytes = page_offset + phdr.p_filesz;
+                  seg->zero_bytes = (ROUND_UP (page_offset + phdr.p_memsz,
+                                               PGSIZE)
+                                     - seg->read_bytes);
+                }
+              else 
+                {
+                  /* Entirely zero.
+                     Don't read anything from disk. */
+                  seg->read_bytes = 0;
+                  seg->zero_bytes = ROUND_UP (page_offset + phdr.p_memsz,
+                                              PGSIZE);
+                }
+            }
+          break;
+        }
+    }
+
+  return seg_cnt;
+}
+
 /* Loads an ELF executable from FILE_NAME into the current thread.
    Stores the executable's entry point into *EIP
    and its initial stack pointer into *ESP.
@@ -307,9 +707,11 @@ bool
 load (const char *file_name, void (**eip) (void), void **esp) 
 {
   struct thread *t = thread_current ();
-  struct Elf32_Ehdr ehdr;
+  struct exec_image image;
+  struct exec_segment *segs, *big_segs = NULL;
+  int seg_cnt;
   struct file *file = NULL;
-  off_t file_ofs;
+  struct inode *inode;
   bool success = false;
   int i;
 
@@ -324,7 +726,7 @@ load (const char *file_name, void (**eip) (void), void **esp)
   int argc = 0;
   
   // 1. 파싱을 위해 file_name의 복사본을 만든다.
-  char command_copy[256];
+  char command_copy[CMDLINE_MAX];
   strlcpy(command_copy, file_name, sizeof(command_copy));
 
   char *current_pos = command_copy; // 현재 처리 중인 문자열의 시작점
@@ -357,7 +759,6 @@ load (const char *file_name, void (**eip) (void), void **esp)
   }
 
   /* Open executable file. */
-  lock_acquire(&filesys_lock);
   file = filesys_open (argv[0]);
   if (file == NULL) 
     {
@@ -365,78 +766,45 @@ load (const char *file_name, void (**eip) (void), void **esp)
       goto done; 
     }
 
-  /* Read and verify executable header. */
-  if (file_read (file, &ehdr, sizeof ehdr) != sizeof ehdr
-      || memcmp (ehdr.e_ident, "\177ELF\1\1\1", 7)
-      || ehdr.e_type != 2
-      || ehdr.e_machine != 3
-      || ehdr.e_version != 1
-      || ehdr.e_phentsize != sizeof (struct Elf32_Phdr)
-      || ehdr.e_phnum > 1024) 
-    {
-      printf ("load: %s: error loading executable\n", file_name);
-      goto done; 
-    }
-
-  /* Read program headers. */
-  file_ofs = ehdr.e_phoff;
-  for (i = 0; i < ehdr.e_phnum; i++) 
+  /* Read the executable's layout, from the exec cache if it
+     has not been written since it was last executed. */
+  inode = file_get_inode (file);
+  segs = image.segments;
+  if (exec_cache_lookup (inode, &image))
+    seg_cnt = image.segment_cnt;
+  else
     {
-      struct Elf32_Phdr phdr;
-
-      if (file_ofs < 0 || file_ofs > file_length (file))
-        goto done;
-      file_seek (file, file_ofs);
-
-      if (file_read (file, &phdr, sizeof phdr) != sizeof phdr)
+      unsigned write_cnt = inode_write_cnt (inode);
+      seg_cnt = read_image (file, file_name, &image,
+                            image.segments, EXEC_SEGMENT_MAX);
+      if (seg_cnt < 0)
         goto done;
-      file_ofs += sizeof phdr;
-      switch (phdr.p_type) 
+      if (seg_cnt <= EXEC_SEGMENT_MAX)
         {
-        case PT_NULL:
-        case PT_NOTE:
-        case PT_PHDR:
-        case PT_STACK:
-        default:
-          /* Ignore this segment. */
-          break;
-        case PT_DYNAMIC:
-        case PT_INTERP:
-        case PT_SHLIB:
-          goto done;
-        case PT_LOAD:
-          if (validate_segment (&phdr, file)) 
-            {
-              bool writable = (phdr.p_flags & PF_W) != 0;
-              uint32_t file_page = phdr.p_offset & ~PGMASK;
-              uint32_t mem_page = phdr.p_vaddr & ~PGMASK;
-              uint32_t page_offset = phdr.p_vaddr & PGMASK;
-              uint32_t read_bytes, zero_bytes;
-              if (phdr.p_filesz > 0)
-                {
-                  /* Normal segment.
-                     Read initial part from disk and zero the rest. */
-                  read_bytes = page_offset + phdr.p_filesz;
-                  zero_bytes = (ROUND_UP (page_offset + phdr.p_memsz, PGSIZE)
-                                - read_bytes);
-                }
-              else 
-                {
-                  /* Entirely zero.
-                     Don't read anything from disk. */
-                  read_bytes = 0;
-                  zero_bytes = ROUND_UP (page_offset + phdr.p_memsz, PGSIZE);
-                }
-              if (!load_segment (file, file_page, (void *) mem_page,
-                                 read_bytes, zero_bytes, writable))
-                goto done;
-            }
-          else
+          image.segment_cnt = seg_cnt;
+          exec_cache_insert (inode, write_cnt, &image);
+        }
+      else
+        {
+          /* Too many segments to cache.  Read them all into an
+             array of their own and load from that instead. */
+          big_segs = malloc (seg_cnt * sizeof *big_segs);
+          if (big_segs == NULL
+              || read_image (file, file_name, &image,
+                             big_segs, seg_cnt) != seg_cnt)
             goto done;
-          break;
+          segs = big_segs;
         }
     }
 
+  for (i = 0; i < seg_cnt; i++)
+    {
+      const struct exec_segment *seg = &segs[i];
+      if (!load_segment (file, seg->file_page, (void *) seg->mem_page,
+                         seg->read_bytes, seg->zero_bytes, seg->writable))
+        goto done;
+    }
+
   /* Set up stack. */
   if (!setup_stack (esp))
     goto done;
@@ -444,14 +812,14 @@ load (const char *file_name, void (**eip) (void), void **esp)
   make_stack(argv, esp, argc);
 
   /* Start address. */
-  *eip = (void (*) (void)) ehdr.e_entry;
+  *eip = (void (*) (void)) image.entry;
 
   success = true;
 
  done:
   /* We arrive here whether the load is successful or not. */
+  free (big_segs);
   //file_close (file);
-  lock_release(&filesys_lock);
   return success;
 }
 
@@ -612,27 +980,44 @@ load_segment (struct file *file, off_t ofs, uint8_t *upage,
    user virtual memory. */
 static bool
 setup_stack (void **esp) 
+{
+  bool success = install_stack_page (((uint8_t *) PHYS_BASE) - PGSIZE);
+  if (success)
+    *esp = PHYS_BASE;
+  return success;
+}
+
+/* Maps a zeroed, writable stack page at user address UPAGE,
+   unless the process already has a page there.  Returns true if
+   successful, false on failure. */
+static bool
+install_stack_page (void *upage)
 {
   uint8_t *kpage;
   bool success = false;
+  bool acquired = vm_acquire ();
+
+  if (find_vme (upage) != NULL)
+    {
+      vm_release (acquired);
+      return true;
+    }
 
   kpage = alloc_page (PAL_USER | PAL_ZERO);
   if (kpage != NULL) 
     {
-      success = install_page (((uint8_t *) PHYS_BASE) - PGSIZE, kpage, true);
+      success = install_page (upage, kpage, true);
       if (success) 
         {
-          *esp = PHYS_BASE;
-          
           /* 초기 스택 페이지에 대한 vm_entry 생성 및 등록 */
           struct vm_entry *vme = malloc(sizeof(struct vm_entry));
           if (vme) {
-              vme->vaddr = ((uint8_t *) PHYS_BASE) - PGSIZE;
+              vme->vaddr = upage;
               vme->type = VM_ANON;
               vme->writable = true;
               vme->is_loaded = true;
               
-              if (!insert_vme(&thread_current()->vm, vme)) {
+              if (!insert_vme(&thread_current()->leader->vm, vme)) {
                   free(vme);
               } else {
                   add_page_to_frame(kpage, vme); // 프레임 테이블 연결
@@ -644,6 +1029,7 @@ setup_stack (void **esp)
           free_page (kpage);
         }
     }
+  vm_release (acquired);
   return success;
 }
 
@@ -2,10 +2,30 @@
 #define USERPROG_PROCESS_H
 
 #include "threads/thread.h"
+#include "threads/vaddr.h"
+
+/* User stacks.  The main thread's stack grows down from
+   PHYS_BASE; the stacks of the process's other threads sit in
+   fixed slots below it, UTHREAD_STACK_MAX bytes apiece. */
+#define USER_STACK_MAX (8 * 1024 * 1024)        /* Main thread. */
+#define UTHREAD_STACK_MAX (1024 * 1024)         /* Other threads. */
+#define UTHREAD_MAX 16                          /* Other threads. */
+#define USER_STACK_BOTTOM \
+  ((void *) ((uint8_t *) PHYS_BASE - USER_STACK_MAX \
+             - UTHREAD_MAX * UTHREAD_STACK_MAX))
+
+/* Longest command line load() accepts, including the null. */
+#define CMDLINE_MAX 256
 
 tid_t process_execute (const char *file_name);
 int process_wait (tid_t);
 void process_exit (void);
 void process_activate (void);
 
+tid_t process_thread_create (void *entry, void *func, void *aux);
+void process_thread_exit (int status) NO_RETURN;
+int process_thread_join (tid_t);
+void process_exit_group (int status) NO_RETURN;
+void process_check_exiting (void);
+
 #endif /* userprog/process.h */
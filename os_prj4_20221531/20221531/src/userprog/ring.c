@@ -0,0 +1,94 @@
+#include "userprog/ring.h"
+#include <stddef.h>
+#include "threads/thread.h"
+#include "userprog/syscall.h"
+#include "userprog/uaccess.h"
+
+/* The indexes at the start of struct ring. */
+struct ring_index
+  {
+    uint32_t sq_head;
+    uint32_t sq_tail;
+    uint32_t cq_head;
+    uint32_t cq_tail;
+  };
+
+/* Carries out SQE and returns its result. */
+static int
+ring_do (const struct ring_sqe *sqe)
+{
+  switch (sqe->op)
+    {
+    case RING_NOP:
+      return 0;
+    case RING_READ:
+      return read (sqe->fd, sqe->buf, sqe->len);
+    case RING_WRITE:
+      return write (sqe->fd, sqe->buf, sqe->len);
+    case RING_OPEN:
+      return open (sqe->buf);
+    case RING_CLOSE:
+      close (sqe->fd);
+      return 0;
+    default:
+      return -1;
+    }
+}
+
+/* Registers the rings at user address R for the calling
+   process, in place of any registered before, and empties them.
+   Returns 0, or -1 if R is misaligned. */
+int
+ring_setup (struct ring *r)
+{
+  struct ring_index idx = { 0, 0, 0, 0 };
+
+  if ((uintptr_t) r % sizeof (uint32_t) != 0)
+    return -1;
+  if (!fault_in_user (r, sizeof *r, true)
+      || !copy_to_user (r, &idx, sizeof idx))
+    exit (-1);
+  thread_current ()->leader->ring = r;
+  return 0;
+}
+
+/* Carries out up to TO_SUBMIT queued operations in order,
+   posting each one's result.  Stops early if the submission ring
+   empties or the completion ring fills.  Returns the number
+   carried out, or -1 if no rings are registered. */
+int
+ring_enter (unsigned to_submit)
+{
+  struct ring *r = thread_current ()->leader->ring;
+  struct ring_index idx;
+  unsigned done;
+
+  if (r == NULL)
+    return -1;
+  if (!copy_from_user (&idx, r, sizeof idx))
+    exit (-1);
+
+  for (done = 0; done < to_submit && idx.sq_head != idx.sq_tail; done++)
+    {
+      struct ring_sqe sqe;
+      struct ring_cqe cqe;
+
+      if (idx.cq_tail - idx.cq_head >= RING_ENTRIES)
+        break;
+      if (!copy_from_user (&sqe, &r->sq[idx.sq_head % RING_ENTRIES],
+                           sizeof sqe))
+        exit (-1);
+      cqe.user_data = sqe.user_data;
+      cqe.res = ring_do (&sqe);
+      if (!copy_to_user (&r->cq[idx.cq_tail % RING_ENTRIES], &cqe,
+                         sizeof cqe))
+        exit (-1);
+      idx.sq_head++;
+      idx.cq_tail++;
+    }
+
+  if (!copy_to_user (&r->sq_head, &idx.sq_head, sizeof idx.sq_head)
+      || !copy_to_user (&r->cq_tail, &idx.cq_tail, sizeof idx.cq_tail))
+    exit (-1);
+  return done;
+}
@@ -0,0 +1,14 @@
+#ifndef USERPROG_RING_H
+#define USERPROG_RING_H
+
+#include <ring.h>
+
+/* Batched system calls through submission and completion rings
+   in user memory; see lib/ring.h.  Carrying out a whole batch
+   per trap saves the entry, exit and dispatch cost of each
+   call after the first. */
+
+int ring_setup (struct ring *);
+int ring_enter (unsigned to_submit);
+
+#endif /* userprog/ring.h */
@@ -2,92 +2,139 @@
 #include <stdio.h>
 #include <syscall-nr.h>
 #include "threads/interrupt.h"
+#include "threads/malloc.h"
+#include "threads/palloc.h"
 #include "threads/thread.h"
 
 #include "threads/vaddr.h"
 #include "devices/shutdown.h" 
 #include "userprog/process.h"   
+#include "userprog/futex.h"
+#include "userprog/pipe.h"
+#include "userprog/ring.h"
+#include "userprog/exec-cache.h"
+#include "userprog/trace.h"
+#include "devices/block.h"
 #include "devices/input.h"    
+#include "devices/timer.h"
 
+#include <limits.h>
+#include <lockstat.h>
 #include <string.h>
+#include <uio.h>
 #include "filesys/filesys.h" 
 #include "filesys/file.h"    
+#include "filesys/directory.h"
 
+#include "userprog/gdt.h"
 #include "userprog/pagedir.h"
+#include "userprog/tss.h"
+#include "userprog/uaccess.h"
 #include "vm/page.h"
 #include "vm/frame.h"
-
-struct lock filesys_lock; // 동기화 위해 lock 추가
+#include "vm/shm.h"
 
 static void syscall_handler (struct intr_frame *);
+static bool cpu_has_sysenter (void);
+static void sysenter_init (void);
 
-void
-check_addr(void *addr) {
-  if (false == is_user_vaddr(addr)) exit(-1);
-}
+/* Model-specific registers that configure SYSENTER. */
+#define MSR_SYSENTER_CS 0x174   /* Kernel code segment. */
+#define MSR_SYSENTER_ESP 0x175  /* Kernel stack pointer. */
+#define MSR_SYSENTER_EIP 0x176  /* Entry point. */
+
+/* Stack that SYSENTER switches to.  Its top word holds the TSS
+   address that sysenter_entry loads the real kernel stack from.
+   The rest is only used by a debug exception taken on the first
+   instruction of sysenter_entry; see exception.c. */
+static uint32_t sysenter_stack[256];
 
 void
 syscall_init (void) 
 {
   intr_register_int (0x30, 3, INTR_ON, syscall_handler, "syscall");
-  lock_init(&filesys_lock); // file system lock
+  if (cpu_has_sysenter ())
+    sysenter_init ();
+  futex_init();
+  exec_cache_init();
+  trace_init();
 }
 
-//project 4
-void check_valid_buffer(void *buffer, size_t size, bool to_write) {
-    if (buffer == NULL) exit(-1);
-    
-    /* 버퍼의 시작 주소부터 끝 주소까지 페이지 단위로 순회 */
-    void *ptr = pg_round_down(buffer);
-    
-    // buffer + size가 페이지 경계에 걸칠 수 있으므로 end 조건 주의
-    while (ptr < buffer + size) {
-        /* 1. 주소 유효성 검사 (유저 영역인지) */
-        check_addr(ptr);
-
-        /* 2. SPT에서 페이지 찾기 (check_address -> find_vme) */
-        struct vm_entry *vme = find_vme(ptr);
+/* Returns true if the CPU supports SYSENTER and SYSEXIT. */
+static bool
+cpu_has_sysenter (void)
+{
+  uint32_t eax, ebx, ecx, edx;
+  unsigned family, model, stepping;
+
+  asm ("cpuid" : "=a" (eax), "=b" (ebx), "=c" (ecx), "=d" (edx) : "a" (1));
+  family = (eax >> 8) & 0xf;
+  model = (eax >> 4) & 0xf;
+  stepping = eax & 0xf;
+
+  /* The earliest Pentium Pros set the SEP bit without
+     implementing the instructions. */
+  if (family == 6 && model < 3 && stepping < 3)
+    return false;
+  return (edx & (1u << 11)) != 0;
+}
 
-        /* 페이지가 없으면 에러 */
-        if (vme == NULL) {
-            exit(-1);
-        }
+/* Writes VALUE to model-specific register MSR. */
+static void
+wrmsr (uint32_t msr, uint32_t value)
+{
+  asm volatile ("wrmsr" : : "c" (msr), "a" (value), "d" (0));
+}
 
-        /* 3. 쓰기 권한 검사 */
-        /* to_write가 true인데(버퍼에 써야 하는데) 페이지가 read-only라면 에러 */
-        if (to_write && !vme->writable) {
-            exit(-1);
-        }
+/* Points SYSENTER at sysenter_entry.  User programs still fall
+   back to `int $0x30' on CPUs without it. */
+static void
+sysenter_init (void)
+{
+  uint32_t *top = &sysenter_stack[sizeof sysenter_stack
+                                  / sizeof *sysenter_stack - 1];
 
-        /* 4. Pinning (미리 로딩) */
-        /* 여기서 미리 메모리에 접근해서 Page Fault를 발생시켜 로드해 둔다. */
-        if (to_write) {
-            // 쓰기 동작을 시도해서 Dirty bit를 켜고 로드함
-            *(char *)ptr = *(char *)ptr; 
-        } else {
-            // 읽기 동작을 시도해서 로드함
-            volatile char c = *(char *)ptr; 
-            (void)c; // 컴파일러 경고 방지
-        }
+  *top = (uint32_t) tss_get ();
+  wrmsr (MSR_SYSENTER_CS, SEL_KCSEG);
+  wrmsr (MSR_SYSENTER_ESP, (uint32_t) top);
+  wrmsr (MSR_SYSENTER_EIP, (uint32_t) sysenter_entry);
+}
 
-        /* 다음 페이지로 이동 */
-        ptr += PGSIZE;
-    }
+/* Handles a system call that came in through sysenter_entry,
+   which builds enough of F for syscall_handler().  The checks
+   that intr_handler() makes before returning to user mode are
+   repeated here. */
+void
+sysenter_handler (struct intr_frame *f)
+{
+  syscall_handler (f);
+  process_check_exiting ();
 }
 
 // 스택에서 n번째 정수 인자를 가져오는 함수
 static int get_int_arg(struct intr_frame *f, int offset) {
-    void *arg_ptr = f->esp + offset;
-    check_addr(arg_ptr); // 주소 유효성 검사
-    return *(int *)arg_ptr;
+    int arg;
+    if (!copy_from_user(&arg, f->esp + offset, sizeof arg))
+        exit(-1);
+    return arg;
 }
 
-// 스택에서 n번째 포인터 인자를 가져오는 함수
+// 스택에서 n번째 포인터 인자를 가져오는 함수.  The pointer itself
+// is checked by whatever uses it, through uaccess.h.
 static void* get_ptr_arg(struct intr_frame *f, int offset) {
-    void *arg_ptr = f->esp + offset;
-    check_addr(arg_ptr); // 주소 유효성 검사
-    check_addr(*(void **)arg_ptr); // 포인터가 가리키는 주소도 검사
-    return *(void **)arg_ptr;
+    return (void *) get_int_arg(f, offset);
+}
+
+/* Copies the user string USTR into DST, which has room for SIZE
+   bytes, and returns DST, or a null pointer if it does not fit.
+   Kills the process if USTR is a bad pointer. */
+static char *
+copy_in_string (char *dst, const char *ustr, size_t size)
+{
+  int len = strncpy_from_user(dst, ustr, size);
+  if (len < 0)
+    exit(-1);
+  return (size_t) len < size ? dst : NULL;
 }
 
 static void
@@ -95,8 +142,10 @@ syscall_handler (struct intr_frame *f UNUSED)
 {
   // printf ("system call!\n");
   
-  check_addr(f->esp);
-  int syscall_number = *(int *)(f->esp);
+  thread_current()->user_esp = f->esp;
+  int syscall_number = get_int_arg(f, 0);
+  bool traced = trace_active();
+  int64_t start_ns = traced ? timer_now_ns() : 0;
 
     switch (syscall_number) {
     case SYS_HALT:
@@ -165,7 +214,129 @@ syscall_handler (struct intr_frame *f UNUSED)
       break;
     case SYS_MUNMAP : munmap(get_int_arg(f,4));
       break;
+
+    case SYS_THREAD_CREATE:
+      f->eax = process_thread_create(get_ptr_arg(f, 4),
+                                     (void *) get_int_arg(f, 8),
+                                     (void *) get_int_arg(f, 12));
+      break;
+    case SYS_THREAD_EXIT:
+      process_thread_exit(get_int_arg(f, 4));
+      break;
+    case SYS_THREAD_JOIN:
+      f->eax = process_thread_join(get_int_arg(f, 4));
+      break;
+    case SYS_FUTEX_WAIT:
+      f->eax = futex_wait(get_ptr_arg(f, 4), get_int_arg(f, 8));
+      break;
+    case SYS_FUTEX_WAKE:
+      f->eax = futex_wake(get_ptr_arg(f, 4), get_int_arg(f, 8));
+      break;
+
+    case SYS_LOCKSTAT:
+#ifdef LOCKSTAT
+      {
+        struct lockstat stats;
+        bool found = lockstat_get(get_int_arg(f, 4), &stats,
+                                  get_int_arg(f, 12) != 0);
+        if (found && !copy_to_user(get_ptr_arg(f, 8), &stats, sizeof stats))
+          exit(-1);
+        f->eax = found;
+      }
+#else
+      f->eax = false;
+#endif
+      break;
+
+    case SYS_CLOCK_NS:
+      {
+        int64_t ns = timer_now_ns();
+        if (!copy_to_user(get_ptr_arg(f, 4), &ns, sizeof ns))
+          exit(-1);
+      }
+      break;
+
+    case SYS_SCHED_DEADLINE:
+      {
+        /* The budget is charged in whole ticks, so round it up
+           and the deadline and period down. */
+        int64_t runtime = get_int_arg(f, 4);
+        int64_t deadline = get_int_arg(f, 8);
+        int64_t period = get_int_arg(f, 12);
+        f->eax = thread_set_deadline(DIV_ROUND_UP(runtime * TIMER_FREQ, 1000),
+                                     deadline * TIMER_FREQ / 1000,
+                                     period * TIMER_FREQ / 1000);
+      }
+      break;
+    case SYS_SCHEDSTAT:
+      {
+        struct schedstat stats;
+        bool found = thread_get_schedstat(get_int_arg(f, 4), &stats);
+        if (found && !copy_to_user(get_ptr_arg(f, 8), &stats, sizeof stats))
+          exit(-1);
+        f->eax = found;
+      }
+      break;
+
+    case SYS_NULL:
+      break;
+
+    case SYS_PREAD:
+      f->eax = pread(get_int_arg(f, 4), get_ptr_arg(f, 8),
+                     get_int_arg(f, 12), get_int_arg(f, 16));
+      break;
+
+    case SYS_PWRITE:
+      f->eax = pwrite(get_int_arg(f, 4), get_ptr_arg(f, 8),
+                      get_int_arg(f, 12), get_int_arg(f, 16));
+      break;
+
+    case SYS_READV:
+      f->eax = readv(get_int_arg(f, 4), get_ptr_arg(f, 8),
+                     get_int_arg(f, 12));
+      break;
+
+    case SYS_WRITEV:
+      f->eax = writev(get_int_arg(f, 4), get_ptr_arg(f, 8),
+                      get_int_arg(f, 12));
+      break;
+
+    case SYS_COPY_FILE_RANGE:
+      f->eax = copy_file_range(get_int_arg(f, 4), get_int_arg(f, 8),
+                               get_int_arg(f, 12));
+      break;
+
+    case SYS_RING_SETUP:
+      f->eax = ring_setup(get_ptr_arg(f, 4));
+      break;
+
+    case SYS_RING_ENTER:
+      f->eax = ring_enter(get_int_arg(f, 4));
+      break;
+
+    case SYS_TRACE:
+      f->eax = trace(get_int_arg(f, 4) != 0);
+      break;
+
+    case SYS_TRACE_READ:
+      f->eax = trace_read(get_ptr_arg(f, 4), get_int_arg(f, 8));
+      break;
+
+    case SYS_TRACE_HIST:
+      f->eax = trace_hist(get_int_arg(f, 4), get_ptr_arg(f, 8));
+      break;
+
+    case SYS_PIPE:
+      f->eax = pipe_create(get_ptr_arg(f, 4));
+      break;
+
+    case SYS_SHM_OPEN:
+      f->eax = shm_open(get_ptr_arg(f, 4), get_int_arg(f, 8),
+                        get_ptr_arg(f, 12));
+      break;
   }
+  if (traced)
+    trace_syscall(f, syscall_number, start_ns);
   // thread_exit ();
 }
 void halt (void) {
@@ -173,19 +344,21 @@ void halt (void) {
 }
 
 void exit (int status) {
+  /* In a multithreaded process, the leader reports the status
+     once the other threads are gone. */
+  if (thread_current()->leader != thread_current())
+    process_exit_group(status);
+
   printf("%s: exit(%d)\n", thread_current()->name, status);
   thread_current()->exit_status = status; 
-
-  for (int i = 2; i < 128; i++) {
-    if (thread_current()->FD[i] != NULL) {
-      close(i);
-    }
-  }
   thread_exit();
 }
 
 int exec (const char *cmd_lime) {
-  return process_execute(cmd_lime);
+  char cmd[CMDLINE_MAX];
+  if (copy_in_string(cmd, cmd_lime, sizeof cmd) == NULL)
+    return -1;
+  return process_execute(cmd);
 }
 
 int wait (int pid) {
@@ -241,76 +414,173 @@ int max_of_four_int(int a, int b, int c, int d) {
   return MAX;
 }
 
-bool create (const char *file, unsigned initial_size)
+bool create (const char *ufile, unsigned initial_size)
 {
-  check_addr(file);
-  if (file == NULL) exit(-1);
-
-    lock_acquire(&filesys_lock);
-    bool success = filesys_create(file, initial_size);
-    lock_release(&filesys_lock);
+  char file[NAME_MAX + 2];
+  if (copy_in_string(file, ufile, sizeof file) == NULL) return false;
 
-    return success;
+    return filesys_create(file, initial_size);
 }
 
-bool remove(const char *file) {
-  check_addr(file);
-    lock_acquire(&filesys_lock);
-    bool success = filesys_remove(file);
-    lock_release(&filesys_lock);
-
-    return success;
+bool remove(const char *ufile) {
+  char file[NAME_MAX + 2];
+  if (copy_in_string(file, ufile, sizeof file) == NULL) return false;
+    return filesys_remove(file);
 }
 
-int open(const char *file) {
-  check_addr(file);
-  if (file == NULL) return -1;
+int open(const char *ufile) {
+  char file[NAME_MAX + 2];
+  if (copy_in_string(file, ufile, sizeof file) == NULL) return -1;
 
-  lock_acquire(&filesys_lock);
   struct file *f = filesys_open(file);
   if (f == NULL) {
-    lock_release(&filesys_lock);
     return -1;
   }
 
-  struct thread *cur = thread_current();
+  struct thread *cur = thread_current()->leader;
+  // 실행 중인 자신의 실행 파일인 경우 쓰기 금지
+  if (strcmp(cur->name, file) == 0) {
+    file_deny_write(f);
+  }
+
+  rwlock_acquire_write(&cur->fd_lock);
   for (int i = 2; i < 128; i++) {
-    if (cur->FD[i] == NULL) {
-      // 실행 중인 자신의 실행 파일인 경우 쓰기 금지
-      if (strcmp(cur->name, file) == 0) {
-        file_deny_write(f);
-      }
+    if (cur->FD[i] == NULL && !pipe_fd_used(cur, i)) {
       cur->FD[i] = f;
-      lock_release(&filesys_lock);
+      rwlock_release_write(&cur->fd_lock);
       return i;
     }
   }
+  rwlock_release_write(&cur->fd_lock);
 
   file_close(f);
-  lock_release(&filesys_lock);
   return -1;
 }
 
 int filesize(int fd) {
     if (fd < 2 || fd >= 128) return -1;
     
-    struct file *f = thread_current()->FD[fd];
-    if (f == NULL) return -1;
-    return file_length(f);
+    struct thread *cur = thread_current()->leader;
+    rwlock_acquire_read(&cur->fd_lock);
+    struct file *f = cur->FD[fd];
+    int length = f == NULL ? -1 : file_length(f);
+    rwlock_release_read(&cur->fd_lock);
+    return length;
 
 }
 
-int read (int fd, void *buffer, unsigned size)
+/* Where a copy between the kernel and a list of user buffers
+   has got to. */
+struct iov_cursor {
+  const struct iovec *iov;      /* Current buffer. */
+  int cnt;                      /* Buffers left, including IOV. */
+  size_t ofs;                   /* Bytes of IOV already done. */
+};
+
+/* Copies N bytes between KBUF and the user buffers at C, to the
+   user buffers if TO_USER, and advances C past them.  Returns
+   false if a user buffer turned out to be bad, for example
+   because another thread unmapped it. */
+static bool
+iov_copy (struct iov_cursor *c, void *kbuf, size_t n, bool to_user)
+{
+  uint8_t *k = kbuf;
+
+  while (n > 0) {
+    while (c->ofs == c->iov->iov_len) {
+      ASSERT(c->cnt > 1);
+      c->iov++;
+      c->cnt--;
+      c->ofs = 0;
+    }
+
+    uint8_t *u = (uint8_t *) c->iov->iov_base + c->ofs;
+    size_t chunk = c->iov->iov_len - c->ofs;
+    if (chunk > n) {
+      chunk = n;
+    }
+    if (!(to_user ? copy_to_user(u, k, chunk) : copy_from_user(k, u, chunk))) {
+      return false;
+    }
+    k += chunk;
+    n -= chunk;
+    c->ofs += chunk;
+  }
+  return true;
+}
+
+/* Transfers TOTAL bytes between file F and the IOVCNT user
+   buffers at IOV, into F if TO_FILE, at F's position if OFFSET
+   is negative or else at OFFSET.  If TO_FILE and F is null,
+   writes to the console instead.  Returns the number of bytes
+   transferred, or -1 if a user buffer is bad.
+
+   The data passes through a kernel page a page at a time.  The
+   buffers were faulted in beforehand, but another thread of the
+   process may unmap one at any time, and the file system and
+   console hold locks while they copy.  So only copy_to_user()
+   and copy_from_user(), which fail instead of killing the
+   process, touch user memory. */
+static int
+bounce_io (struct file *f, const struct iovec *iov, int iovcnt, int total,
+           off_t offset, bool to_file)
 {
-  // 1. 버퍼 주소 유효성 검사
-  check_addr(buffer);
+  struct iov_cursor c = { iov, iovcnt, 0 };
+  uint8_t *bounce = palloc_get_page(0);
+  int done = 0;
+
+  if (bounce == NULL) {
+    return -1;
+  }
+  while (done < total) {
+    off_t chunk = total - done < PGSIZE ? total - done : PGSIZE;
+    off_t n;
+
+    if (to_file) {
+      if (!iov_copy(&c, bounce, chunk, false)) {
+        done = -1;
+        break;
+      }
+      if (f == NULL) {
+        putbuf((const char *) bounce, chunk);
+        n = chunk;
+      } else if (offset < 0) {
+        n = file_write(f, bounce, chunk);
+      } else {
+        n = file_write_at(f, bounce, chunk, offset + done);
+      }
+    } else {
+      n = offset < 0 ? file_read(f, bounce, chunk)
+                     : file_read_at(f, bounce, chunk, offset + done);
+      if (n > 0 && !iov_copy(&c, bounce, n, true)) {
+        done = -1;
+        break;
+      }
+    }
+    done += n;
+    if (n < chunk) {
+      break;
+    }
+  }
+  palloc_free_page(bounce);
+  return done;
+}
 
-  check_valid_buffer(buffer, size, false);
+int read (int fd, void *buffer, unsigned size)
+{
+  // 1. 버퍼 주소 유효성 검사 (미리 페이지를 불러온다)
+  if (!fault_in_user(buffer, size, true)) exit(-1);
+  if (size > INT_MAX) {
+    size = INT_MAX;
+  }
 
   // 2. fd 값에 따른 분기 처리
   if (fd == 0) { // STDIN: 키보드 입력
     for (unsigned i = 0; i < size; i++) {
-      *((uint8_t *)buffer + i) = input_getc();
+      uint8_t c = input_getc();
+      if (!copy_to_user((uint8_t *) buffer + i, &c, 1)) {
+        return -1;
+      }
     }
     return size;
   }
@@ -320,30 +590,38 @@ int read (int fd, void *buffer, unsigned size)
     return -1;
   }
 
-  // 3. 실제 파일에서 읽기
-  struct file *f = thread_current()->FD[fd];
-  if (f == NULL) { // 파일이 열려있는지 확인
-    return -1;
+  // 파이프: fd_lock 없이 기다릴 수 있도록 참조만 잡는다
+  struct pipe *p = pipe_get(fd, false);
+  if (p != NULL) {
+    int bytes_read = pipe_read(p, buffer, size);
+    pipe_put(p);
+    return bytes_read;
   }
-  
-  lock_acquire(&filesys_lock);
-  int bytes_read = file_read(f, buffer, size);
-  lock_release(&filesys_lock);
+
+  // 3. 실제 파일에서 읽기.  Holding fd_lock keeps another
+  // thread of the process from closing the file under us.
+  struct iovec iov = { buffer, size };
+  struct thread *cur = thread_current()->leader;
+  rwlock_acquire_read(&cur->fd_lock);
+  struct file *f = cur->FD[fd];
+  int bytes_read = f == NULL ? -1 : bounce_io(f, &iov, 1, size, -1, false);
+  rwlock_release_read(&cur->fd_lock);
   
   return bytes_read;
 }
 
 int write (int fd, const void *buffer, unsigned size)
 {
-  // 1. 버퍼 주소 유효성 검사
-  check_addr(buffer);
-
-  check_valid_buffer(buffer, size, false);
+  // 1. 버퍼 주소 유효성 검사 (미리 페이지를 불러온다)
+  if (!fault_in_user((void *) buffer, size, false)) exit(-1);
+  if (size > INT_MAX) {
+    size = INT_MAX;
+  }
+  struct iovec iov = { (void *) buffer, size };
 
   // 2. fd 값에 따른 분기 처리
   if (fd == 1) { // STDOUT: 모니터 출력
-    putbuf(buffer, size);
-    return size;
+    return bounce_io(NULL, &iov, 1, size, -1, true);
   }
   
   // 파일 디스크립터가 유효한 범위에 있는지 확인
@@ -351,79 +629,285 @@ int write (int fd, const void *buffer, unsigned size)
     return -1;
   }
 
+  // 파이프: fd_lock 없이 기다릴 수 있도록 참조만 잡는다
+  struct pipe *p = pipe_get(fd, true);
+  if (p != NULL) {
+    int bytes_written = pipe_write(p, buffer, size);
+    pipe_put(p);
+    return bytes_written;
+  }
+
   // 3. 실제 파일에 쓰기
-  struct file *f = thread_current()->FD[fd];
-  if (f == NULL) { // 파일이 열려있는지 확인
+  struct thread *cur = thread_current()->leader;
+  rwlock_acquire_read(&cur->fd_lock);
+  struct file *f = cur->FD[fd];
+  int bytes_written = f == NULL ? -1 : bounce_io(f, &iov, 1, size, -1, true);
+  rwlock_release_read(&cur->fd_lock);
+  
+  return bytes_written;
+}
+
+int pread (int fd, void *buffer, unsigned size, unsigned offset)
+{
+  if (!fault_in_user(buffer, size, true)) exit(-1);
+  if (fd < 2 || fd >= 128 || offset > INT_MAX) {
     return -1;
   }
+  if (size > INT_MAX - offset) {
+    size = INT_MAX - offset;
+  }
 
+  // file->pos를 건드리지 않고 OFFSET에서 읽기
+  struct iovec iov = { buffer, size };
+  struct thread *cur = thread_current()->leader;
+  rwlock_acquire_read(&cur->fd_lock);
+  struct file *f = cur->FD[fd];
+  int bytes_read = f == NULL ? -1 : bounce_io(f, &iov, 1, size, offset, false);
+  rwlock_release_read(&cur->fd_lock);
+
+  return bytes_read;
+}
+
+int pwrite (int fd, const void *buffer, unsigned size, unsigned offset)
+{
+  if (!fault_in_user((void *) buffer, size, false)) exit(-1);
+  if (fd < 2 || fd >= 128 || offset > INT_MAX) {
+    return -1;
+  }
+  if (size > INT_MAX - offset) {
+    size = INT_MAX - offset;
+  }
+
+  struct iovec iov = { (void *) buffer, size };
+  struct thread *cur = thread_current()->leader;
+  rwlock_acquire_read(&cur->fd_lock);
+  struct file *f = cur->FD[fd];
+  int bytes_written = f == NULL ? -1 : bounce_io(f, &iov, 1, size, offset, true);
+  rwlock_release_read(&cur->fd_lock);
 
-  lock_acquire(&filesys_lock);
-  int bytes_written = file_write(f, buffer, size);
-  lock_release(&filesys_lock);
-  
   return bytes_written;
 }
 
+/* Copies the IOVCNT buffer descriptors at UIOV into IOV, then
+   faults in every buffer they name, for writing if TO_WRITE.
+   Copying first keeps another thread from changing a buffer
+   after it has been checked.  Returns the
+   buffers' total size, or -1 if IOVCNT is out of range or the
+   total does not fit in an int. */
+static int
+copy_in_iovec (struct iovec *iov, const struct iovec *uiov, int iovcnt,
+               bool to_write)
+{
+  int total = 0;
+  int i;
+
+  if (iovcnt < 0 || iovcnt > IOV_MAX)
+    return -1;
+  if (!copy_from_user(iov, uiov, iovcnt * sizeof *iov))
+    exit(-1);
+
+  for (i = 0; i < iovcnt; i++) {
+    if (iov[i].iov_len > (size_t) (INT_MAX - total))
+      return -1;
+    total += iov[i].iov_len;
+    if (!fault_in_user(iov[i].iov_base, iov[i].iov_len, to_write))
+      exit(-1);
+  }
+  return total;
+}
+
+int readv (int fd, const struct iovec *uiov, int iovcnt)
+{
+  struct iovec iov[IOV_MAX];
+  int total = copy_in_iovec(iov, uiov, iovcnt, true);
+  if (total < 0) {
+    return -1;
+  }
+
+  if (fd == 0) { // STDIN: 키보드 입력
+    struct iov_cursor c = { iov, iovcnt, 0 };
+    for (int i = 0; i < total; i++) {
+      uint8_t key = input_getc();
+      if (!iov_copy(&c, &key, 1, true)) {
+        return -1;
+      }
+    }
+    return total;
+  }
+
+  if (fd < 2 || fd >= 128) {
+    return -1;
+  }
+
+  // 모든 버퍼를 한 번의 lock 획득으로 읽기
+  struct thread *cur = thread_current()->leader;
+  rwlock_acquire_read(&cur->fd_lock);
+  struct file *f = cur->FD[fd];
+  int bytes_read = f == NULL ? -1 : bounce_io(f, iov, iovcnt, total, -1, false);
+  rwlock_release_read(&cur->fd_lock);
+
+  return bytes_read;
+}
+
+int writev (int fd, const struct iovec *uiov, int iovcnt)
+{
+  struct iovec iov[IOV_MAX];
+  int total = copy_in_iovec(iov, uiov, iovcnt, false);
+  if (total < 0) {
+    return -1;
+  }
+
+  if (fd == 1) { // STDOUT: 모니터 출력
+    return bounce_io(NULL, iov, iovcnt, total, -1, true);
+  }
+
+  if (fd < 2 || fd >= 128) {
+    return -1;
+  }
+
+  struct thread *cur = thread_current()->leader;
+  rwlock_acquire_read(&cur->fd_lock);
+  struct file *f = cur->FD[fd];
+  int bytes_written = f == NULL ? -1 : bounce_io(f, iov, iovcnt, total, -1, true);
+  rwlock_release_read(&cur->fd_lock);
+
+  return bytes_written;
+}
+
+/* Copies up to SIZE bytes from FD_IN's position to FD_OUT's,
+   advancing both, without passing through user memory.  FD_OUT
+   may be the console.  Returns the number of bytes copied.
+
+   Each round reads into a kernel page.  The first round only
+   reads up to the next sector boundary of the source, so that
+   later rounds read whole sectors straight into the page, and
+   if the two positions are equally aligned, writes whole
+   sectors straight out of it too. */
+int copy_file_range (int fd_in, int fd_out, unsigned size)
+{
+  if (fd_in < 2 || fd_in >= 128 || fd_out < 1 || fd_out >= 128) {
+    return -1;
+  }
+  if (size > INT_MAX) {
+    size = INT_MAX;
+  }
+
+  struct thread *cur = thread_current()->leader;
+  rwlock_acquire_read(&cur->fd_lock);
+  struct file *in = cur->FD[fd_in];
+  struct file *out = fd_out == 1 ? NULL : cur->FD[fd_out];
+  uint8_t *buffer = NULL;
+  int copied = -1;
+
+  if (in == NULL || (fd_out != 1 && out == NULL)) {
+    goto done;
+  }
+  buffer = palloc_get_page(0);
+  if (buffer == NULL) {
+    goto done;
+  }
+
+  copied = 0;
+  while ((unsigned) copied < size) {
+    off_t chunk = PGSIZE - file_tell(in) % BLOCK_SECTOR_SIZE;
+    if ((unsigned) chunk > size - copied) {
+      chunk = size - copied;
+    }
+
+    off_t bytes_read = file_read(in, buffer, chunk);
+    if (bytes_read <= 0) {
+      break;
+    }
+
+    off_t bytes_written = bytes_read;
+    if (out == NULL) {
+      putbuf((const char *) buffer, bytes_read);
+    } else {
+      bytes_written = file_write(out, buffer, bytes_read);
+    }
+    copied += bytes_written;
+
+    if (bytes_written < bytes_read) {
+      // 쓰지 못한 만큼 입력 위치를 되돌린다
+      file_seek(in, file_tell(in) - (bytes_read - bytes_written));
+      break;
+    }
+    if (bytes_read < chunk) {
+      break;
+    }
+  }
+
+ done:
+  palloc_free_page(buffer);
+  rwlock_release_read(&cur->fd_lock);
+  return copied;
+}
+
 void seek(int fd, unsigned position) {
     if (fd < 2 || fd >= 128) return;
 
-    struct file *f = thread_current()->FD[fd];
-    if (f == NULL) return;
-    file_seek(f, position);
+    struct thread *cur = thread_current()->leader;
+    rwlock_acquire_read(&cur->fd_lock);
+    struct file *f = cur->FD[fd];
+    if (f != NULL) file_seek(f, position);
+    rwlock_release_read(&cur->fd_lock);
 }
 
 unsigned tell(int fd) {
     if (fd < 2 || fd >= 128) return 0; // Or some error indicator
 
-    struct file *f = thread_current()->FD[fd];
-    if (f == NULL) return 0; // Or some error indicator
-
-
-    unsigned position = file_tell(f);
+    struct thread *cur = thread_current()->leader;
+    rwlock_acquire_read(&cur->fd_lock);
+    struct file *f = cur->FD[fd];
+    unsigned position = f == NULL ? 0 : file_tell(f); // Or some error indicator
+    rwlock_release_read(&cur->fd_lock);
     return position;
 }
 
 void close(int fd) {
     if (fd < 2 || fd >= 128) return;
+    if (pipe_close(fd)) return;
     
-    struct thread *cur = thread_current();
+    /* The lock also keeps two threads of a process from
+       closing the same descriptor, and waits for reads and
+       writes on it to finish. */
+    struct thread *cur = thread_current()->leader;
+    rwlock_acquire_write(&cur->fd_lock);
     struct file *f = cur->FD[fd];
-    if (f == NULL) return;
-
-    file_close(f);
     cur->FD[fd] = NULL; // Mark file descriptor as free
-  
+    rwlock_release_write(&cur->fd_lock);
+    file_close(f);
+
 }
 
 /* Project 4: mmap */
 mapid_t mmap (int fd, void *addr) {
     if (addr == NULL || pg_ofs(addr) != 0 || fd <= 1) return -1;
     
-    struct thread *curr = thread_current();
+    struct thread *curr = thread_current()->leader;
     struct file *f = NULL;
     
-    if (fd < 128 && curr->FD[fd] != NULL) {
-        lock_acquire(&filesys_lock);
-        f = file_reopen(curr->FD[fd]);
-        lock_release(&filesys_lock);
+    if (fd < 128) {
+        rwlock_acquire_read(&curr->fd_lock);
+        if (curr->FD[fd] != NULL)
+            f = file_reopen(curr->FD[fd]);
+        rwlock_release_read(&curr->fd_lock);
     }
     
     /* 파일 길이 확인 */
-    lock_acquire(&filesys_lock);
     size_t file_len = (f == NULL) ? 0 : file_length(f);
-    lock_release(&filesys_lock);
 
     if (f == NULL || file_len == 0) return -1;
 
-    /* 전체 구간 겹침 검사 */
+    /* 전체 구간 겹침 검사.  Other threads of the process must
+       not map the range between the check and the insertion. */
+    bool acquired = vm_acquire();
     void *check_addr = addr;
     size_t check_len = file_len;
     while (check_len > 0) {
         if (find_vme(check_addr) != NULL || is_kernel_vaddr(check_addr)) { 
-            lock_acquire(&filesys_lock);
+            vm_release(acquired);
             file_close(f);
-            lock_release(&filesys_lock);
             return -1;
         }
         check_addr += PGSIZE;
@@ -433,9 +917,8 @@ mapid_t mmap (int fd, void *addr) {
 
     struct mmap_file *mmap_f = malloc(sizeof(struct mmap_file));
     if (mmap_f == NULL) {
-        lock_acquire(&filesys_lock);
+        vm_release(acquired);
         file_close(f);
-        lock_release(&filesys_lock);
         return -1;
     }
     
@@ -443,6 +926,7 @@ mapid_t mmap (int fd, void *addr) {
     mmap_f->file = f;
     mmap_f->vaddr = addr;
     mmap_f->size = file_len;
+    mmap_f->shm = NULL;
     list_push_back(&curr->mmap_list, &mmap_f->elem);
 
     int32_t ofs = 0;
@@ -453,7 +937,10 @@ mapid_t mmap (int fd, void *addr) {
         uint32_t page_zero_bytes = PGSIZE - page_read_bytes;
 
         struct vm_entry *vme = malloc(sizeof(struct vm_entry));
-        if (vme == NULL) return -1;
+        if (vme == NULL) {
+            vm_release(acquired);
+            return -1;
+        }
 
         vme->type = VM_FILE; 
         vme->vaddr = addr;
@@ -470,13 +957,15 @@ mapid_t mmap (int fd, void *addr) {
         ofs += page_read_bytes;
         addr += PGSIZE;
     }
+    vm_release(acquired);
     return mmap_f->mapid;
 }
 
 void munmap (mapid_t mapping) {
-    struct thread *curr = thread_current();
+    struct thread *curr = thread_current()->leader;
     struct list_elem *e;
     struct mmap_file *mmap_f = NULL;
+    bool acquired = vm_acquire();
 
     for (e = list_begin(&curr->mmap_list); e != list_end(&curr->mmap_list); e = list_next(e)) {
         struct mmap_file *f = list_entry(e, struct mmap_file, elem);
@@ -486,17 +975,26 @@ void munmap (mapid_t mapping) {
         }
     }
 
-    if (mmap_f == NULL) return;
+    if (mmap_f == NULL) {
+        vm_release(acquired);
+        return;
+    }
 
     void *addr = mmap_f->vaddr;
     size_t size = mmap_f->size;
+
+    /* 공유 메모리는 세그먼트에서 떼어내기만 한다 */
+    if (mmap_f->shm != NULL) {
+        shm_detach(mmap_f->shm);
+        size = 0;
+    }
     
     while (size > 0) {
         struct vm_entry *vme = find_vme(addr);
         if (vme != NULL) {
             if (vme->is_loaded) {
                 if (pagedir_is_dirty(curr->pagedir, vme->vaddr)) {
-                    file_write_at(vme->file, vme->vaddr, vme->read_bytes, vme->offset);
+                    file_page_write(vme->file, vme->vaddr, vme->read_bytes, vme->offset);
                 }
                 void *kpage = pagedir_get_page(curr->pagedir, vme->vaddr);
                 if (kpage) {
@@ -512,9 +1010,40 @@ void munmap (mapid_t mapping) {
         else size = 0;
     }
 
-    lock_acquire(&filesys_lock);
-    file_close(mmap_f->file);
-    lock_release(&filesys_lock);
     list_remove(&mmap_f->elem);
+    vm_release(acquired);
+
+    file_close(mmap_f->file);
     free(mmap_f);
-}
\ No newline at end of file
+}
+
+/* Maps shared memory segment NAME at ADDR, creating it with SIZE
+   bytes if it does not exist; see shm_attach().  Returns a
+   mapping id that munmap() accepts, or -1. */
+mapid_t shm_open (const char *uname, unsigned size, void *addr) {
+    char name[SHM_NAME_MAX + 1];
+    if (copy_in_string(name, uname, sizeof name) == NULL || name[0] == '\0')
+        return -1;
+    if (addr == NULL || pg_ofs(addr) != 0) return -1;
+
+    struct thread *curr = thread_current()->leader;
+    struct mmap_file *mmap_f = malloc(sizeof(struct mmap_file));
+    if (mmap_f == NULL) return -1;
+
+    bool acquired = vm_acquire();
+    struct shm_map *m = shm_attach(name, size, addr);
+    if (m == NULL) {
+        vm_release(acquired);
+        free(mmap_f);
+        return -1;
+    }
+
+    mmap_f->mapid = curr->next_mapid++;
+    mmap_f->file = NULL;
+    mmap_f->vaddr = addr;
+    mmap_f->size = shm_size(m);
+    mmap_f->shm = m;
+    list_push_back(&curr->mmap_list, &mmap_f->elem);
+    vm_release(acquired);
+    return mmap_f->mapid;
+}
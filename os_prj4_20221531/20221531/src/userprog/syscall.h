@@ -5,7 +5,11 @@
 
 typedef int pid_t;
 
+struct intr_frame;
+
 void syscall_init (void);
+void sysenter_entry (void);
+void sysenter_handler (struct intr_frame *);
 
 /* Projects 1 and 2 system calls */
 void halt (void) __attribute__ ((noreturn));
@@ -24,9 +28,16 @@ void close (int fd);
 int fibonacci(int n);
 int max_of_four_int(int a, int b, int c, int d);
 
+/* Positioned and vectored I/O. */
+int pread (int fd, void *buffer, unsigned size, unsigned offset);
+int pwrite (int fd, const void *buffer, unsigned size, unsigned offset);
+int readv (int fd, const struct iovec *, int iovcnt);
+int writev (int fd, const struct iovec *, int iovcnt);
+int copy_file_range (int fd_in, int fd_out, unsigned size);
+
 //project 4
 mapid_t mmap (int fd, void *addr);
 void munmap (mapid_t mapping);
-extern struct lock filesys_lock;
+mapid_t shm_open (const char *name, unsigned size, void *addr);
 
 #endif /* userprog/syscall.h */
@@ -0,0 +1,263 @@
+#include "userprog/trace.h"
+#include <debug.h>
+#include <histogram.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include "devices/serial.h"
+#include "devices/timer.h"
+#include "threads/interrupt.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/vaddr.h"
+#include "userprog/syscall.h"
+#include "userprog/uaccess.h"
+
+/* Pages per traced process, for the histograms and records. */
+#define TRACE_PAGES 4
+
+/* Format of the dump written at exit, all little-endian:
+
+     struct trace_header, then
+     `record_cnt' times struct trace_record, oldest first, then
+     `hist_cnt' times struct trace_hist, by system call number. */
+#define TRACE_MAGIC 0x43525450          /* "PTRC". */
+#define TRACE_VERSION 1
+
+struct trace_header
+  {
+    uint32_t magic;             /* TRACE_MAGIC. */
+    uint16_t version;           /* TRACE_VERSION. */
+    uint16_t arg_cnt;           /* TRACE_ARGS. */
+    int32_t tid;                /* Process leader. */
+    char name[16];              /* Its name. */
+    uint32_t call_cnt;          /* Calls recorded in all. */
+    uint32_t record_cnt;        /* Records that follow. */
+    uint32_t hist_cnt;          /* TRACE_SYSCALLS. */
+    uint32_t bucket_cnt;        /* TRACE_BUCKETS. */
+  };
+
+/* A traced process's state, TRACE_PAGES pages long. */
+struct trace
+  {
+    struct lock lock;           /* Protects everything below. */
+    bool enabled;               /* Recording calls? */
+    uint32_t call_cnt;          /* Calls recorded in all. */
+    uint32_t read_cnt;          /* Calls returned by trace_read(). */
+    uint32_t record_max;        /* Capacity of `records'. */
+    struct trace_hist hist[TRACE_SYSCALLS];
+    struct trace_record records[];      /* Ring buffer. */
+  };
+
+bool trace_all;
+
+/* Serializes creating a process's `struct trace'. */
+static struct lock create_lock;
+
+static void put_bytes (const void *, size_t);
+
+/* Initializes the tracer. */
+void
+trace_init (void)
+{
+  lock_init (&create_lock);
+}
+
+/* Returns the current process's trace, or a null pointer if it
+   has never been traced. */
+static struct trace *
+current_trace (void)
+{
+  return thread_current ()->leader->trace;
+}
+
+/* Returns true if the current process is being traced. */
+bool
+trace_active (void)
+{
+  struct trace *tr = current_trace ();
+  return tr != NULL && tr->enabled;
+}
+
+/* Starts tracing the current process if ENABLE, otherwise stops.
+   What was recorded so far is kept either way.  Returns false if
+   tracing could not be started for lack of memory. */
+bool
+trace (bool enable)
+{
+  struct thread *leader = thread_current ()->leader;
+  struct trace *tr;
+
+  lock_acquire (&create_lock);
+  tr = leader->trace;
+  if (tr == NULL && enable)
+    {
+      tr = palloc_get_multiple (PAL_ZERO, TRACE_PAGES);
+      if (tr != NULL)
+        {
+          lock_init (&tr->lock);
+          tr->record_max = ((TRACE_PAGES * PGSIZE - sizeof *tr)
+                            / sizeof *tr->records);
+          leader->trace = tr;
+        }
+    }
+  if (tr != NULL)
+    tr->enabled = enable;
+  lock_release (&create_lock);
+
+  return tr != NULL || !enable;
+}
+
+/* Records the system call NR that F made, which began at
+   START_NS, into the current process's trace.  Called by
+   syscall_handler() after the call if trace_active() was true
+   before it. */
+void
+trace_syscall (const struct intr_frame *f, int nr, int64_t start_ns)
+{
+  struct trace *tr = current_trace ();
+  int64_t dur = timer_now_ns () - start_ns;
+  uint32_t dur_ns = dur < UINT32_MAX ? dur : UINT32_MAX;
+  uint32_t args[TRACE_ARGS];
+  struct trace_record *r;
+
+  if (!copy_from_user (args, f->esp + 4, sizeof args))
+    memset (args, 0, sizeof args);
+
+  lock_acquire (&tr->lock);
+  r = &tr->records[tr->call_cnt % tr->record_max];
+  r->start_ns = start_ns;
+  r->dur_ns = dur_ns;
+  r->tid = thread_current ()->tid;
+  r->nr = nr;
+  r->ret = f->eax;
+  memcpy (r->args, args, sizeof r->args);
+  tr->call_cnt++;
+
+  if (nr >= 0 && nr < TRACE_SYSCALLS)
+    {
+      struct trace_hist *h = &tr->hist[nr];
+
+      h->cnt++;
+      h->total_ns += dur_ns;
+      if (dur_ns > h->max_ns)
+        h->max_ns = dur_ns;
+      h->latency[histogram_bucket (dur_ns, TRACE_BUCKETS)]++;
+    }
+  lock_release (&tr->lock);
+}
+
+/* Returns the number of the oldest call still in TR's ring
+   buffer.  TR's lock must be held. */
+static uint32_t
+first_kept (const struct trace *tr)
+{
+  return tr->call_cnt > tr->record_max ? tr->call_cnt - tr->record_max : 0;
+}
+
+/* Copies up to CNT of the current process's recorded calls that
+   have not been read yet into user buffer UREC, oldest first.
+   Calls that dropped out of the ring buffer before being read
+   are skipped.  Returns the number copied, or -1 if the process
+   has never been traced. */
+int
+trace_read (struct trace_record *urec, unsigned cnt)
+{
+  struct trace *tr = current_trace ();
+  unsigned done = 0;
+
+  if (tr == NULL)
+    return -1;
+  if (cnt > tr->record_max)
+    cnt = tr->record_max;
+  if (!fault_in_user (urec, cnt * sizeof *urec, true))
+    exit (-1);
+
+  lock_acquire (&tr->lock);
+  if (tr->read_cnt < first_kept (tr))
+    tr->read_cnt = first_kept (tr);
+  for (; done < cnt && tr->read_cnt != tr->call_cnt; done++, tr->read_cnt++)
+    if (!copy_to_user (&urec[done], &tr->records[tr->read_cnt
+                                                 % tr->record_max],
+                       sizeof *urec))
+      {
+        lock_release (&tr->lock);
+        exit (-1);
+      }
+  lock_release (&tr->lock);
+  return done;
+}
+
+/* Copies the current process's statistics for system call NR
+   into user buffer UHIST.  Returns false if NR has no histogram
+   or the process has never been traced. */
+bool
+trace_hist (int nr, struct trace_hist *uhist)
+{
+  struct trace *tr = current_trace ();
+  struct trace_hist h;
+
+  if (tr == NULL || nr < 0 || nr >= TRACE_SYSCALLS)
+    return false;
+  lock_acquire (&tr->lock);
+  h = tr->hist[nr];
+  lock_release (&tr->lock);
+
+  if (!copy_to_user (uhist, &h, sizeof h))
+    exit (-1);
+  return true;
+}
+
+/* Called when process LEADER exits.  If it is being traced,
+   writes its trace to the serial port in the format described
+   at the top of this file.  Then frees the trace, if any.  The
+   dump is not serialized with other console output. */
+void
+trace_exit (struct thread *leader)
+{
+  struct trace *tr = leader->trace;
+  struct trace_header h;
+  uint32_t first, i;
+
+  if (tr == NULL)
+    return;
+  leader->trace = NULL;
+  if (!tr->enabled)
+    {
+      palloc_free_multiple (tr, TRACE_PAGES);
+      return;
+    }
+
+  first = first_kept (tr);
+  printf ("trace: %s: %"PRIu32" calls, dumping %"PRIu32"\n",
+          leader->name, tr->call_cnt, tr->call_cnt - first);
+  memset (&h, 0, sizeof h);
+  h.magic = TRACE_MAGIC;
+  h.version = TRACE_VERSION;
+  h.arg_cnt = TRACE_ARGS;
+  h.tid = leader->tid;
+  strlcpy (h.name, leader->name, sizeof h.name);
+  h.call_cnt = tr->call_cnt;
+  h.record_cnt = tr->call_cnt - first;
+  h.hist_cnt = TRACE_SYSCALLS;
+  h.bucket_cnt = TRACE_BUCKETS;
+  put_bytes (&h, sizeof h);
+
+  for (i = first; i != tr->call_cnt; i++)
+    put_bytes (&tr->records[i % tr->record_max], sizeof *tr->records);
+  put_bytes (tr->hist, sizeof tr->hist);
+  serial_flush ();
+  printf ("\n");
+
+  palloc_free_multiple (tr, TRACE_PAGES);
+}
+
+/* Writes SIZE bytes from BUF to the serial port only. */
+static void
+put_bytes (const void *buf_, size_t size)
+{
+  const uint8_t *buf = buf_;
+
+  while (size-- > 0)
+    serial_putc (*buf++);
+}
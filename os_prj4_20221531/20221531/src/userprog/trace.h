@@ -0,0 +1,33 @@
+#ifndef USERPROG_TRACE_H
+#define USERPROG_TRACE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <trace.h>
+#include "threads/thread.h"
+
+struct intr_frame;
+
+/* System call tracer.
+
+   Enabled per process by the trace system call, or for every
+   process with -trace.  A traced process records every system
+   call into a ring buffer that keeps the most recent calls, and
+   tallies per-call-number latency histograms.  The process can
+   read both back with trace_read() and trace_hist().  If it is
+   still being traced when it exits, both are written to the
+   serial port in binary, which utils/pintos-trace pretty-prints. */
+
+/* -trace: Trace every process? */
+extern bool trace_all;
+
+void trace_init (void);
+bool trace_active (void);
+bool trace (bool enable);
+int trace_read (struct trace_record *, unsigned cnt);
+bool trace_hist (int nr, struct trace_hist *);
+
+void trace_syscall (const struct intr_frame *, int nr, int64_t start_ns);
+void trace_exit (struct thread *leader);
+
+#endif /* userprog/trace.h */
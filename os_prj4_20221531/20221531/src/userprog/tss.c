@@ -2,6 +2,7 @@
 #include <debug.h>
 #include <stddef.h>
 #include "userprog/gdt.h"
+#include "threads/cpu.h"
 #include "threads/thread.h"
 #include "threads/palloc.h"
 #include "threads/vaddr.h"
@@ -72,26 +73,27 @@ struct tss
     uint16_t trace, bitmap;
   };
 
-/* Kernel TSS. */
-static struct tss *tss;
-
-/* Initializes the kernel TSS. */
+/* Initializes the kernel TSS of the current CPU. */
 void
 tss_init (void) 
 {
+  struct tss *tss;
+
   /* Our TSS is never used in a call gate or task gate, so only a
      few fields of it are ever referenced, and those are the only
      ones we initialize. */
-  tss = palloc_get_page (PAL_ASSERT | PAL_ZERO);
+  tss = cpu_current ()->tss = palloc_get_page (PAL_ASSERT | PAL_ZERO);
   tss->ss0 = SEL_KDSEG;
   tss->bitmap = 0xdfff;
   tss_update ();
 }
 
-/* Returns the kernel TSS. */
+/* Returns the current CPU's kernel TSS. */
 struct tss *
 tss_get (void) 
 {
+  struct tss *tss = cpu_current ()->tss;
+
   ASSERT (tss != NULL);
   return tss;
 }
@@ -101,6 +103,8 @@ tss_get (void)
 void
 tss_update (void) 
 {
+  struct tss *tss = cpu_current ()->tss;
+
   ASSERT (tss != NULL);
   tss->esp0 = (uint8_t *) thread_current () + PGSIZE;
 }
@@ -0,0 +1,179 @@
+#include "userprog/uaccess.h"
+#include <stdint.h>
+#include "threads/interrupt.h"
+#include "threads/vaddr.h"
+
+/* The kernel touches user memory only through the accessors in
+   this file.  Each instruction among them that may fault on a
+   user address has an entry in the exception table naming a
+   FIXUP address.  If page_fault() cannot bring in the page, it
+   calls uaccess_fixup(), which resumes the accessor at FIXUP,
+   and the accessor reports failure to its caller.
+
+   So a system call need not look up every page of a buffer in
+   the supplemental page table before using it: the page fault
+   handler already does that, and only for pages that are not
+   present. */
+struct exception_entry
+  {
+    uintptr_t insn;             /* Instruction that may fault. */
+    uintptr_t fixup;            /* Where to resume if it does. */
+  };
+
+/* Gathered from section __ex_table by kernel.lds.S. */
+extern const struct exception_entry __start_ex_table[], __stop_ex_table[];
+
+/* Emits an exception table entry for the instruction at local
+   label INSN, resuming at local label FIXUP. */
+#define EX_ENTRY(INSN, FIXUP)                   \
+        ".section __ex_table, \"a\"\n\t"        \
+        ".long " INSN ", " FIXUP "\n\t"         \
+        ".previous\n"
+
+/* Returns true if the SIZE bytes at UADDR lie entirely below
+   PHYS_BASE. */
+static bool
+user_range_ok (const void *uaddr, size_t size)
+{
+  uintptr_t start = (uintptr_t) uaddr;
+  return start + size >= start && start + size <= (uintptr_t) PHYS_BASE;
+}
+
+/* Copies SIZE bytes from SRC to DST, either of which may be a
+   user address.  Returns the number of bytes not copied, which
+   is nonzero only if a page could not be brought in. */
+static size_t
+raw_copy (void *dst, const void *src, size_t size)
+{
+  asm volatile ("1: rep movsb\n"
+                "2:\n"
+                EX_ENTRY ("1b", "2b")
+                : "+c" (size), "+D" (dst), "+S" (src)
+                :
+                : "memory");
+  return size;
+}
+
+/* Reads the byte at user address USRC into *DST.
+   Returns true if successful, false if USRC is not mapped. */
+static inline bool
+get_user_byte (char *dst, const char *usrc)
+{
+  int ok;
+  char c;
+
+  asm volatile ("movl $0, %0\n"
+                "1: movb %2, %1\n\t"
+                "movl $1, %0\n"
+                "2:\n"
+                EX_ENTRY ("1b", "2b")
+                : "=&r" (ok), "=&q" (c)
+                : "m" (*usrc));
+  *dst = c;
+  return ok;
+}
+
+/* Faults in the page containing user address UADDR, for writing
+   if WRITE, without changing its contents.  Returns true if
+   successful, false if the page is not mapped or, if WRITE, is
+   read-only. */
+static inline bool
+probe_user (void *uaddr, bool write)
+{
+  volatile char *p = uaddr;
+  int ok;
+
+  if (write)
+    asm volatile ("movl $0, %0\n"
+                  "1: lock orb $0, %1\n\t"
+                  "movl $1, %0\n"
+                  "2:\n"
+                  EX_ENTRY ("1b", "2b")
+                  : "=&r" (ok), "+m" (*p));
+  else
+    asm volatile ("movl $0, %0\n"
+                  "1: cmpb $0, %1\n\t"
+                  "movl $1, %0\n"
+                  "2:\n"
+                  EX_ENTRY ("1b", "2b")
+                  : "=&r" (ok)
+                  : "m" (*p)
+                  : "cc");
+  return ok;
+}
+
+/* Copies SIZE bytes from user address USRC to DST.
+   Returns true if successful, false on a bad user address. */
+bool
+copy_from_user (void *dst, const void *usrc, size_t size)
+{
+  return user_range_ok (usrc, size) && raw_copy (dst, usrc, size) == 0;
+}
+
+/* Copies SIZE bytes from SRC to user address UDST.
+   Returns true if successful, false on a bad user address. */
+bool
+copy_to_user (void *udst, const void *src, size_t size)
+{
+  return user_range_ok (udst, size) && raw_copy (udst, src, size) == 0;
+}
+
+/* Copies the null-terminated string at user address USRC into
+   DST, which has room for SIZE bytes.  Returns the string's
+   length, SIZE if it did not fit (and DST is then not
+   null-terminated), or -1 on a bad user address. */
+int
+strncpy_from_user (char *dst, const char *usrc, size_t size)
+{
+  size_t i;
+
+  for (i = 0; i < size; i++)
+    {
+      if (!is_user_vaddr (usrc + i) || !get_user_byte (&dst[i], usrc + i))
+        return -1;
+      if (dst[i] == '\0')
+        return i;
+    }
+  return size;
+}
+
+/* Brings in every page of the SIZE bytes at user address UBUF,
+   so that a system call can reject a bad buffer before it takes
+   any locks.  Touches one byte per page.  If WRITE, the pages
+   must be writable.  Returns true if successful, false on a bad
+   user address.
+
+   This does not make it safe to access the buffer directly:
+   another thread may unmap it at any time.  The data itself must
+   still go through copy_to_user() or copy_from_user(). */
+bool
+fault_in_user (void *ubuf, size_t size, bool write)
+{
+  uint8_t *p = ubuf;
+  uint8_t *end = p + size;
+
+  if (!user_range_ok (ubuf, size))
+    return false;
+  for (; p < end; p = (uint8_t *) pg_round_down (p) + PGSIZE)
+    if (!probe_user (p, write))
+      return false;
+  return true;
+}
+
+/* Called by page_fault() for a fault in kernel mode that it
+   could not resolve.  If F's instruction is one of the accessors
+   above, arranges for it to fail and returns true.  Otherwise
+   returns false. */
+bool
+uaccess_fixup (struct intr_frame *f)
+{
+  const struct exception_entry *e;
+
+  for (e = __start_ex_table; e < __stop_ex_table; e++)
+    if (e->insn == (uintptr_t) f->eip)
+      {
+        f->eip = (void (*) (void)) e->fixup;
+        return true;
+      }
+  return false;
+}
@@ -1,4 +1,5 @@
 #include "vm/frame.h"
+#include "vm/shm.h"
 #include "vm/swap.h"
 #include "threads/malloc.h"
 #include "threads/palloc.h"
@@ -8,28 +9,48 @@
 #include <bitmap.h>
 #include <stdio.h>
 
-extern struct lock filesys_lock;
-
+/* Frame table.  Most accesses only look frames up, so it is
+   protected by a readers-writer lock; adding, freeing and
+   evicting frames take it for writing. */
 static struct list frame_table;
-static struct lock frame_lock;
+static struct rwlock frame_lock;
 struct list_elem *clock_ptr;
 
 void vm_frame_init (void) {
     list_init(&frame_table);
-    lock_init(&frame_lock);
+    rwlock_init(&frame_lock);
     clock_ptr = list_begin(&frame_table);
 }
 
 
+/* Frees evicted frame F, at E in the frame table, releases the
+   frame table lock, and returns a newly allocated page. */
+static void *release_frame (struct list_elem *e, struct frame *f, enum palloc_flags flags) {
+    palloc_free_page(f->kpage);
+    
+    if (clock_ptr == &f->elem) clock_ptr = list_next(e);
+    list_remove(&f->elem);
+    free(f);
+    rwlock_release_write(&frame_lock);
+    return palloc_get_page(flags); // 새 페이지 반환
+}
+
 static void *try_to_free_pages (enum palloc_flags flags) {
     struct list_elem *e = clock_ptr;
     if (list_empty(&frame_table)) PANIC("Frame table is empty, but memory is full!");
 
-    lock_acquire(&frame_lock);
+    rwlock_acquire_write(&frame_lock);
     while (true) {
         if (e == list_end(&frame_table)) e = list_begin(&frame_table);
         struct frame *f = list_entry(e, struct frame, elem);
 
+        /* A shared frame is unmapped from every process at once. */
+        if (f->shared != NULL) {
+            if (shm_evict(f)) return release_frame(e, f, flags);
+            e = list_next(e);
+            continue;
+        }
+
         if (f->vme == NULL) {
             e = list_next(e);
             continue;
@@ -51,7 +72,7 @@ static void *try_to_free_pages (enum palloc_flags flags) {
             } 
             else if (f->vme->type == VM_FILE) {             
              if (dirty) {
-                 file_write_at(f->vme->file, f->kpage, 
+                 file_page_write(f->vme->file, f->kpage, 
                                 f->vme->read_bytes, f->vme->offset);
              }
 
@@ -67,13 +88,7 @@ static void *try_to_free_pages (enum palloc_flags flags) {
             }
                 
             pagedir_clear_page(t->pagedir, f->vme->vaddr);
-            palloc_free_page(f->kpage);
-            
-            if (clock_ptr == &f->elem) clock_ptr = list_next(e);
-            list_remove(&f->elem);
-            free(f);
-            lock_release(&frame_lock);
-            return palloc_get_page(flags); // 새 페이지 반환
+            return release_frame(e, f, flags);
         }
         e = list_next(e);
     }
@@ -87,23 +102,25 @@ struct page *alloc_page (enum palloc_flags flags) {
     struct frame *f = malloc(sizeof(struct frame));
     if (f == NULL) { palloc_free_page(kpage); return NULL; }
     f->kpage = kpage;
-    f->thread = thread_current();
+    f->thread = thread_current()->leader;
     f->vme = NULL;
-    lock_acquire(&frame_lock);
+    f->shared = NULL;
+    f->ref_cnt = 0;
+    rwlock_acquire_write(&frame_lock);
     list_push_back(&frame_table, &f->elem);
     if (clock_ptr == NULL || clock_ptr == list_end(&frame_table)) clock_ptr = &f->elem;
-    lock_release(&frame_lock);
+    rwlock_release_write(&frame_lock);
     return kpage;
 }
 
 void free_page (void *kpage) {
     struct list_elem *e;
-    lock_acquire(&frame_lock);
+    rwlock_acquire_write(&frame_lock);
     for (e = list_begin(&frame_table); e != list_end(&frame_table); e = list_next(e)) {
         struct frame *tmp = list_entry(e, struct frame, elem);
         if (tmp->kpage == kpage) { __free_page(tmp); break; }
     }
-    lock_release(&frame_lock);
+    rwlock_release_write(&frame_lock);
 }
 
 void __free_page (struct frame *f) {
@@ -118,10 +135,71 @@ void __free_page (struct frame *f) {
 
 void add_page_to_frame (void *kpage, struct vm_entry *vme) {
     struct list_elem *e;
-    lock_acquire(&frame_lock);
+    /* Only the frame's owner sets its vme, so a read lock keeps
+       the list stable enough for this lookup. */
+    rwlock_acquire_read(&frame_lock);
     for (e = list_begin(&frame_table); e != list_end(&frame_table); e = list_next(e)) {
         struct frame *f = list_entry(e, struct frame, elem);
         if (f->kpage == kpage) { f->vme = vme; break; }
     }
-    lock_release(&frame_lock);
-}
\ No newline at end of file
+    rwlock_release_read(&frame_lock);
+}
+/* Moves resident user page UPAGE of the current process onto
+   KPAGE, a page outside the frame table, without copying: KPAGE
+   takes over UPAGE's frame and mapping, and UPAGE's old page is
+   returned to the caller, no longer part of the frame table.
+   Lets a pipe hand a full page of data to a reader by remapping.
+
+   Returns a null pointer, changing nothing, unless UPAGE is
+   loaded, writable and private: a file-backed page would be
+   written back to its file, and a shared page belongs to other
+   processes too. */
+void *frame_exchange (void *upage, void *kpage) {
+    struct thread *cur = thread_current();
+    bool acquired = vm_acquire();
+    struct vm_entry *vme = find_vme(upage);
+    void *old = NULL;
+
+    if (vme == NULL || !vme->is_loaded || !vme->writable
+        || vme->type == VM_FILE || vme->type == VM_SHM) {
+        vm_release(acquired);
+        return NULL;
+    }
+
+    /* Eviction takes the frame lock for writing, so holding it
+       keeps UPAGE resident until it has been remapped. */
+    rwlock_acquire_write(&frame_lock);
+    void *cur_kpage = pagedir_get_page(cur->pagedir, upage);
+    struct list_elem *e;
+    for (e = list_begin(&frame_table); cur_kpage != NULL && e != list_end(&frame_table); e = list_next(e)) {
+        struct frame *f = list_entry(e, struct frame, elem);
+        if (f->kpage == cur_kpage) {
+            f->kpage = kpage;
+            pagedir_clear_page(cur->pagedir, upage);
+            pagedir_set_page(cur->pagedir, upage, kpage, true);
+            /* The new contents exist nowhere else, so eviction
+               must swap them out rather than reload the page. */
+            pagedir_set_dirty(cur->pagedir, upage, true);
+            old = cur_kpage;
+            break;
+        }
+    }
+    rwlock_release_write(&frame_lock);
+    vm_release(acquired);
+    return old;
+}
+
+/* Marks the frame holding KPAGE, just allocated, as holding
+   shared memory page SP, and returns it.  Eviction then goes
+   through shm_evict(). */
+struct frame *frame_set_shared (void *kpage, struct shm_page *sp) {
+    struct list_elem *e;
+    struct frame *found = NULL;
+    rwlock_acquire_read(&frame_lock);
+    for (e = list_begin(&frame_table); e != list_end(&frame_table); e = list_next(e)) {
+        struct frame *f = list_entry(e, struct frame, elem);
+        if (f->kpage == kpage) { f->shared = sp; found = f; break; }
+    }
+    rwlock_release_read(&frame_lock);
+    return found;
+}
@@ -12,6 +12,12 @@ struct frame {
     struct vm_entry *vme;
     struct thread *thread;
     struct list_elem elem;
+
+    /* A frame that holds a page of a shared memory segment has
+       no single vme; instead SHARED points to the page, and
+       REF_CNT counts the page tables that map the frame. */
+    struct shm_page *shared;
+    int ref_cnt;
 };
 
 void vm_frame_init (void);
@@ -19,5 +25,7 @@ struct page *alloc_page (enum palloc_flags flags);
 void free_page (void *kpage);
 void __free_page (struct frame *f);
 void add_page_to_frame (void *kpage, struct vm_entry *vme);
+void *frame_exchange (void *upage, void *kpage);
+struct frame *frame_set_shared (void *kpage, struct shm_page *);
 
 #endif /* vm/frame.h */
\ No newline at end of file
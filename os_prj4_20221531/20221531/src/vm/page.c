@@ -45,19 +45,45 @@ void vm_destroy (struct hash *vm) {
     hash_destroy(vm, vm_destroy_func);
 }
 
+/* The threads of a process share their leader's page table, so
+   lookups, updates and fault handling are serialized by the
+   leader's vm_lock.  Acquires it unless the current thread
+   already holds it, and returns whether it did, to be passed to
+   vm_release(). */
+bool vm_acquire (void) {
+    struct lock *lock = &thread_current()->leader->vm_lock;
+    if (lock_held_by_current_thread(lock))
+        return false;
+    lock_acquire(lock);
+    return true;
+}
+
+void vm_release (bool acquired) {
+    if (acquired)
+        lock_release(&thread_current()->leader->vm_lock);
+}
+
 struct vm_entry *find_vme (void *vaddr) {
     struct vm_entry vme;
     vme.vaddr = pg_round_down(vaddr);
-    struct hash_elem *e = hash_find(&thread_current()->vm, &vme.elem);
+    bool acquired = vm_acquire();
+    struct hash_elem *e = hash_find(&thread_current()->leader->vm, &vme.elem);
+    vm_release(acquired);
     return e ? hash_entry(e, struct vm_entry, elem) : NULL;
 }
 
 bool insert_vme (struct hash *vm, struct vm_entry *vme) {
-    return hash_insert(vm, &vme->elem) == NULL;
+    bool acquired = vm_acquire();
+    bool success = hash_insert(vm, &vme->elem) == NULL;
+    vm_release(acquired);
+    return success;
 }
 
 bool delete_vme (struct hash *vm, struct vm_entry *vme) {
-    if (hash_delete(vm, &vme->elem) != NULL) {
+    bool acquired = vm_acquire();
+    struct hash_elem *e = hash_delete(vm, &vme->elem);
+    vm_release(acquired);
+    if (e != NULL) {
         free(vme);
         return true;
     }
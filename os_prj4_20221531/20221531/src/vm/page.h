@@ -9,6 +9,7 @@
 #define VM_BIN 0   /* 실행 파일 (Binary) */
 #define VM_FILE 1  /* 메모리 매핑 파일 (mmap) */
 #define VM_ANON 2  /* 스왑/스택 (Anonymous) */
+#define VM_SHM 3   /* 공유 메모리 (Shared memory, see vm/shm.c) */
 
 /* 가상 페이지 정보를 담는 구조체 (Supplemental Page Table Entry) */
 struct vm_entry {
@@ -25,6 +26,8 @@ struct vm_entry {
 
     size_t swap_slot;   
 
+    struct shm_page *shm_page;  /* VM_SHM: the segment's page. */
+
     struct hash_elem elem;
 };
 
@@ -34,6 +37,7 @@ struct mmap_file {
     struct file *file;      
     void *vaddr;            
     size_t size;            
+    struct shm_map *shm;    /* Shared memory mapping, if no FILE. */
     struct list_elem elem;  
 };
 
@@ -43,5 +47,7 @@ void vm_destroy (struct hash *vm);
 struct vm_entry *find_vme (void *vaddr);
 bool insert_vme (struct hash *vm, struct vm_entry *vme);
 bool delete_vme (struct hash *vm, struct vm_entry *vme);
+bool vm_acquire (void);
+void vm_release (bool acquired);
 
 #endif /* vm/page.h */
\ No newline at end of file
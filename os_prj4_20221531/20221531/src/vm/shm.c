@@ -0,0 +1,264 @@
+#include "vm/shm.h"
+#include <bitmap.h>
+#include <debug.h>
+#include <list.h>
+#include <round.h>
+#include <string.h>
+#include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+#include "userprog/pagedir.h"
+#include "vm/frame.h"
+#include "vm/page.h"
+#include "vm/swap.h"
+
+/* A page of a segment.  It is in a frame, in a swap slot, or, if
+   it has never been touched, nowhere yet and reads as zeros. */
+struct shm_page {
+    struct shm *shm;            /* Segment it belongs to. */
+    struct frame *frame;        /* Frame holding it, or null. */
+    size_t swap_slot;           /* Swap slot holding it, or BITMAP_ERROR. */
+};
+
+/* A segment.  It exists as long as some process maps it. */
+struct shm {
+    struct list_elem elem;      /* Element in `shm_list'. */
+    char name[SHM_NAME_MAX + 1];
+    size_t page_cnt;            /* Size in pages. */
+    struct shm_page *pages;     /* PAGE_CNT pages. */
+    struct list maps;           /* Its mappings, as struct shm_map. */
+};
+
+/* One process's mapping of a segment, at BASE.  The process's
+   page table entries for it are VM_SHM entries that point to the
+   segment's pages. */
+struct shm_map {
+    struct list_elem elem;      /* Element in the segment's `maps'. */
+    struct shm *shm;            /* Segment. */
+    struct thread *leader;      /* Process that maps it. */
+    void *base;                 /* Address of its first page. */
+};
+
+/* All segments.  `shm_lock' protects them, their mappings and
+   pages, and the reference counts of their frames.  It is taken
+   after a process's vm_lock and before the frame table lock. */
+static struct list shm_list;
+static struct lock shm_lock;
+
+void shm_init (void) {
+    list_init(&shm_list);
+    lock_init(&shm_lock);
+}
+
+/* Returns the segment called NAME, or a null pointer. */
+static struct shm *shm_lookup (const char *name) {
+    struct list_elem *e;
+    for (e = list_begin(&shm_list); e != list_end(&shm_list); e = list_next(e)) {
+        struct shm *shm = list_entry(e, struct shm, elem);
+        if (strcmp(shm->name, name) == 0) return shm;
+    }
+    return NULL;
+}
+
+/* Creates a segment called NAME of PAGE_CNT pages of zeros. */
+static struct shm *shm_create (const char *name, size_t page_cnt) {
+    struct shm *shm = malloc(sizeof *shm);
+    if (shm == NULL) return NULL;
+    shm->pages = malloc(page_cnt * sizeof *shm->pages);
+    if (shm->pages == NULL) {
+        free(shm);
+        return NULL;
+    }
+
+    strlcpy(shm->name, name, sizeof shm->name);
+    shm->page_cnt = page_cnt;
+    for (size_t i = 0; i < page_cnt; i++) {
+        shm->pages[i].shm = shm;
+        shm->pages[i].frame = NULL;
+        shm->pages[i].swap_slot = BITMAP_ERROR;
+    }
+    list_init(&shm->maps);
+    list_push_back(&shm_list, &shm->elem);
+    return shm;
+}
+
+/* Frees SHM, which nothing maps any more, and its pages. */
+static void shm_destroy (struct shm *shm) {
+    list_remove(&shm->elem);
+    for (size_t i = 0; i < shm->page_cnt; i++) {
+        struct shm_page *sp = &shm->pages[i];
+        if (sp->frame != NULL) free_page(sp->frame->kpage);
+        else if (sp->swap_slot != BITMAP_ERROR) vm_swap_free(sp->swap_slot);
+    }
+    free(shm->pages);
+    free(shm);
+}
+
+/* Maps segment NAME at ADDR in the current process, first
+   creating it with SIZE bytes, rounded up to whole pages, if
+   there is no such segment.  The whole segment is mapped; SIZE
+   may be 0 to map only an existing segment, but may not exceed an
+   existing segment's size.  Pages are brought in on first touch.
+   Returns the mapping, or a null pointer if the segment does not
+   exist and SIZE is 0, or if ADDR is in use or memory ran out. */
+struct shm_map *shm_attach (const char *name, size_t size, void *addr) {
+    struct thread *leader = thread_current()->leader;
+    size_t page_cnt = DIV_ROUND_UP(size, PGSIZE);
+    struct shm_map *m = NULL;
+    size_t i = 0;
+
+    bool acquired = vm_acquire();
+    lock_acquire(&shm_lock);
+    struct shm *shm = shm_lookup(name);
+    if (shm == NULL && page_cnt > 0) shm = shm_create(name, page_cnt);
+    if (shm == NULL || page_cnt > shm->page_cnt) goto fail;
+
+    /* The whole range must be free user address space. */
+    if ((uintptr_t) addr + shm->page_cnt * PGSIZE > (uintptr_t) PHYS_BASE
+        || (uintptr_t) addr + shm->page_cnt * PGSIZE < (uintptr_t) addr)
+        goto fail;
+    for (i = 0; i < shm->page_cnt; i++)
+        if (find_vme(addr + i * PGSIZE) != NULL) goto fail;
+
+    m = malloc(sizeof *m);
+    if (m == NULL) goto fail;
+    for (i = 0; i < shm->page_cnt; i++) {
+        struct vm_entry *vme = calloc(1, sizeof *vme);
+        if (vme == NULL) goto fail;
+        vme->type = VM_SHM;
+        vme->vaddr = addr + i * PGSIZE;
+        vme->writable = true;
+        vme->is_loaded = false;
+        vme->shm_page = &shm->pages[i];
+        insert_vme(&leader->vm, vme);
+    }
+
+    m->shm = shm;
+    m->leader = leader;
+    m->base = addr;
+    list_push_back(&shm->maps, &m->elem);
+    lock_release(&shm_lock);
+    vm_release(acquired);
+    return m;
+
+ fail:
+    /* Undo the entries inserted so far, if any. */
+    while (m != NULL && i-- > 0)
+        delete_vme(&leader->vm, find_vme(addr + i * PGSIZE));
+    free(m);
+    if (shm != NULL && list_empty(&shm->maps)) shm_destroy(shm);
+    lock_release(&shm_lock);
+    vm_release(acquired);
+    return NULL;
+}
+
+/* Returns the size in bytes of the segment that M maps. */
+size_t shm_size (const struct shm_map *m) {
+    return m->shm->page_cnt * PGSIZE;
+}
+
+/* Unmaps M from its process, which must be the current one, and
+   frees M.  Removes the segment if that was its last mapping. */
+void shm_detach (struct shm_map *m) {
+    struct shm *shm = m->shm;
+    uint32_t *pd = m->leader->pagedir;
+
+    bool acquired = vm_acquire();
+    lock_acquire(&shm_lock);
+    for (size_t i = 0; i < shm->page_cnt; i++) {
+        void *upage = m->base + i * PGSIZE;
+        struct vm_entry *vme = find_vme(upage);
+
+        /* Eviction unmaps a page from every process at once, so
+           if this one maps it, it is in a frame. */
+        if (pagedir_get_page(pd, upage) != NULL) {
+            pagedir_clear_page(pd, upage);
+            shm->pages[i].frame->ref_cnt--;
+        }
+        if (vme != NULL) delete_vme(&m->leader->vm, vme);
+    }
+    list_remove(&m->elem);
+    if (list_empty(&shm->maps)) shm_destroy(shm);
+    lock_release(&shm_lock);
+    vm_release(acquired);
+    free(m);
+}
+
+/* Brings in shared page VME of the current process, which holds
+   its vm_lock: maps the frame that holds the page if some other
+   process already brought it in, or else a new frame filled from
+   swap or with zeros.  Returns true if successful. */
+bool shm_fault (struct vm_entry *vme) {
+    struct shm_page *sp = vme->shm_page;
+    bool success = false;
+
+    lock_acquire(&shm_lock);
+    if (sp->frame == NULL) {
+        bool swapped = sp->swap_slot != BITMAP_ERROR;
+        void *kpage = alloc_page(PAL_USER | (swapped ? 0 : PAL_ZERO));
+        if (kpage == NULL) goto done;
+        if (swapped) {
+            vm_swap_in(sp->swap_slot, kpage);
+            sp->swap_slot = BITMAP_ERROR;
+        }
+        sp->frame = frame_set_shared(kpage, sp);
+    }
+
+    if (pagedir_set_page(thread_current()->pagedir, vme->vaddr,
+                         sp->frame->kpage, true)) {
+        sp->frame->ref_cnt++;
+        vme->is_loaded = true;
+        success = true;
+    }
+ done:
+    lock_release(&shm_lock);
+    return success;
+}
+
+/* Called by the frame allocator, which holds the frame table
+   lock, to evict shared frame F.  Gives F a second chance if any
+   process that maps it has accessed it since the last time.
+   Otherwise writes it to swap, unmaps it from every process that
+   maps it, and returns true, leaving the caller to free F.
+   Also returns false, to skip F for now, if another thread is
+   using the segments. */
+bool shm_evict (struct frame *f) {
+    struct shm_page *sp = f->shared;
+    struct shm *shm = sp->shm;
+    size_t idx = sp - shm->pages;
+    bool held = lock_held_by_current_thread(&shm_lock);
+    bool accessed = false;
+    struct list_elem *e;
+
+    if (!held && !lock_try_acquire(&shm_lock)) return false;
+
+    if (f->ref_cnt > 0) {
+        for (e = list_begin(&shm->maps); e != list_end(&shm->maps); e = list_next(e)) {
+            struct shm_map *m = list_entry(e, struct shm_map, elem);
+            void *upage = m->base + idx * PGSIZE;
+            if (pagedir_is_accessed(m->leader->pagedir, upage)) {
+                pagedir_set_accessed(m->leader->pagedir, upage, false);
+                accessed = true;
+            }
+        }
+    }
+
+    if (!accessed) {
+        sp->swap_slot = vm_swap_out(f->kpage);
+        if (sp->swap_slot == BITMAP_ERROR) PANIC("Swap Disk is Full!");
+        for (e = list_begin(&shm->maps); f->ref_cnt > 0 && e != list_end(&shm->maps); e = list_next(e)) {
+            struct shm_map *m = list_entry(e, struct shm_map, elem);
+            void *upage = m->base + idx * PGSIZE;
+            if (pagedir_get_page(m->leader->pagedir, upage) != NULL) {
+                pagedir_clear_page(m->leader->pagedir, upage);
+                f->ref_cnt--;
+            }
+        }
+        sp->frame = NULL;
+    }
+
+    if (!held) lock_release(&shm_lock);
+    return !accessed;
+}
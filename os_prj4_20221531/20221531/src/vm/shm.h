@@ -0,0 +1,24 @@
+#ifndef VM_SHM_H
+#define VM_SHM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+struct frame;
+struct vm_entry;
+
+/* Longest shared memory segment name. */
+#define SHM_NAME_MAX 14
+
+/* Named shared memory segments: anonymous pages that several
+   processes map at once, each at an address of its choosing, so
+   that what one writes the others see without copying. */
+
+void shm_init (void);
+struct shm_map *shm_attach (const char *name, size_t size, void *addr);
+size_t shm_size (const struct shm_map *);
+void shm_detach (struct shm_map *);
+bool shm_fault (struct vm_entry *);
+bool shm_evict (struct frame *);
+
+#endif /* vm/shm.h */